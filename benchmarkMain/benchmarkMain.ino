@@ -0,0 +1,123 @@
+#include <Servo.h>
+#include "src/DoorLock.h"
+using namespace DoorLock;
+// This sketch is not for campers. It measures how long the library's hot paths take
+// on the real board and prints the results to the Serial Monitor (115200 baud).
+//
+// To get the scanButtons() numbers, upload it to an Uno (or any ATmega328P board at 16 MHz),
+// open the Serial Monitor and note the "before" and "after" lines; they are averages over
+// ITERATIONS calls with no button pressed, timed with micros() (4 us, 64 cycles, resolution).
+// "before" is the digitalRead() scan copied into this sketch below, not the library as it was
+// before _FastPin. For the old library itself, run tools/sim_bench.py on a checkout of the
+// commit before it (see its help). No results from a board or the simulator are kept in this
+// repository yet.
+
+const unsigned long ITERATIONS = 2000;
+
+// --- "Before" reference: the original digitalRead() based scanButtons() ---
+// Kept here so the old and new button scan can be compared on the same board.
+int legacyLastReading[4] = {LOW, LOW, LOW, LOW};
+int legacyStableState[4] = {LOW, LOW, LOW, LOW};
+unsigned long legacyLastDebounceTs[4] = {0, 0, 0, 0};
+bool legacyJustPressed[4] = {false, false, false, false};
+
+void legacyScanButtons() {
+  int buttonPins[] = {getButton1(), getButton2(), getButton3(), getLockButton()};
+  const unsigned long DEBOUNCE_DELAY = 50;
+
+  for (uint8_t i = 0; i < 4; i++) {
+    int currentReading = digitalRead(buttonPins[i]);
+    if (currentReading != legacyLastReading[i]) {
+      legacyLastDebounceTs[i] = millis();
+    }
+    if ((millis() - legacyLastDebounceTs[i]) > DEBOUNCE_DELAY) {
+      if (currentReading != legacyStableState[i]) {
+        legacyStableState[i] = currentReading;
+        if (legacyStableState[i] == LOW) {
+          legacyJustPressed[i] = true;
+        }
+      }
+    }
+    legacyLastReading[i] = currentReading;
+  }
+}
+
+// Runs fn ITERATIONS times and returns the average cost of one call in CPU cycles.
+// The cost of an empty loop is measured the same way and subtracted.
+void emptyCall() {}
+
+unsigned long cyclesPerCall(void (*fn)()) {
+  unsigned long begin = micros();
+  for (unsigned long i = 0; i < ITERATIONS; i++) {
+    fn();
+  }
+  unsigned long elapsed = micros() - begin;
+
+  begin = micros();
+  for (unsigned long i = 0; i < ITERATIONS; i++) {
+    emptyCall();
+  }
+  unsigned long overhead = micros() - begin;
+
+  if (overhead > elapsed) {
+    overhead = elapsed;
+  }
+  return (elapsed - overhead) * (F_CPU / 1000000UL) / ITERATIONS;
+}
+
+void printResult(const char* name, unsigned long cycles) {
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(cycles);
+  Serial.println(" cycles/call");
+}
+
+// Posts unlock/lock feedback over and over while the "sketch" burns a random 0-2 ms between
+// scanButtons() calls, then reports how long commands sat in the actuator queue.
+void actuationLatencyBenchmark() {
+  const int ROUNDS = 200;
+  resetActuationLatency();
+  randomSeed(1);
+  for (int i = 0; i < ROUNDS; i++) {
+    if (i % 2 == 0) {
+      DoorUnlock();
+    } else {
+      DoorLock::DoorLock();
+    }
+    // Synthetic load, then let the actuator side catch up (the 1000 ms LED waits are what take the time)
+    delayMicroseconds(random(0, 2000));
+    while (isActuatorBusy()) {
+      scanButtons();
+      delayMicroseconds(random(0, 2000));
+    }
+  }
+  Serial.print("actuation latency p50: ");
+  Serial.print(actuationLatency(50));
+  Serial.println(" us");
+  Serial.print("actuation latency p99: ");
+  Serial.print(actuationLatency(99));
+  Serial.println(" us");
+}
+
+void setup() {
+  start();
+  scanButtons();
+
+  // Build with DOORLOCK_FAST_BOOT=1 (src/DoorLockConfig.h) to compare
+  Serial.begin(115200);
+  Serial.print("reset to first scanButtons(): ");
+  Serial.print(bootTimeMicros());
+  Serial.println(" us");
+
+  Serial.println("--- scanButtons() benchmark ---");
+  unsigned long before = cyclesPerCall(legacyScanButtons);
+  unsigned long after = cyclesPerCall(scanButtons);
+  printResult("before (digitalRead)", before);
+  printResult("after  (fast GPIO)  ", after);
+
+  Serial.println("--- actuation latency benchmark (takes a few minutes) ---");
+  actuationLatencyBenchmark();
+}
+
+void loop() {
+}
@@ -0,0 +1,73 @@
+#ifndef ARDUINO_DOORLOCK_BUTTONEVENTS_H
+#define ARDUINO_DOORLOCK_BUTTONEVENTS_H
+
+#include <Arduino.h>
+
+// --- Button Events (Gestures) ---
+// Besides the simple isButton1Pressed() style checks, the debouncer also reports what the
+// buttons are doing as a list of events. Read them one at a time with nextButtonEvent().
+
+// Which buttons an event is about. Several can be combined for a chord.
+const uint8_t DL_BUTTON_1 = 0x01;
+const uint8_t DL_BUTTON_2 = 0x02;
+const uint8_t DL_BUTTON_3 = 0x04;
+const uint8_t DL_BUTTON_LOCK = 0x08;
+
+enum DoorLockButtonEventType : uint8_t {
+    DL_EVENT_PRESS = 1,   // A button went down
+    DL_EVENT_RELEASE,     // A button came back up
+    DL_EVENT_LONG_PRESS,  // A button has been held for the long-press time
+    DL_EVENT_REPEAT,      // Still held after a long press; sent again every repeat interval
+    DL_EVENT_DOUBLE_TAP,  // Pressed again shortly after a quick tap
+    DL_EVENT_CHORD        // Two or more buttons are down together; `buttons` has all of them
+};
+
+struct DoorLockButtonEvent {
+    uint8_t type;     // DoorLockButtonEventType
+    uint8_t buttons;  // DL_BUTTON_... bits
+    unsigned long ms; // millis() when it happened
+};
+
+// --- Internal Event Queue ---
+// Single producer (the debouncer, which may run in the timer interrupt) and single consumer
+// (the sketch), so it needs no locking. When full, new events are dropped and push() says so
+// (the library counts them in its telemetry).
+class _ButtonEventQueue
+{
+private:
+    static const uint8_t SIZE = 8; // Must be a power of two
+    DoorLockButtonEvent _events[SIZE];
+    volatile uint8_t _head = 0;
+    volatile uint8_t _tail = 0;
+
+public:
+    // Returns false if the queue was full and the event was dropped.
+    bool push(uint8_t type, uint8_t buttons, unsigned long ms)
+    {
+        uint8_t head = _head;
+        uint8_t next = (head + 1) & (SIZE - 1);
+        if (next == _tail) {
+            return false;
+        }
+        _events[head].type = type;
+        _events[head].buttons = buttons;
+        _events[head].ms = ms;
+        __asm__ __volatile__("" ::: "memory");
+        _head = next;
+        return true;
+    }
+
+    bool pop(DoorLockButtonEvent& event)
+    {
+        uint8_t tail = _tail;
+        if (tail == _head) {
+            return false;
+        }
+        __asm__ __volatile__("" ::: "memory");
+        event = _events[tail];
+        _tail = (tail + 1) & (SIZE - 1);
+        return true;
+    }
+};
+
+#endif // ARDUINO_DOORLOCK_BUTTONEVENTS_H
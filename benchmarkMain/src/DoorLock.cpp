@@ -0,0 +1,2730 @@
+#include "DoorLock.h" // Include the header for our library
+#include <Arduino.h>        // Include Arduino core functions
+#if DOORLOCK_ENABLE_EEPROM
+#include <EEPROM.h>         // Lock state kept over a reset (fast boot)
+#endif
+#if defined(__AVR__)
+#include <avr/interrupt.h>  // ISR() for timer-interrupt button sampling
+#include <util/atomic.h>    // ATOMIC_BLOCK for flags shared with the interrupt
+#include <avr/sleep.h>      // Idle sleep in idleUntilEvent()
+#endif
+
+// --- Serial Monitor Messages ---
+// With DOORLOCK_ENABLE_LOGGING turned off these compile to nothing, text included.
+// With DOORLOCK_FAST_BOOT, Serial is started by the first message instead of by start().
+#if DOORLOCK_FAST_BOOT
+static void _serialStart()
+{
+    static bool started = false;
+    if (!started) {
+        started = true;
+        Serial.begin(115200);
+    }
+}
+#else
+static inline void _serialStart() {}
+#endif
+
+#if DOORLOCK_ENABLE_LOGGING
+#define DL_LOG(...) do { _serialStart(); Serial.print(__VA_ARGS__); } while (0)
+#define DL_LOGLN(...) do { _serialStart(); Serial.println(__VA_ARGS__); } while (0)
+#else
+#define DL_LOG(...) do {} while (0)
+#define DL_LOGLN(...) do {} while (0)
+#endif
+
+// Little-endian writers for replies and snapshots. Each returns the number of bytes written.
+static uint8_t _putU16(uint8_t* out, uint16_t value)
+{
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+    return 2;
+}
+
+static uint8_t _putU32(uint8_t* out, uint32_t value)
+{
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+    return 4;
+}
+
+// --- Telemetry Counters ---
+// DL_COUNT(unlocks) adds one to _telemetry.unlocks, or nothing when telemetry is turned off.
+#if DOORLOCK_ENABLE_TELEMETRY
+#define DL_COUNT(counter) _saturatingIncrement(_telemetry.counter)
+#else
+#define DL_COUNT(counter) do {} while (0)
+#endif
+
+#if DOORLOCK_ENABLE_LOGGING && DOORLOCK_ENABLE_SUPERVISOR
+// What to call each DoorLockSite (see Supervisor.h) in messages
+static const __FlashStringHelper* _siteName(uint8_t site)
+{
+    switch (site) {
+    case DL_SITE_SCAN: return F("scanButtons()");
+    case DL_SITE_BUTTON_HANDLER: return F("a buttonPressed() function");
+    case DL_SITE_DOOR_UNLOCK: return F("DoorUnlock()");
+    case DL_SITE_DOOR_LOCK: return F("DoorLock()");
+    case DL_SITE_DOOR_INCORRECT: return F("DoorIncorrect()");
+    case DL_SITE_TASK: return F("a task");
+    case DL_SITE_TIMEOUT_HANDLER: return F("an auto-relock/entry timeout handler");
+    case DL_SITE_SERIAL_COMMAND: return F("a Serial command");
+    case DL_SITE_RFID: return F("the RFID reader");
+    default: return F("the sketch (loop)");
+    }
+}
+#endif
+
+#if DOORLOCK_USE_EDGE_EVENTS || DOORLOCK_USE_LINUX_GPIO
+// Set by the pin-change interrupt (on Linux: by an edge event) whenever any button pin changes
+// level. Starts out true so the first scanButtons() reads every pin.
+static volatile bool _buttonEdgePending = true;
+#endif
+
+// --- Button Debounce Timing ---
+// In the default (polled) mode a button must read the same for its settle window after its last
+// change. Each button has its own window (see AdaptiveDebounce.h).
+// In timer sampling mode the same window is counted in timer ticks instead of milliseconds.
+// With the timer multiplexer the samples come from its 1 ms tick. Otherwise Timer0 overflows
+// every 64 * 256 CPU cycles (1024 us on a 16 MHz board), which is our sample period.
+#if DOORLOCK_USE_TIMER_MUX
+const unsigned long SAMPLE_PERIOD_US = 1000; // The timer multiplexer's 1 ms tick
+#elif defined(__AVR__)
+const unsigned long SAMPLE_PERIOD_US = (64UL * 256UL * 1000UL) / (F_CPU / 1000UL);
+#endif
+
+#if defined(__AVR__)
+// Samples in a row a new reading needs before the timer interrupt accepts it
+static uint8_t _settleSamples(uint8_t windowMs)
+{
+    return (windowMs * 1000UL + SAMPLE_PERIOD_US - 1) / SAMPLE_PERIOD_US;
+}
+#endif
+
+// --- Global Single Instance of the Internal Class ---
+// This is the one and only _DoorLockImpl object that will be created.
+// It's declared here, in the .cpp file, so it's not directly accessible
+// from user sketches, enforcing the single instance pattern.
+_DoorLockImpl _theDoorLockInstance; // Default constructor is called automatically
+
+// --- Implementation of _DoorLockImpl Class Methods ---
+
+// Private Default Constructor: Delegates to the full constructor with default values.
+_DoorLockImpl::_DoorLockImpl()
+    : _DoorLockImpl(DOORLOCK_DEFAULT_CODE, DOORLOCK_DEFAULT_CODE_LENGTH, true, // Default to locked
+                    DOORLOCK_BUTTON1_PIN, DOORLOCK_BUTTON2_PIN, DOORLOCK_BUTTON3_PIN, DOORLOCK_LOCK_BUTTON_PIN,
+                    DOORLOCK_GREEN_LED_PIN, DOORLOCK_RED_LED_PIN, DOORLOCK_SERVO_PIN, DOORLOCK_BUZZER_PIN)
+{
+    // Constructor delegation handles the initialization.
+}
+
+// Private Full Constructor: Initializes all member variables. All storage is fixed size, nothing is allocated.
+_DoorLockImpl::_DoorLockImpl(int* correctCode, int codeLength, bool Locked, int button1, int button2, int button3, int lockButton, int greenLED, int redLED, int servoPin, int buzzerPin)
+    : _button1(button1), _button2(button2), _button3(button3), _lockButton(lockButton), _greenLED(greenLED), _redLED(redLED), _servoPin(servoPin), _buzzerPin(buzzerPin), locked(Locked) // Initialize locked state
+{
+    // Stage the secret code into slot 0 and make it live.
+    _activeCode = 1;
+    if (!stageCorrectCode(correctCode, codeLength)) {
+        int fallback[] = {DOORLOCK_DEFAULT_CODE[0], DOORLOCK_DEFAULT_CODE[1], DOORLOCK_DEFAULT_CODE[2]};
+        stageCorrectCode(fallback, DOORLOCK_DEFAULT_CODE_LENGTH); // The slots must never be left empty
+    }
+    commitCorrectCode();
+
+    // Initialize the current attempt to 0.
+    for (int i = 0; i < DOORLOCK_MAX_CODE_LENGTH; i++) {
+        _attempt[i] = 0;
+    }
+
+    // Initialize debounce states (buttons use INPUT_PULLUP and pull LOW when pressed)
+    for (int i = 0; i < 4; i++) {
+        _lastReading[i] = LOW;
+        _stableState[i] = LOW;
+    }
+    _inputIndex = 0; // Ensure input index is reset
+}
+
+// Original `start()` method: Initializes hardware pins and sets initial state.
+void _DoorLockImpl::start()
+{
+#if DOORLOCK_FAST_BOOT
+    // Buttons first, so they work as soon as possible. The door stays the way it was before
+    // the reset; only if nothing was saved yet is it locked like a normal start().
+    _bindPins();
+    if (!_restoreLockState()) {
+        _servoWrite(0); // Ensure servo is at initial position (locked)
+        _setLocked(true);
+    } else if (!locked) {
+        _doorOpened(); // A relock that was due before the reset starts counting again
+    }
+#else
+#if DOORLOCK_ENABLE_LOGGING || DOORLOCK_ENABLE_SERIAL_COMMANDS
+    // Start serial communication (optional, but good for debugging)
+    Serial.begin(115200);
+#endif
+    DL_LOGLN("DoorLock library initialized.");
+
+    // Set pin modes for the buttons, LEDs and buzzer and cache their port registers.
+    // This also turns both LEDs off.
+    _bindPins();
+
+    // Attach the servo to its pin
+    _servoAttach();
+
+    // Set initial states (consistent with original logic where lock() is called separately)
+    buzzerOff();
+    _servoWrite(0); // Ensure servo is at initial position (locked)
+    resetAttempt(); // Clear any previous attempt
+#endif
+#if DOORLOCK_USE_RFID
+    _rfid.begin(DOORLOCK_RFID_SS_PIN, millis()); // Only resets the reader; cards are read from scanButtons()
+#endif
+#if DOORLOCK_USE_SCHEDULES
+    _schedule.begin();
+#endif
+#if DOORLOCK_USE_CLOCK
+    _clock.begin(millis());
+#endif
+#if DOORLOCK_USE_DISPLAY
+    _display.begin(); // Blanks the screen over the next scanButtons() calls
+    _shownLocked = 0xFF;
+    _shownDigits = 0xFF;
+#endif
+    _started = true;
+    _auditEvent(DL_AUDIT_BOOT);
+
+#if DOORLOCK_ENABLE_SUPERVISOR
+    // Say what went wrong before the reset, if anything (with fast boot only after a watchdog
+    // reset, so a normal reset doesn't start Serial)
+    if (_theSupervisor.takePreviousReport(_previousStall) && (_previousStall.watchdogReset || !DOORLOCK_FAST_BOOT)) {
+        if (_previousStall.watchdogReset) {
+            DL_LOG("Watchdog reset! Stuck in: ");
+            DL_LOGLN(_siteName(_previousStall.watchdogSite));
+        }
+        DL_LOG("Longest pause between scanButtons() calls before the reset: ");
+        DL_LOG(_previousStall.longestGapMs);
+        DL_LOG(" ms, in: ");
+        DL_LOGLN(_siteName(_previousStall.longestGapSite));
+    }
+#endif
+}
+
+// --- Lock Control Functions (Original Names) ---
+// DoorUnlock(), DoorLock() and DoorIncorrect() post their servo/LED moves to the actuator queue
+// and return right away. scanButtons() carries the moves out, waits included, so button
+// presses are still read while the LED is lit.
+void _DoorLockImpl::DoorUnlock()
+{
+    _SiteGuard guard(DL_SITE_DOOR_UNLOCK);
+    DL_COUNT(unlocks);
+    _setLocked(false);
+    if (_startActuatorSequence(4)) {
+        _postActuator(DL_ACT_SERVO, 180); // Adjust servo position for unlocked state (e.g., 180 degrees)
+        _postActuator(DL_ACT_GREEN_LED, 1);
+        _postActuator(DL_ACT_WAIT, 1000); // Original delay for green LED
+        _postActuator(DL_ACT_GREEN_LED, 0);
+    }
+    resetAttempt(); // Original behavior
+    _auditEvent(DL_AUDIT_UNLOCK);
+    DL_LOGLN("Door unlocked.");
+}
+
+// Renamed due to `lock` being a reserved word or common function name in global scope
+// `void_lock` is just an internal name. The namespace function `DoorLock::lock()` will call this.
+void _DoorLockImpl::DoorLock()
+{
+    _SiteGuard guard(DL_SITE_DOOR_LOCK);
+    DL_COUNT(locks);
+    _setLocked(true);
+    if (_startActuatorSequence(4)) {
+        _postActuator(DL_ACT_SERVO, 0); // Adjust servo position for locked state (e.g., 0 degrees)
+        _postActuator(DL_ACT_RED_LED, 1);
+        _postActuator(DL_ACT_WAIT, 1000); // Original delay for red LED
+        _postActuator(DL_ACT_RED_LED, 0);
+    }
+    resetAttempt(); // Original behavior
+    _auditEvent(DL_AUDIT_LOCK);
+    DL_LOGLN("Door locked.");
+}
+
+// open() and close() only move the servo (no LEDs), but they still change `locked`, so the
+// state machine and auto-relock know where the door is.
+void _DoorLockImpl::open() // Original `open()`
+{
+    DL_COUNT(unlocks);
+    _setLocked(false);
+    _servoWrite(180); // Corresponds to unlock
+}
+
+void _DoorLockImpl::close() // Original `close()`
+{
+    DL_COUNT(locks);
+    _setLocked(true);
+    _servoWrite(0); // Corresponds to lock
+}
+
+// --- Code Entry and Verification Functions (Original Names) ---
+void _DoorLockImpl::DoorIncorrect()
+{
+    _SiteGuard guard(DL_SITE_DOOR_INCORRECT);
+    if (_startActuatorSequence(3)) {
+        _postActuator(DL_ACT_RED_LED, 1); // Original behavior
+        _postActuator(DL_ACT_WAIT, 1000);
+        _postActuator(DL_ACT_RED_LED, 0);
+    }
+    resetAttempt(); // Original behavior
+    _auditEvent(DL_AUDIT_INCORRECT);
+    DL_LOGLN("Incorrect code.");
+}
+
+void _DoorLockImpl::resetAttempt()
+{
+    for (int i = 0; i < DOORLOCK_MAX_CODE_LENGTH; i++) {
+        _attempt[i] = 0; // Clear the attempt array
+    }
+    _inputIndex = 0;
+#if DOORLOCK_ENABLE_TIMEOUTS
+    _timers.cancel(DL_TIMER_ENTRY);
+#endif
+#if DOORLOCK_USE_TOTP
+    _oneTimeCodeAccepted = false;
+#endif
+    DL_LOGLN("Attempt reset.");
+}
+
+bool _DoorLockImpl::isAttemptCorrect()
+{
+    // Compare against one snapshot of the live slot, so a commit can't switch codes halfway
+    // through. A commit and then another stage (both from an interrupt) would rewrite the slot
+    // being compared, so the compare starts over if any commit came in while it ran.
+    bool lengthMatches;
+    bool correct;
+    uint8_t commits;
+    do {
+        commits = _codeCommits;
+        __asm__ __volatile__("" ::: "memory"); // Read the code only after the commit count
+        uint8_t slot = _activeCode;
+        const int* correctCode = _codes[slot];
+        int codeLength = _codeLengths[slot];
+        lengthMatches = _inputIndex == codeLength; // Check if the correct number of digits were entered
+        correct = lengthMatches;
+        for (int i = 0; correct && i < codeLength; i++) {
+            if (_attempt[i] != correctCode[i]) {
+                correct = false;
+            }
+        }
+        __asm__ __volatile__("" ::: "memory");
+    } while (commits != _codeCommits);
+    if (!lengthMatches) {
+        DL_LOGLN("Attempt length mismatch.");
+    }
+    if (correct && !_accessAllowed(0)) { // The keypad code is user 0
+        DL_LOGLN("Right code, but not at this time.");
+        correct = false;
+    }
+#if DOORLOCK_USE_TOTP
+    // A one-time code is used up by the first check, so later checks of the same entry just
+    // remember that it matched.
+    if (!correct && !_oneTimeCodeAccepted && _totp.matches(_attempt, _inputIndex)) {
+        DL_LOGLN("One-time code accepted.");
+        _auditEvent(DL_AUDIT_ONE_TIME_CODE);
+        _oneTimeCodeAccepted = true;
+    }
+    correct = correct || _oneTimeCodeAccepted;
+#endif
+
+#if DOORLOCK_ENABLE_TELEMETRY
+    // Each typed code is counted once, however often it gets checked
+    if (_entryTiming) {
+        _entryTiming = false;
+        _saturatingIncrement(_telemetry.entries);
+        _saturatingAdd(_telemetry.entryTimeMs, millis() - _entryStartMs);
+        if (!correct) {
+            _saturatingIncrement(_telemetry.incorrect);
+        }
+    }
+#endif
+    return correct;
+}
+
+// --- Configuration Setters (Original Names) ---
+bool _DoorLockImpl::setCorrectCode(int* code, int codeLength)
+{
+    if (!stageCorrectCode(code, codeLength)) {
+        return false;
+    }
+    commitCorrectCode();
+    DL_LOGLN("Secret code and code length updated.");
+    return true;
+}
+
+// Copies a new code into the spare slot. The live code keeps working until commitCorrectCode().
+// A code that doesn't fit the slots is refused, and whatever was staged before stays staged.
+bool _DoorLockImpl::stageCorrectCode(int* code, int codeLength)
+{
+    if (codeLength < 1 || codeLength > DOORLOCK_MAX_CODE_LENGTH) {
+        DL_LOG("Code refused: it must be 1 to ");
+        DL_LOG(DOORLOCK_MAX_CODE_LENGTH);
+        DL_LOGLN(" digits long.");
+        return false;
+    }
+    uint8_t spare = 1 - _activeCode;
+    for (int i = 0; i < codeLength; i++) {
+        _codes[spare][i] = code[i];
+    }
+    _codeLengths[spare] = codeLength;
+    _codeStaged = true;
+    return true;
+}
+
+// Makes the staged code live with a single write of _activeCode. Returns false if nothing was staged.
+// A half-entered attempt is kept as long as it still fits in the new code.
+bool _DoorLockImpl::commitCorrectCode()
+{
+    if (!_codeStaged) {
+        return false;
+    }
+    _codeStaged = false;
+    __asm__ __volatile__("" ::: "memory"); // Finish writing the staged code before making it live
+    _activeCode = 1 - _activeCode;
+    _codeCommits++;
+    if (_started) {
+        _auditEvent(DL_AUDIT_CODE_CHANGED); // The code given before start() is the first one, not a change
+    }
+    if (_inputIndex > _entryLength()) {
+        resetAttempt();
+    }
+    return true;
+}
+
+// Private helper used by start() and setPins().
+void _DoorLockImpl::_bindPins()
+{
+#if DOORLOCK_USE_LINUX_GPIO
+    _theLinuxGpio.releaseLines(); // Lines of the old pins go back to the kernel
+    _buttonEdgePending = true;
+#endif
+    // Buttons use INPUT_PULLUP (original had INPUT, but PULLUP is safer for physical buttons),
+    // so they read HIGH when released and LOW when pressed.
+    _buttonPins[0].bindInput(_button1);
+    _buttonPins[1].bindInput(_button2);
+    _buttonPins[2].bindInput(_button3);
+    _buttonPins[3].bindInput(_lockButton);
+
+#if DOORLOCK_USE_TIMER_MUX
+    // The timer multiplexer owns the LED and buzzer pins so it can dim and beep them.
+#if DOORLOCK_ENABLE_LEDS
+    _theTimerMux.bindLED(DL_MUX_RED_LED, _redLED);
+    _theTimerMux.bindLED(DL_MUX_GREEN_LED, _greenLED);
+#endif
+#if DOORLOCK_ENABLE_BUZZER
+    _theTimerMux.bindBuzzer(_buzzerPin);
+#endif
+#else
+#if DOORLOCK_ENABLE_LEDS
+    _redPin.bindOutput(_redLED);
+    _greenPin.bindOutput(_greenLED);
+#endif
+#if DOORLOCK_ENABLE_BUZZER && !DOORLOCK_USE_LINUX_GPIO
+    // Buzzer pin as output for tone() function (on Linux the buzzer is a PWM channel)
+    pinMode(_buzzerPin, OUTPUT);
+#endif
+#endif
+
+#if DOORLOCK_USE_EDGE_EVENTS
+    // Turn on the pin-change interrupt of every button pin.
+    int buttons[] = {_button1, _button2, _button3, _lockButton};
+    for (uint8_t i = 0; i < 4; i++) {
+#if DOORLOCK_USE_EXPANDER
+        if (buttons[i] >= DL_EXPANDER_PIN) {
+            buttons[i] = DOORLOCK_EXPANDER_INT_PIN; // The expander tells us through its INT line
+        }
+#endif
+        volatile uint8_t* pcicr = digitalPinToPCICR(buttons[i]);
+        if (pcicr == 0) {
+            DL_LOGLN("Button pin has no pin-change interrupt.");
+            continue;
+        }
+        *digitalPinToPCMSK(buttons[i]) |= _BV(digitalPinToPCMSKbit(buttons[i]));
+        *pcicr |= _BV(digitalPinToPCICRbit(buttons[i]));
+    }
+    _buttonEdgePending = true;
+#endif
+}
+
+// Private helpers: the servo goes through the timer multiplexer when it is enabled,
+// otherwise through the Servo library as before.
+void _DoorLockImpl::_servoAttach()
+{
+    _servoAttached = true;
+#if DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.attachServo(_servoPin);
+#elif DOORLOCK_USE_LINUX_GPIO
+    _theLinuxGpio.attachServo();
+#else
+    _servo.attach(_servoPin);
+#endif
+}
+
+// Cuts the drive: without pulses the servo stops pushing. The next move attaches it again.
+void _DoorLockImpl::_servoDetach()
+{
+    _servoAttached = false;
+#if DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.detachServo();
+#elif DOORLOCK_USE_LINUX_GPIO
+    _theLinuxGpio.detachServo();
+#else
+    _servo.detach();
+#endif
+}
+
+void _DoorLockImpl::_servoWrite(int angle)
+{
+    DL_COUNT(servoMoves);
+#if DOORLOCK_USE_SERVO_SENSE
+    _servoSense.moveStarted(angle, millis());
+#endif
+    _servoDrive(angle);
+}
+
+// Sends the servo to an angle without starting a new watched move (retries use this directly)
+void _DoorLockImpl::_servoDrive(int angle)
+{
+    if (!_servoAttached) {
+        _servoAttach();
+    }
+#if DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.writeServo(angle);
+#elif DOORLOCK_USE_LINUX_GPIO
+    _theLinuxGpio.writeServo(angle);
+#else
+    _servo.write(angle);
+#endif
+}
+
+// Private helper: a stalled move gets its drive cut, then is tried again. If the last try stalls
+// too the bolt is stuck where it was: `locked` goes back to what the door really is and the jam
+// is reported, with the drive left off so the servo doesn't burn out pushing.
+void _DoorLockImpl::_pollServo(unsigned long now)
+{
+#if DOORLOCK_USE_SERVO_SENSE
+    switch (_servoSense.poll(now)) {
+    case DL_SERVO_STALLED:
+        _servoDetach();
+        DL_LOGLN("Servo stalled, trying again.");
+        break;
+    case DL_SERVO_RETRY:
+        _servoDrive(_servoSense.target());
+        break;
+    case DL_SERVO_JAMMED:
+        _servoDetach();
+        _setLocked(_servoSense.target() != 0); // An unlock that didn't get there leaves the door locked
+        if (_startActuatorSequence(3)) {
+            _postActuator(DL_ACT_RED_LED, 1);
+            _postActuator(DL_ACT_WAIT, 1000);
+            _postActuator(DL_ACT_RED_LED, 0);
+        }
+        _auditEvent(DL_AUDIT_JAM);
+        DL_LOGLN("Lock jammed!");
+        break;
+    default: break;
+    }
+#else
+    (void)now;
+#endif
+}
+
+// True while the last servo move ended in a jam
+bool _DoorLockImpl::isJammed()
+{
+#if DOORLOCK_USE_SERVO_SENSE
+    return _servoSense.jammed();
+#else
+    return false;
+#endif
+}
+
+// Private helpers: with fast boot, the lock state is saved in 2 EEPROM bytes (a marker and
+// locked/unlocked) so start() can pick up where the door was. EEPROM.update() only writes
+// when the value changes, so the marker is written once and the state byte twice per
+// unlock/lock cycle (see DOORLOCK_EEPROM_ADDRESS for how long that lasts).
+const uint8_t EEPROM_STATE_MARKER = 0xD1;
+
+void _DoorLockImpl::_saveLockState(bool isLocked)
+{
+#if DOORLOCK_FAST_BOOT && DOORLOCK_ENABLE_EEPROM
+    EEPROM.update(DOORLOCK_EEPROM_ADDRESS, EEPROM_STATE_MARKER);
+    EEPROM.update(DOORLOCK_EEPROM_ADDRESS + 1, isLocked ? 1 : 0);
+#else
+    (void)isLocked;
+#endif
+}
+
+bool _DoorLockImpl::_restoreLockState()
+{
+#if DOORLOCK_FAST_BOOT && DOORLOCK_ENABLE_EEPROM
+    uint8_t state = EEPROM.read(DOORLOCK_EEPROM_ADDRESS + 1);
+    if (EEPROM.read(DOORLOCK_EEPROM_ADDRESS) != EEPROM_STATE_MARKER || state > 1) {
+        return false;
+    }
+    locked = state == 1;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void _DoorLockImpl::setPins(int button1, int button2, int button3, int lockButton, int greenLED, int redLED, int servoPin, int buzzerPin)
+{
+    _button1 = button1;
+    _button2 = button2;
+    _button3 = button3;
+    _lockButton = lockButton;
+    _greenLED = greenLED;
+    _redLED = redLED;
+    _servoPin = servoPin;
+    _buzzerPin = buzzerPin;
+
+    // Re-initialize pin modes (and cached registers) for the newly assigned pins
+    _bindPins();
+    if (_servoAttached) {
+        _servoAttach(); // Re-attach servo to the new pin
+    }
+    DL_LOGLN("Pin assignments updated.");
+}
+
+// --- Button Press Handlers (Original Names) ---
+void _DoorLockImpl::button1Pressed()
+{
+    _SiteGuard guard(DL_SITE_BUTTON_HANDLER);
+    DL_LOGLN("button 1 pressed");
+    if (_inputIndex < _entryLength()) {
+        _attempt[_inputIndex] = 1;
+        _inputIndex++;
+        _digitEntered();
+        for (int i = 0; i < _entryLength(); i++) {
+            DL_LOG(_attempt[i]);
+            DL_LOG(",");
+        }
+        DL_LOGLN();
+    }
+}
+
+void _DoorLockImpl::button2Pressed()
+{
+    _SiteGuard guard(DL_SITE_BUTTON_HANDLER);
+    DL_LOGLN("button 2 pressed");
+    if (_inputIndex < _entryLength()) {
+        _attempt[_inputIndex] = 2;
+        _inputIndex++;
+        _digitEntered();
+        for (int i = 0; i < _entryLength(); i++) {
+            DL_LOG(_attempt[i]);
+            DL_LOG(",");
+        }
+        DL_LOGLN();
+    }
+}
+
+void _DoorLockImpl::button3Pressed()
+{
+    _SiteGuard guard(DL_SITE_BUTTON_HANDLER);
+    DL_LOGLN("button 3 pressed");
+    if (_inputIndex < _entryLength()) {
+        _attempt[_inputIndex] = 3;
+        _inputIndex++;
+        _digitEntered();
+        for (int i = 0; i < _entryLength(); i++) {
+            DL_LOG(_attempt[i]);
+            DL_LOG(",");
+        }
+        DL_LOGLN();
+    }
+}
+
+// --- Button Status Checks (Original Names) ---
+// This uses the scanButtons for debouncing before returning the state
+
+// Return the "just pressed" flag and then reset it (consume the press).
+bool _DoorLockImpl::_consumePress(uint8_t index)
+{
+    bool pressed;
+#if defined(__AVR__)
+    // The timer interrupt may set a flag between our read and our clear, so do both at once.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        pressed = _buttonJustPressedFlags[index];
+        _buttonJustPressedFlags[index] = false;
+    }
+#else
+    pressed = _buttonJustPressedFlags[index];
+    _buttonJustPressedFlags[index] = false;
+#endif
+    return pressed;
+}
+
+bool _DoorLockImpl::isButton1Pressed()
+{
+    return _consumePress(0);
+}
+
+bool _DoorLockImpl::isButton2Pressed()
+{
+    return _consumePress(1);
+}
+
+bool _DoorLockImpl::isButton3Pressed()
+{
+    return _consumePress(2);
+}
+
+bool _DoorLockImpl::isLockButtonPressed()
+{
+    return _consumePress(3);
+}
+
+void _DoorLockImpl::redLEDToggle(bool state)
+{
+#if !DOORLOCK_ENABLE_LEDS
+    (void)state;
+#elif DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.setLED(DL_MUX_RED_LED, state ? 255 : 0);
+#else
+    _redPin.write(state);
+#endif
+}
+
+void _DoorLockImpl::greenLEDToggle(bool state)
+{
+#if !DOORLOCK_ENABLE_LEDS
+    (void)state;
+#elif DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.setLED(DL_MUX_GREEN_LED, state ? 255 : 0);
+#else
+    _greenPin.write(state);
+#endif
+}
+
+// LED dimming needs the timer multiplexer. Without it any level above 0 just turns the LED on.
+void _DoorLockImpl::redLEDBrightness(uint8_t level)
+{
+#if !DOORLOCK_ENABLE_LEDS
+    (void)level;
+#elif DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.setLED(DL_MUX_RED_LED, level);
+#else
+    _redPin.write(level > 0);
+#endif
+}
+
+void _DoorLockImpl::greenLEDBrightness(uint8_t level)
+{
+#if !DOORLOCK_ENABLE_LEDS
+    (void)level;
+#elif DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.setLED(DL_MUX_GREEN_LED, level);
+#else
+    _greenPin.write(level > 0);
+#endif
+}
+
+void _DoorLockImpl::buzzerOn(int hz)
+{
+#if !DOORLOCK_ENABLE_BUZZER
+    (void)hz;
+#elif DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.buzzerOn(hz);
+#elif DOORLOCK_USE_LINUX_GPIO
+    _theLinuxGpio.buzzerOn(hz);
+#else
+    tone(_buzzerPin, hz);
+#endif
+}
+
+void _DoorLockImpl::buzzerOff()
+{
+#if !DOORLOCK_ENABLE_BUZZER
+#elif DOORLOCK_USE_TIMER_MUX
+    _theTimerMux.buzzerOff();
+#elif DOORLOCK_USE_LINUX_GPIO
+    _theLinuxGpio.buzzerOff();
+#else
+    noTone(_buzzerPin);
+#endif
+}
+
+// --- Internal Debouncing Logic (Original Name) ---
+void _DoorLockImpl::scanButtons()
+{
+    if (_bootToFirstScanUs == 0) {
+        _bootToFirstScanUs = micros(); // First call since reset: the lock is ready for input
+    }
+#if DOORLOCK_ENABLE_SUPERVISOR
+    _theSupervisor.scanned(millis());
+#endif
+    _SiteGuard guard(DL_SITE_SCAN);
+
+    // Let any waiting tasks and queued servo/LED commands carry on first.
+    _runTasks();
+    _runActuators();
+    _pollServo(millis());
+    _pollSerialCommands();
+    _runTimers(millis());
+    _pollRfid(millis());
+    _pollClock(millis());
+    _updateDisplay(millis());
+#if DOORLOCK_USE_EXPANDER
+    // Send this round's LED changes to the expander and fetch its buttons if one changed.
+    _thePortExpander.update();
+#endif
+#if DOORLOCK_USE_LINUX_GPIO
+    // Write this round's LED changes and take in the button edges the kernel has queued.
+    if (_theLinuxGpio.update()) {
+        _buttonEdgePending = true;
+    }
+#endif
+
+    // In timer sampling mode the interrupt has already done the work; the flags are ready to read.
+    if (_timerSampling) {
+        return;
+    }
+
+#if DOORLOCK_USE_EDGE_EVENTS || DOORLOCK_USE_LINUX_GPIO
+    // No pin has changed, every button is settled and none is held (long-press timing), so
+    // there is nothing to do.
+    if (!_buttonEdgePending && !_buttonsSettling && _heldMask == 0) {
+        return;
+    }
+    _buttonEdgePending = false; // Cleared before reading, so a change during the scan is seen next time
+#endif
+
+    unsigned long now = millis(); // Read the clock once for all four buttons
+    bool settling = false;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        int currentReading = _buttonPins[i].read();
+
+        // If the reading has changed from the last time
+        if (currentReading != _lastReading[i]) {
+            if (currentReading == _stableState[i] && !_debounce[i].settled(now)) {
+                DL_COUNT(bounces[i]); // Went back before the settle window was over
+            }
+            _debounce[i].contactChanged(now); // Restarts the settle window for this button
+        } else {
+            _debounce[i].update(now);
+        }
+
+        // If the reading has been steady for the settle window since the last change
+        if (_debounce[i].settled(now)) {
+            // If the stable state is different from the current reading, it means a debounced change has occurred
+            if (currentReading != _stableState[i]) {
+                _stableState[i] = currentReading; // Update the stable state
+                _debounce[i].accepted(now);
+
+                // A transition from NOT pressed (HIGH) to PRESSED (LOW) is a "just pressed" event.
+                _buttonChanged(i, _stableState[i] == LOW, now);
+            }
+        }
+        _lastReading[i] = currentReading; // Save the current raw reading for the next loop
+        if (currentReading != _stableState[i]) {
+            settling = true; // Still waiting out the debounce delay
+        }
+    }
+    _buttonsSettling = settling;
+    _checkHeldButtons(now);
+}
+
+
+// --- Auto-Relock and Code Entry Timeout ---
+// Both are one-shot timers in _timers. Checking them costs the same every update whether or
+// not they are armed, so the sketch never has to keep its own timestamps.
+
+// Private helper: the one place `locked` changes after start(). The fast boot state in EEPROM and
+// the relock timer always follow it, whoever moved the door.
+void _DoorLockImpl::_setLocked(bool isLocked)
+{
+    locked = isLocked;
+    _saveLockState(isLocked);
+    if (isLocked) {
+        _doorClosed();
+    } else {
+        _doorOpened();
+    }
+}
+
+// Private helper: the door was just opened, start counting down to the relock.
+void _DoorLockImpl::_doorOpened()
+{
+#if DOORLOCK_ENABLE_TIMEOUTS
+    if (_autoRelockMs > 0) {
+        _timers.arm(DL_TIMER_RELOCK, millis(), _autoRelockMs);
+    }
+#endif
+}
+
+// Private helper: the door was just closed, no relock needed any more.
+void _DoorLockImpl::_doorClosed()
+{
+#if DOORLOCK_ENABLE_TIMEOUTS
+    _timers.cancel(DL_TIMER_RELOCK);
+#endif
+}
+
+// Private helper: a digit was just typed, restart the entry timeout.
+void _DoorLockImpl::_digitEntered()
+{
+#if DOORLOCK_USE_TOTP
+    _oneTimeCodeAccepted = false;
+#endif
+#if DOORLOCK_ENABLE_TELEMETRY
+    if (_inputIndex == 1) {
+        _entryStartMs = millis();
+        _entryTiming = true;
+    }
+#endif
+#if DOORLOCK_ENABLE_TIMEOUTS
+    if (_entryTimeoutMs > 0) {
+        _timers.arm(DL_TIMER_ENTRY, millis(), _entryTimeoutMs);
+    }
+#endif
+}
+
+// Private helper: acts on any timer that has run out.
+void _DoorLockImpl::_runTimers(unsigned long now)
+{
+#if DOORLOCK_ENABLE_TIMEOUTS
+    uint8_t fired = _timers.expired(now);
+    if (fired == 0) {
+        return;
+    }
+    if (fired & (1 << DL_TIMER_ENTRY)) {
+        DL_LOGLN("Code entry timed out.");
+        resetAttempt();
+        if (_entryTimeoutHandler) {
+            _SiteGuard guard(DL_SITE_TIMEOUT_HANDLER, (uintptr_t)_entryTimeoutHandler);
+            _entryTimeoutHandler();
+        }
+    }
+    if (fired & (1 << DL_TIMER_RELOCK)) {
+        DL_LOGLN("Auto-relock.");
+        if (_autoRelockHandler) {
+            _SiteGuard guard(DL_SITE_TIMEOUT_HANDLER, (uintptr_t)_autoRelockHandler);
+            _autoRelockHandler();
+        } else {
+            lockEvent(DL_LOCK_EVENT_LOCK);
+        }
+    }
+#else
+    (void)now;
+#endif
+}
+
+void _DoorLockImpl::setAutoRelock(unsigned long seconds, void (*handler)())
+{
+#if DOORLOCK_ENABLE_TIMEOUTS
+    _autoRelockMs = seconds * 1000UL;
+    _autoRelockHandler = handler;
+    if (_autoRelockMs == 0) {
+        _timers.cancel(DL_TIMER_RELOCK);
+    } else if (!locked && !_timers.isArmed(DL_TIMER_RELOCK)) {
+        _doorOpened(); // Already open (e.g. restored by fast boot): count from now
+    }
+#else
+    (void)seconds;
+    (void)handler;
+#endif
+}
+
+void _DoorLockImpl::setEntryTimeout(unsigned long ms, void (*handler)())
+{
+#if DOORLOCK_ENABLE_TIMEOUTS
+    _entryTimeoutMs = ms;
+    _entryTimeoutHandler = handler;
+    if (_entryTimeoutMs == 0) {
+        _timers.cancel(DL_TIMER_ENTRY);
+    }
+#else
+    (void)ms;
+    (void)handler;
+#endif
+}
+
+// --- Memory Usage (see MemoryStats.h) ---
+DoorLockMemoryStats _DoorLockImpl::memoryStats()
+{
+    DoorLockMemoryStats stats;
+    _readMemoryStats(stats);
+    return stats;
+}
+
+void _DoorLockImpl::printMemoryStats()
+{
+#if DOORLOCK_ENABLE_MEMORY_STATS
+    _serialStart();
+    DoorLockMemoryStats stats = memoryStats();
+    Serial.print("Globals: ");
+    Serial.print(stats.dataBytes + stats.bssBytes);
+    Serial.print(" bytes, heap: ");
+    Serial.print(stats.heapUsed);
+    Serial.print(" bytes, free: ");
+    Serial.print(stats.freeBytes);
+    Serial.print(" bytes (largest ");
+    Serial.print(stats.largestFreeBlock);
+    Serial.print("), stack never came closer than ");
+    Serial.print(stats.stackFreeMin);
+    Serial.println(" bytes to the heap");
+#endif
+}
+
+// How long after reset the first scanButtons() call came, in microseconds (0 until then).
+// The bootloader's own wait after a reset isn't included: micros() starts counting after it.
+unsigned long _DoorLockImpl::bootTimeMicros()
+{
+    return _bootToFirstScanUs;
+}
+
+// --- Adaptive Debounce (see AdaptiveDebounce.h) ---
+static int8_t _buttonIndex(uint8_t button)
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        if (button == (1 << i)) { // DL_BUTTON_1, _2, _3 and _LOCK are bits 0 to 3
+            return i;
+        }
+    }
+    return -1;
+}
+
+DoorLockDebounceReport _DoorLockImpl::debounceReport(uint8_t button)
+{
+    DoorLockDebounceReport report = {};
+    int8_t i = _buttonIndex(button);
+    if (i < 0) {
+        return report;
+    }
+#if defined(__AVR__)
+    // The timer interrupt may be debouncing this button
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _debounce[i].report(report);
+    }
+#else
+    _debounce[i].report(report);
+#endif
+    return report;
+}
+
+void _DoorLockImpl::printDebounceReport()
+{
+#if DOORLOCK_ENABLE_ADAPTIVE_DEBOUNCE
+    _serialStart();
+    for (uint8_t i = 0; i < 4; i++) {
+        DoorLockDebounceReport report = debounceReport(1 << i);
+        if (i < 3) {
+            Serial.print(F("Button "));
+            Serial.print(i + 1);
+        } else {
+            Serial.print(F("Lock button"));
+        }
+        Serial.print(F(": settles in "));
+        Serial.print(report.windowMs);
+        Serial.print(F(" ms, worst bounce "));
+        Serial.print(report.worstMs);
+        if (report.learnedMs > 0) {
+            Serial.print(F(" ms ("));
+            Serial.print(report.learnedMs);
+            Serial.print(F(" ms when learned), late bounces "));
+        } else {
+            Serial.print(F(" ms (still learning), late bounces "));
+        }
+        Serial.print(report.lateBounces);
+        Serial.print(F(", bounces <1/1/2/4/8/16/32/64+ ms:"));
+        for (uint8_t bin = 0; bin < DL_BOUNCE_BINS; bin++) {
+            Serial.print(F(" "));
+            Serial.print(report.histogram[bin]);
+        }
+        if (report.degrading) {
+            Serial.print(F("  <- wearing out, bouncing longer than before"));
+        }
+        Serial.println();
+    }
+#endif
+}
+
+// --- Telemetry (see Telemetry.h) ---
+DoorLockTelemetry _DoorLockImpl::telemetry()
+{
+    DoorLockTelemetry copy = {};
+#if DOORLOCK_ENABLE_TELEMETRY
+#if defined(__AVR__)
+    // The timer interrupt may be counting key presses and bounces
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        copy = _telemetry;
+    }
+#else
+    copy = _telemetry;
+#endif
+#endif
+    return copy;
+}
+
+// Writes the counters as a DL_TELEMETRY_SNAPSHOT_SIZE byte snapshot and returns its length.
+uint8_t _DoorLockImpl::telemetrySnapshot(uint8_t* out)
+{
+    DoorLockTelemetry counters = telemetry();
+    uint8_t n = 0;
+    out[n++] = DL_TELEMETRY_VERSION;
+    n += _putU32(out + n, millis());
+    n += _putU16(out + n, counters.unlocks);
+    n += _putU16(out + n, counters.locks);
+    n += _putU16(out + n, counters.incorrect);
+    n += _putU16(out + n, counters.servoMoves);
+    for (uint8_t i = 0; i < 4; i++) {
+        n += _putU16(out + n, counters.keyPresses[i]);
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        n += _putU16(out + n, counters.bounces[i]);
+    }
+    n += _putU16(out + n, counters.entries);
+    n += _putU32(out + n, counters.entryTimeMs);
+    n += _putU16(out + n, counters.eventsDropped);
+    return n;
+}
+
+void _DoorLockImpl::resetTelemetry()
+{
+#if DOORLOCK_ENABLE_TELEMETRY
+#if defined(__AVR__)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memset(&_telemetry, 0, sizeof(_telemetry));
+    }
+#else
+    memset(&_telemetry, 0, sizeof(_telemetry));
+#endif
+#endif
+}
+
+// --- Loop-Stall Supervisor (see Supervisor.h) ---
+// Turns on the hardware watchdog: if scanButtons() isn't called for about `ms` milliseconds,
+// the board writes down what was running and resets. 0 turns it off. AVR boards only.
+void _DoorLockImpl::enableWatchdog(unsigned long ms)
+{
+#if DOORLOCK_ENABLE_SUPERVISOR && defined(__AVR__)
+    _theSupervisor.enableWatchdog(ms);
+#else
+    if (ms > 0) {
+        DL_LOGLN("The watchdog is not available on this board.");
+    }
+#endif
+}
+
+DoorLockStallReport _DoorLockImpl::stallReport()
+{
+    DoorLockStallReport report = {};
+#if DOORLOCK_ENABLE_SUPERVISOR
+    _theSupervisor.currentReport(report);
+#endif
+    return report;
+}
+
+DoorLockStallReport _DoorLockImpl::previousStallReport()
+{
+#if DOORLOCK_ENABLE_SUPERVISOR
+    return _previousStall;
+#else
+    DoorLockStallReport report = {};
+    return report;
+#endif
+}
+
+// --- Button Events (see ButtonEvents.h) ---
+#if DOORLOCK_ENABLE_GESTURES
+// Private helper: queues a button event, counting it in the telemetry if the queue is full.
+void _DoorLockImpl::_pushButtonEvent(uint8_t type, uint8_t buttons, unsigned long now)
+{
+    if (!_buttonEvents.push(type, buttons, now)) {
+        DL_COUNT(eventsDropped);
+    }
+}
+#endif
+
+// Private helper: called by the debouncer whenever a button's debounced state changes.
+void _DoorLockImpl::_buttonChanged(uint8_t index, bool pressed, unsigned long now)
+{
+    if (pressed) {
+        _buttonJustPressedFlags[index] = true; // Set the flag for one-shot detection
+        DL_COUNT(keyPresses[index]);
+    }
+#if DOORLOCK_ENABLE_GESTURES
+    uint8_t bit = 1 << index;
+    if (pressed) {
+        _pushButtonEvent(DL_EVENT_PRESS, bit, now);
+        if ((_quickTapMask & bit) && now - _releasedAt[index] <= _doubleTapMs) {
+            _pushButtonEvent(DL_EVENT_DOUBLE_TAP, bit, now); // The bit stays set, so the release clears it
+        } else {
+            _quickTapMask &= ~bit; // Too late for a pair: this press may start a new one
+        }
+        _heldMask |= bit;
+        _longPressMask &= ~bit;
+        _pressedAt[index] = now;
+        if (_heldMask != bit) {
+            _pushButtonEvent(DL_EVENT_CHORD, _heldMask, now);
+        }
+    } else if (_heldMask & bit) {
+        // (Buttons settling to "up" at power-on were never down, so they don't send a release.)
+        _pushButtonEvent(DL_EVENT_RELEASE, bit, now);
+        // A quick tap starts a pair, unless it just ended one: then a third tap starts a new pair
+        bool quickTap = !(_longPressMask & bit) && now - _pressedAt[index] < _longPressMs;
+        if (quickTap && !(_quickTapMask & bit)) {
+            _quickTapMask |= bit;
+        } else {
+            _quickTapMask &= ~bit;
+        }
+        _heldMask &= ~bit;
+        _releasedAt[index] = now;
+    }
+#else
+    (void)now;
+#endif
+}
+
+// Private helper: sends long-press and repeat events for buttons that are being held down.
+void _DoorLockImpl::_checkHeldButtons(unsigned long now)
+{
+#if DOORLOCK_ENABLE_GESTURES
+    if (_heldMask == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t bit = 1 << i;
+        if (!(_heldMask & bit)) {
+            continue;
+        }
+        if (!(_longPressMask & bit)) {
+            if (now - _pressedAt[i] >= _longPressMs) {
+                _longPressMask |= bit;
+                _pushButtonEvent(DL_EVENT_LONG_PRESS, bit, now);
+                _nextRepeatAt[i] = now + _repeatMs;
+            }
+        } else if (_repeatMs > 0 && (long)(now - _nextRepeatAt[i]) >= 0) {
+            _pushButtonEvent(DL_EVENT_REPEAT, bit, now);
+            _nextRepeatAt[i] += _repeatMs;
+        }
+    }
+#else
+    (void)now;
+#endif
+}
+
+// Takes the oldest button event off the queue. Returns false if there are none.
+bool _DoorLockImpl::nextButtonEvent(DoorLockButtonEvent& event)
+{
+#if DOORLOCK_ENABLE_GESTURES
+    return _buttonEvents.pop(event);
+#else
+    (void)event;
+    return false;
+#endif
+}
+
+#if DOORLOCK_ENABLE_GESTURES
+void _DoorLockImpl::setLongPressTime(unsigned long ms)
+{
+    _longPressMs = ms;
+}
+
+void _DoorLockImpl::setRepeatInterval(unsigned long ms)
+{
+    _repeatMs = ms;
+}
+
+void _DoorLockImpl::setDoubleTapTime(unsigned long ms)
+{
+    _doubleTapMs = ms;
+}
+#else
+void _DoorLockImpl::setLongPressTime(unsigned long) {}
+void _DoorLockImpl::setRepeatInterval(unsigned long) {}
+void _DoorLockImpl::setDoubleTapTime(unsigned long) {}
+#endif
+
+// --- Tasks (see DoorLockTask.h) ---
+// Starts a task. It runs right away up to its first wait, then continues from scanButtons().
+// Returns false if that task is already running or every task slot is busy.
+bool _DoorLockImpl::runTask(DoorLockTaskFunction task)
+{
+#if DOORLOCK_ENABLE_TASKS
+    if (task == nullptr || isTaskRunning(task)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < DOORLOCK_MAX_TASKS; i++) {
+        if (_taskFunctions[i] == nullptr) {
+            _tasks[i].resumeLine = 0;
+            _taskFunctions[i] = task;
+            _SiteGuard guard(DL_SITE_TASK, (uintptr_t)task);
+            if (task(&_tasks[i])) {
+                _taskFunctions[i] = nullptr; // Finished without ever waiting
+            }
+            return true;
+        }
+    }
+    DL_LOGLN("Too many tasks running.");
+#else
+    (void)task;
+    DL_LOGLN("Tasks are turned off (DOORLOCK_ENABLE_TASKS).");
+#endif
+    return false;
+}
+
+bool _DoorLockImpl::isTaskRunning(DoorLockTaskFunction task)
+{
+#if DOORLOCK_ENABLE_TASKS
+    for (uint8_t i = 0; i < DOORLOCK_MAX_TASKS; i++) {
+        if (_taskFunctions[i] == task) {
+            return true;
+        }
+    }
+#else
+    (void)task;
+#endif
+    return false;
+}
+
+void _DoorLockImpl::stopTask(DoorLockTaskFunction task)
+{
+#if DOORLOCK_ENABLE_TASKS
+    for (uint8_t i = 0; i < DOORLOCK_MAX_TASKS; i++) {
+        if (_taskFunctions[i] == task) {
+            _taskFunctions[i] = nullptr;
+        }
+    }
+#else
+    (void)task;
+#endif
+}
+
+// Private helper: resumes each running task once. A task that returns true is done.
+void _DoorLockImpl::_runTasks()
+{
+#if DOORLOCK_ENABLE_TASKS
+    for (uint8_t i = 0; i < DOORLOCK_MAX_TASKS; i++) {
+        DoorLockTaskFunction task = _taskFunctions[i];
+        if (task == nullptr) {
+            continue;
+        }
+        _SiteGuard guard(DL_SITE_TASK, (uintptr_t)task);
+        if (task(&_tasks[i])) {
+            _taskFunctions[i] = nullptr;
+        }
+    }
+#endif
+}
+
+// --- Lock State Machine (see LockStateMachine.h) ---
+// Feeds one DoorLockEvent to the transition table: one lookup gives the action and the next
+// state. `locked` changes before the action runs, so the action already sees the new state. An
+// event whose action can't start is dropped whole, `locked` included, so `locked` never says the
+// door moved when it didn't.
+// Returns the DoorLockAction that ran (DL_LOCK_ACTION_NONE if the event changed nothing).
+uint8_t _DoorLockImpl::lockEvent(uint8_t event)
+{
+    if (event >= DL_LOCK_EVENT_COUNT) {
+        return DL_LOCK_ACTION_NONE;
+    }
+    const _LockTransition* t = &DL_LOCK_TABLE[locked ? DL_LOCK_STATE_LOCKED : DL_LOCK_STATE_UNLOCKED][event];
+    uint8_t action = pgm_read_byte(&t->action);
+    bool nextLocked = pgm_read_byte(&t->next) == DL_LOCK_STATE_LOCKED;
+    if (!_lockActionCanStart(action)) {
+        DL_LOGLN("Lock event dropped: no free task slot for its action.");
+        return DL_LOCK_ACTION_NONE;
+    }
+    if (nextLocked != locked) {
+        _setLocked(nextLocked);
+    }
+    _runLockAction(action);
+    return action;
+}
+
+// The lock button: a locked door checks the typed code, an unlocked door just locks.
+uint8_t _DoorLockImpl::lockButtonPressed()
+{
+    bool rightCode = locked && isAttemptCorrect();
+    return lockEvent(rightCode ? DL_LOCK_EVENT_RIGHT_CODE : DL_LOCK_EVENT_LOCK_BUTTON);
+}
+
+// Tasks the sketch wants to run instead of DoorUnlock(), DoorLock() and DoorIncorrect().
+// Any of them may be null to keep the built-in feedback for that action.
+void _DoorLockImpl::setLockActions(DoorLockTaskFunction unlockTask, DoorLockTaskFunction lockTask,
+                                   DoorLockTaskFunction incorrectTask)
+{
+    _lockActions[DL_LOCK_ACTION_UNLOCK] = unlockTask;
+    _lockActions[DL_LOCK_ACTION_LOCK] = lockTask;
+    _lockActions[DL_LOCK_ACTION_INCORRECT] = incorrectTask;
+}
+
+// --- RFID Badges (see RfidReader.h) ---
+// The reader does one short step per call, so this costs one compare while it is waiting.
+void _DoorLockImpl::_pollRfid(unsigned long now)
+{
+#if DOORLOCK_USE_RFID
+    if (!_rfid.due(now)) {
+        return;
+    }
+    _SiteGuard guard(DL_SITE_RFID);
+    if (!_rfid.poll(now)) {
+        return;
+    }
+    int16_t card = _rfidCardNumber(_rfid.uid(), _rfid.uidLength());
+    _auditEvent(DL_AUDIT_BADGE);
+    DL_LOG("Badge ");
+    for (uint8_t i = 0; i < _rfid.uidLength(); i++) {
+        DL_LOG(_rfid.uid()[i] >> 4, HEX);
+        DL_LOG(_rfid.uid()[i] & 0x0F, HEX);
+    }
+    if (card >= 0) {
+        DL_LOG(" is card ");
+        DL_LOGLN(card);
+        if (!_accessAllowed(card + 1)) {
+            DL_LOGLN("Not at this time.");
+            card = -1;
+        }
+    } else {
+        DL_LOGLN(" is not enrolled.");
+    }
+    lockEvent(card >= 0 ? DL_LOCK_EVENT_RIGHT_BADGE : DL_LOCK_EVENT_WRONG_BADGE);
+#else
+    (void)now;
+#endif
+}
+
+// Returns the number of a card in the card table, or -1 if it isn't enrolled (or there is no reader).
+int16_t _DoorLockImpl::findCard(const uint8_t* uid, uint8_t length)
+{
+#if DOORLOCK_USE_RFID
+    return _rfidCardNumber(uid, length);
+#else
+    (void)uid;
+    (void)length;
+    return -1;
+#endif
+}
+
+// Copies the UID of the last badge read into uid (DL_RFID_MAX_UID bytes) and returns its length,
+// 0 if no badge has been read yet.
+uint8_t _DoorLockImpl::lastCard(uint8_t* uid)
+{
+#if DOORLOCK_USE_RFID
+    memcpy(uid, _rfid.uid(), _rfid.uidLength());
+    return _rfid.uidLength();
+#else
+    (void)uid;
+    return 0;
+#endif
+}
+
+// --- Clock, Access Schedules and One-Time Codes (see LockClock.h, AccessSchedule.h, TotpCache.h) ---
+// The clock is only read again when the next 15 minutes begin, and the one-time code cache only
+// has work when 30 seconds are over, so this is normally two compares.
+void _DoorLockImpl::_pollClock(unsigned long now)
+{
+#if DOORLOCK_USE_CLOCK
+    if (_clock.due(now)) {
+        _clock.poll(now);
+    }
+#endif
+#if DOORLOCK_USE_TOTP
+    if (_totp.due(now)) {
+        _totp.poll(now, _clock);
+    }
+#endif
+    (void)now;
+}
+
+bool _DoorLockImpl::_accessAllowed(uint8_t user)
+{
+#if DOORLOCK_USE_SCHEDULES
+    return _schedule.allows(user, _clock.slot());
+#else
+    (void)user;
+    return true;
+#endif
+}
+
+// One-time codes follow the clock at the next scanButtons() instead of at the end of their 30 seconds.
+void _DoorLockImpl::_clockChanged()
+{
+#if DOORLOCK_USE_TOTP
+    _totp.clockChanged(millis());
+#endif
+}
+
+// Sets the time of the week the schedules go by (and forgets the date). day is 0-6 for Monday-Sunday.
+void _DoorLockImpl::setTime(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+{
+#if DOORLOCK_USE_CLOCK
+    if (day > 6 || hour > 23 || minute > 59 || second > 59) {
+        DL_LOGLN("setTime(): day 0-6, hour 0-23, minute and second 0-59.");
+        return;
+    }
+    _clock.setWeekTime(day, hour, minute, second, millis());
+    _clockChanged();
+#else
+    (void)day;
+    (void)hour;
+    (void)minute;
+    (void)second;
+    DL_LOGLN("There is no clock (DOORLOCK_USE_SCHEDULES or DOORLOCK_USE_TOTP).");
+#endif
+}
+
+// Sets the date and the local time, which one-time codes need (and schedules go by too).
+bool _DoorLockImpl::setDateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute,
+                                uint8_t second)
+{
+#if DOORLOCK_USE_CLOCK
+    if (hour > 23 || minute > 59 || second > 59 || !_clock.setDate(year, month, day, hour, minute, second, millis())) {
+        DL_LOGLN("setDateTime(): not a date and time from 2000 to 2099.");
+        return false;
+    }
+    _clockChanged();
+    return true;
+#else
+    (void)year;
+    (void)month;
+    (void)day;
+    (void)hour;
+    (void)minute;
+    (void)second;
+    DL_LOGLN("There is no clock (DOORLOCK_USE_SCHEDULES or DOORLOCK_USE_TOTP).");
+    return false;
+#endif
+}
+
+// Lets a user in (or keeps them out) from one time of day to another on the days in `days`.
+// Times are rounded out to whole 15 minute slots; toHour 24 means midnight at the end of the day.
+bool _DoorLockImpl::setAccessWindow(uint8_t user, uint8_t days, uint8_t fromHour, uint8_t fromMinute,
+                                    uint8_t toHour, uint8_t toMinute, bool allowed)
+{
+#if DOORLOCK_USE_SCHEDULES
+    uint16_t from = fromHour * 60 + fromMinute;
+    uint16_t to = toHour * 60 + toMinute;
+    if (fromMinute > 59 || toMinute > 59 || to > 24 * 60 || from >= to ||
+        !_schedule.setWindow(user, days, from / 15, (to + 14) / 15 - from / 15, allowed)) {
+        DL_LOGLN("setAccessWindow(): bad user, days or times.");
+        return false;
+    }
+    return true;
+#else
+    (void)user;
+    (void)days;
+    (void)fromHour;
+    (void)fromMinute;
+    (void)toHour;
+    (void)toMinute;
+    (void)allowed;
+    DL_LOGLN("Access schedules are turned off (DOORLOCK_USE_SCHEDULES).");
+    return false;
+#endif
+}
+
+void _DoorLockImpl::clearAccessSchedule(uint8_t user)
+{
+#if DOORLOCK_USE_SCHEDULES
+    _schedule.clear(user);
+#else
+    (void)user;
+#endif
+}
+
+// Sets one of the secrets one-time codes are worked out from. The codes are ready a few
+// scanButtons() calls later.
+bool _DoorLockImpl::setOneTimeSecret(uint8_t slot, const uint8_t* key, uint8_t length)
+{
+#if DOORLOCK_USE_TOTP
+    if (!_totp.setSecret(slot, key, length)) {
+        DL_LOGLN("setOneTimeSecret(): bad slot, or the secret is longer than 64 bytes.");
+        return false;
+    }
+    return true;
+#else
+    (void)slot;
+    (void)key;
+    (void)length;
+    DL_LOGLN("One-time codes are turned off (DOORLOCK_USE_TOTP).");
+    return false;
+#endif
+}
+
+void _DoorLockImpl::clearOneTimeSecret(uint8_t slot)
+{
+#if DOORLOCK_USE_TOTP
+    _totp.clearSecret(slot);
+#else
+    (void)slot;
+#endif
+}
+
+// --- Status Display (see StatusDisplay.h) ---
+// The lock state goes on the top row, the digits typed so far in the middle and messages on the
+// bottom row. Rows are only written again when what they show changes, and then only the
+// characters that differ are sent.
+#if DOORLOCK_USE_DISPLAY
+const uint8_t DISPLAY_STATE_ROW = 0;
+const uint8_t DISPLAY_ENTRY_ROW = DL_DISPLAY_ROWS / 2;
+const uint8_t DISPLAY_MESSAGE_ROW = DL_DISPLAY_ROWS - 1;
+const unsigned long DISPLAY_MESSAGE_MS = 3000; // How long a message stays up
+#endif
+
+void _DoorLockImpl::_updateDisplay(unsigned long now)
+{
+#if DOORLOCK_USE_DISPLAY
+    if (_shownLocked != (uint8_t)locked) {
+        _shownLocked = locked;
+        _display.print(DISPLAY_STATE_ROW, 0, locked ? F("LOCKED") : F("UNLOCKED"), DL_DISPLAY_COLUMNS);
+    }
+    int codeLength = _codeLength();
+    if (_shownDigits != _inputIndex || _shownCodeLength != codeLength) {
+        _shownDigits = _inputIndex;
+        _shownCodeLength = codeLength;
+        // "CODE * * _" with a star per digit typed (never the digit) and a line per digit to go
+        char entry[DL_DISPLAY_COLUMNS + 1];
+        uint8_t n = 0;
+        for (const char* label = "CODE"; *label; label++) {
+            entry[n++] = *label;
+        }
+        int slots = _inputIndex > codeLength ? _inputIndex : codeLength;
+        for (int i = 0; i < slots && n + 2 <= DL_DISPLAY_COLUMNS; i++) {
+            entry[n++] = ' ';
+            entry[n++] = i < _inputIndex ? '*' : '_';
+        }
+        entry[n] = 0;
+        _display.print(DISPLAY_ENTRY_ROW, 0, entry, DL_DISPLAY_COLUMNS);
+    }
+    if (_messageShown && now - _messageMs >= DISPLAY_MESSAGE_MS) {
+        _messageShown = false;
+        _display.print(DISPLAY_MESSAGE_ROW, 0, (const char*)nullptr, DL_DISPLAY_COLUMNS);
+    }
+    _display.update();
+#else
+    (void)now;
+#endif
+}
+
+// A message for the things that happen to the lock. Locking and unlocking show on the top row.
+void _DoorLockImpl::_showEventMessage(uint8_t event)
+{
+#if DOORLOCK_USE_DISPLAY
+    const __FlashStringHelper* text = nullptr;
+    switch (event) {
+    case DL_AUDIT_BOOT: text = F("READY"); break;
+    case DL_AUDIT_INCORRECT: text = F("ACCESS DENIED"); break;
+    case DL_AUDIT_CODE_CHANGED: text = F("CODE CHANGED"); break;
+    case DL_AUDIT_REMOTE_UNLOCK: text = F("REMOTE UNLOCK"); break;
+    case DL_AUDIT_REMOTE_LOCK: text = F("REMOTE LOCK"); break;
+    case DL_AUDIT_BADGE: text = F("BADGE READ"); break;
+    case DL_AUDIT_ONE_TIME_CODE: text = F("ONE-TIME CODE"); break;
+    case DL_AUDIT_JAM: text = F("JAMMED"); break;
+    default: return;
+    }
+    _display.print(DISPLAY_MESSAGE_ROW, 0, text, DL_DISPLAY_COLUMNS);
+    _messageShown = true;
+    _messageMs = millis();
+#else
+    (void)event;
+#endif
+}
+
+// Shows the sketch's own text on the bottom row for a few seconds.
+void _DoorLockImpl::displayMessage(const char* text)
+{
+#if DOORLOCK_USE_DISPLAY
+    _display.print(DISPLAY_MESSAGE_ROW, 0, text, DL_DISPLAY_COLUMNS);
+    _messageShown = true;
+    _messageMs = millis();
+#else
+    (void)text;
+#endif
+}
+
+// Private helper: runs the sketch's task for an action, or the built-in feedback when there is
+// none (or tasks are turned off).
+void _DoorLockImpl::_runLockAction(uint8_t action)
+{
+    static void (_DoorLockImpl::* const builtIn[DL_LOCK_ACTION_COUNT])() = {
+        nullptr, &_DoorLockImpl::DoorUnlock, &_DoorLockImpl::DoorLock, &_DoorLockImpl::DoorIncorrect,
+    };
+    if (action == DL_LOCK_ACTION_NONE || action >= DL_LOCK_ACTION_COUNT) {
+        return;
+    }
+#if DOORLOCK_ENABLE_TASKS
+    if (_lockActions[action] != nullptr) {
+        // A run of the same task that is still going is started over, so the newest event decides
+        // where the door ends up: an older lock task may still be waiting out its LED after a
+        // newer unlock has opened the door again.
+        stopTask(_lockActions[action]);
+        runTask(_lockActions[action]);
+        return;
+    }
+#endif
+    (this->*builtIn[action])();
+}
+
+// Private helper: the sketch's task for an action can always be (re)started unless it isn't
+// running and every task slot is taken.
+bool _DoorLockImpl::_lockActionCanStart(uint8_t action)
+{
+#if DOORLOCK_ENABLE_TASKS
+    DoorLockTaskFunction task = action < DL_LOCK_ACTION_COUNT ? _lockActions[action] : nullptr;
+    if (task == nullptr || isTaskRunning(task)) {
+        return true;
+    }
+    for (uint8_t i = 0; i < DOORLOCK_MAX_TASKS; i++) {
+        if (_taskFunctions[i] == nullptr) {
+            return true;
+        }
+    }
+    return false;
+#else
+    (void)action;
+    return true;
+#endif
+}
+
+// --- Actuator Queue ---
+// Private helper: a sequence of `length` commands is about to be posted. It goes in as a whole
+// or not at all: half a sequence could switch an LED on and never off again. Returns false
+// (nothing may be posted) if the queue hasn't got room for all of it.
+bool _DoorLockImpl::_startActuatorSequence(uint8_t length)
+{
+    if (_actuators.space() < length) {
+        DL_LOGLN("Actuator queue full, feedback dropped.");
+        return false;
+    }
+    _actuatorSequenceStart = true;
+    return true;
+}
+
+// Private helper: producer end. Marks the first command after _actuatorSequenceStart.
+void _DoorLockImpl::_postActuator(uint8_t op, uint16_t value)
+{
+    if (_actuatorSequenceStart) {
+        op |= DL_ACT_FIRST;
+    }
+    if (!_actuators.push(op, value)) {
+        return; // Can't happen after _startActuatorSequence() said there is room
+    }
+    if (_actuatorSequenceStart) {
+        _actuatorSequencesPosted++;
+        _actuatorSequenceStart = false;
+    }
+}
+
+// Private helper: consumer end. Carries out queued commands until one asks to wait. Once a newer
+// sequence has been posted, the waits of the older ones are skipped: their LEDs still end up
+// off, but the new servo move doesn't queue up behind seconds of old feedback.
+void _DoorLockImpl::_runActuators()
+{
+    if (_actuatorWaiting) {
+        if (millis() - _actuatorWaitStart < _actuatorWaitMs && _actuatorSequencesRun == _actuatorSequencesPosted) {
+            return;
+        }
+        _actuatorWaiting = false;
+    }
+
+    _ActuatorCommand cmd;
+    while (_actuators.pop(cmd)) {
+        if (cmd.op & DL_ACT_FIRST) {
+            _actuatorSequencesRun++;
+#if DOORLOCK_ENABLE_LATENCY_STATS
+            _actuationLatency.record((uint16_t)((uint16_t)micros() - cmd.postedAt));
+#endif
+        }
+        switch (cmd.op & ~DL_ACT_FIRST) {
+        case DL_ACT_SERVO:
+            _servoWrite(cmd.value);
+            break;
+        case DL_ACT_RED_LED:
+            redLEDToggle(cmd.value != 0);
+            break;
+        case DL_ACT_GREEN_LED:
+            greenLEDToggle(cmd.value != 0);
+            break;
+        case DL_ACT_BUZZER:
+            if (cmd.value != 0) {
+                buzzerOn(cmd.value);
+            } else {
+                buzzerOff();
+            }
+            break;
+        case DL_ACT_WAIT:
+            if (_actuatorSequencesRun != _actuatorSequencesPosted) {
+                break; // A newer sequence is queued behind this one
+            }
+            _actuatorWaiting = true;
+            _actuatorWaitStart = millis();
+            _actuatorWaitMs = cmd.value;
+            return; // Pick up the rest after the wait
+        }
+    }
+}
+
+// True while queued servo/LED/buzzer commands are still being carried out.
+bool _DoorLockImpl::isActuatorBusy()
+{
+    return _actuatorWaiting || !_actuators.isEmpty();
+}
+
+unsigned long _DoorLockImpl::actuationLatency(uint8_t percent)
+{
+#if DOORLOCK_ENABLE_LATENCY_STATS
+    return _actuationLatency.percentile(percent);
+#else
+    (void)percent;
+    return 0;
+#endif
+}
+
+void _DoorLockImpl::resetActuationLatency()
+{
+#if DOORLOCK_ENABLE_LATENCY_STATS
+    _actuationLatency.reset();
+#endif
+}
+
+// --- Serial Command Channel ---
+// A few bytes are taken from the UART receive buffer on every update, so a long command can
+// never hold up the buttons. Each byte goes straight into the frame parser.
+#if DOORLOCK_ENABLE_SERIAL_COMMANDS
+const uint8_t SERIAL_BYTES_PER_UPDATE = 16;
+const uint8_t REPLY_MAX_ENCODED = DL_FRAME_MAX_PAYLOAD + 2 + 3; // Payload + CRC + COBS overhead + delimiters
+
+void _DoorLockImpl::enableSerialCommands(bool enabled)
+{
+    if (enabled) {
+        _serialStart();
+    }
+    _serialCommands = enabled;
+}
+
+void _DoorLockImpl::_pollSerialCommands()
+{
+    if (!_serialCommands) {
+        return;
+    }
+    for (uint8_t i = 0; i < SERIAL_BYTES_PER_UPDATE; i++) {
+        // Only take a byte if a whole reply would fit in the transmit buffer right now, so
+        // sending the reply never waits on the UART.
+        if (Serial.available() <= 0 || Serial.availableForWrite() < REPLY_MAX_ENCODED) {
+            return;
+        }
+        int length = _frameParser.feed(Serial.read());
+        if (length >= 2) {
+            _handleCommand(_frameParser.payload(), length);
+        }
+    }
+}
+
+void _DoorLockImpl::_handleCommand(const uint8_t* frame, uint8_t length)
+{
+    _SiteGuard guard(DL_SITE_SERIAL_COMMAND);
+    uint8_t command = frame[0];
+    const uint8_t* args = frame + 2;
+    uint8_t argLength = length - 2;
+
+    uint8_t reply[DL_FRAME_MAX_PAYLOAD];
+    uint8_t n = 0;
+    reply[n++] = command | DL_REPLY_FLAG;
+    reply[n++] = frame[1]; // Sequence number, so the sender can match replies to commands
+    reply[n++] = DL_STATUS_OK;
+
+    switch (command) {
+    case DL_CMD_STATUS:
+        reply[n++] = locked ? 1 : 0;
+        reply[n++] = _inputIndex;
+        reply[n++] = _codeLength();
+        reply[n++] = isActuatorBusy() ? 1 : 0;
+        n += _putU32(reply + n, millis());
+        break;
+
+    case DL_CMD_ENROLL: {
+        uint8_t codeLength = argLength > 0 ? args[0] : 0;
+        bool valid = codeLength >= 1 && codeLength <= DOORLOCK_MAX_CODE_LENGTH && argLength == codeLength + 1;
+        int code[DOORLOCK_MAX_CODE_LENGTH];
+        for (uint8_t i = 0; valid && i < codeLength; i++) {
+            code[i] = args[1 + i];
+            valid = code[i] >= 1 && code[i] <= 3; // The keypad only has buttons 1, 2 and 3
+        }
+        if (!valid) {
+            reply[2] = DL_STATUS_BAD_ARGUMENTS;
+            break;
+        }
+        stageCorrectCode(code, codeLength);
+        commitCorrectCode();
+        break;
+    }
+
+    case DL_CMD_LOCK:
+        _auditEvent(DL_AUDIT_REMOTE_LOCK);
+        lockEvent(DL_LOCK_EVENT_LOCK);
+        break;
+
+    case DL_CMD_UNLOCK:
+        _auditEvent(DL_AUDIT_REMOTE_UNLOCK);
+        lockEvent(DL_LOCK_EVENT_UNLOCK);
+        break;
+
+    case DL_CMD_STATS:
+        n += _putU32(reply + n, actuationLatency(50));
+        n += _putU32(reply + n, actuationLatency(99));
+        reply[n++] = _audit.size();
+        break;
+
+    case DL_CMD_AUDIT: {
+        const uint8_t ENTRIES_PER_REPLY = 8;
+        uint8_t first = argLength > 0 ? args[0] : 0;
+        reply[n++] = _audit.size();
+        reply[n++] = first;
+        for (uint8_t i = first; i < _audit.size() && i < first + ENTRIES_PER_REPLY; i++) {
+            const _AuditEntry& entry = _audit.get(i);
+            reply[n++] = entry.event;
+            n += _putU32(reply + n, entry.ms);
+        }
+        break;
+    }
+
+    case DL_CMD_MEMORY: {
+        DoorLockMemoryStats stats = memoryStats();
+        n += _putU32(reply + n, stats.dataBytes);
+        n += _putU32(reply + n, stats.bssBytes);
+        n += _putU32(reply + n, stats.heapUsed);
+        n += _putU32(reply + n, stats.heapPeak);
+        n += _putU32(reply + n, stats.allocations);
+        n += _putU32(reply + n, stats.freeBytes);
+        n += _putU32(reply + n, stats.largestFreeBlock);
+        n += _putU32(reply + n, stats.stackFreeMin);
+        break;
+    }
+
+    case DL_CMD_TELEMETRY:
+        n += telemetrySnapshot(reply + n);
+        if (argLength > 0 && args[0] == 1) {
+            resetTelemetry(); // Gateways can read and clear in one go
+        }
+        break;
+
+#if DOORLOCK_USE_SCHEDULES
+    case DL_CMD_SCHEDULE: {
+        bool valid = argLength == 5 && args[4] <= 2;
+        if (valid && args[4] == 2) {
+            valid = args[0] < DOORLOCK_SCHEDULE_USERS;
+            if (valid) {
+                _schedule.clear(args[0]);
+            }
+        } else if (valid) {
+            valid = _schedule.setWindow(args[0], args[1], args[2], args[3], args[4] == 1);
+        }
+        if (!valid) {
+            reply[2] = DL_STATUS_BAD_ARGUMENTS;
+        }
+        break;
+    }
+
+#endif
+
+#if DOORLOCK_USE_CLOCK
+    case DL_CMD_TIME:
+        if (argLength == 4) {
+            if (args[0] > 6 || args[1] > 23 || args[2] > 59 || args[3] > 59) {
+                reply[2] = DL_STATUS_BAD_ARGUMENTS;
+                break;
+            }
+            _clock.setWeekTime(args[0], args[1], args[2], args[3], millis());
+        } else if (argLength == 6) {
+            if (args[3] > 23 || args[4] > 59 || args[5] > 59 ||
+                !_clock.setDate(2000 + args[0], args[1], args[2], args[3], args[4], args[5], millis())) {
+                reply[2] = DL_STATUS_BAD_ARGUMENTS;
+                break;
+            }
+        } else if (argLength != 0) {
+            reply[2] = DL_STATUS_BAD_ARGUMENTS;
+            break;
+        }
+        _clockChanged();
+        reply[n++] = _clock.slot() & 0xFF;
+        reply[n++] = _clock.slot() >> 8;
+        break;
+#endif
+
+    default:
+        reply[2] = DL_STATUS_UNKNOWN_COMMAND;
+        break;
+    }
+
+    _writeFrame(Serial, reply, n);
+}
+#else
+void _DoorLockImpl::enableSerialCommands(bool enabled)
+{
+    if (enabled) {
+        DL_LOGLN("Serial commands are turned off (DOORLOCK_ENABLE_SERIAL_COMMANDS).");
+    }
+}
+
+void _DoorLockImpl::_pollSerialCommands() {}
+#endif
+
+// --- Edge Events and Idle Sleep ---
+// With DOORLOCK_USE_EDGE_EVENTS a pin-change interrupt flags every button edge, so the CPU
+// doesn't have to keep polling. idleUntilEvent() sleeps until the next interrupt: a button edge,
+// the 1 ms millis() tick (which keeps tasks and debouncing on time), Serial data, and so on.
+// With DOORLOCK_USE_LINUX_GPIO the kernel reports the edges instead, and idleUntilEvent() sleeps in
+// epoll_wait(): 1 ms at a time while something runs on the clock, otherwise until the next timer
+// is due, for at most DOORLOCK_LINUX_IDLE_MS (Serial and the other polled parts are looked at
+// that often).
+// Without either it returns straight away.
+void _DoorLockImpl::idleUntilEvent()
+{
+#if DOORLOCK_USE_LINUX_GPIO
+    if (_buttonEdgePending) {
+        return; // Something already happened, go handle it
+    }
+    bool busy = _buttonsSettling || _heldMask != 0 || isActuatorBusy();
+#if DOORLOCK_ENABLE_TASKS
+    for (uint8_t i = 0; i < DOORLOCK_MAX_TASKS; i++) {
+        busy = busy || _taskFunctions[i] != nullptr;
+    }
+#endif
+#if DOORLOCK_USE_SERVO_SENSE
+    busy = busy || _servoSense.watching();
+#endif
+    unsigned long timeoutMs = busy ? 1 : DOORLOCK_LINUX_IDLE_MS;
+#if DOORLOCK_ENABLE_TIMEOUTS
+    unsigned long now = millis();
+    for (uint8_t id = 0; id < DL_TIMER_COUNT; id++) {
+        if (_timers.isArmed(id) && _timers.remaining(id, now) < timeoutMs) {
+            timeoutMs = _timers.remaining(id, now);
+        }
+    }
+#endif
+    if (_theLinuxGpio.wait(timeoutMs)) {
+        _buttonEdgePending = true;
+    }
+#elif DOORLOCK_USE_EDGE_EVENTS
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    if (_buttonEdgePending) {
+        sei(); // Something already happened, go handle it
+        return;
+    }
+    sleep_enable();
+    sei();        // The instruction after sei() always runs, so no interrupt can sneak in before we sleep
+    sleep_cpu();
+    sleep_disable();
+#endif
+}
+
+#if DOORLOCK_USE_EDGE_EVENTS
+ISR(PCINT0_vect)
+{
+    _buttonEdgePending = true;
+}
+#if defined(PCINT1_vect)
+ISR(PCINT1_vect)
+{
+    _buttonEdgePending = true;
+}
+#endif
+#if defined(PCINT2_vect)
+ISR(PCINT2_vect)
+{
+    _buttonEdgePending = true;
+}
+#endif
+#endif
+
+// --- Timer-Interrupt Button Sampling ---
+// Instead of relying on how often the sketch calls scanButtons(), the buttons can be sampled
+// from a timer interrupt at a fixed rate (about 1 kHz). A button only changes state after it
+// has read the same for its settle window worth of samples in a row, so the debounce time is
+// always the same no matter how long the sketch spends in delay().
+//
+// With the timer multiplexer enabled the samples are taken on its 1 ms tick.
+// Otherwise we borrow Timer0's compare match A interrupt. Timer0 already runs for millis(), so no
+// timer is taken away from Servo or tone(). Note: this uses OCR0A, so analogWrite() on
+// pin 6 of an Uno/Nano will not work while sampling is on.
+#if DOORLOCK_USE_TIMER_MUX
+static void _sampleButtonsTick()
+{
+    _theDoorLockInstance.sampleButtonsFromISR();
+}
+#endif
+
+void _DoorLockImpl::setTimerSampling(bool enabled)
+{
+#if DOORLOCK_USE_TIMER_MUX || (defined(__AVR__) && defined(TIMER0_COMPA_vect))
+    if (enabled == _timerSampling) {
+        return;
+    }
+    if (enabled) {
+        // Start the interrupt from the current debounced state so no press is invented.
+        for (uint8_t i = 0; i < 4; i++) {
+            _sampleCount[i] = 0;
+        }
+        _timerSampling = true;
+#if DOORLOCK_USE_TIMER_MUX
+        _theTimerMux.setTickHandler(_sampleButtonsTick);
+#else
+        OCR0A = 0x80;             // Fire halfway between millis() overflow interrupts
+        TIMSK0 |= _BV(OCIE0A);
+#endif
+    } else {
+#if DOORLOCK_USE_TIMER_MUX
+        _theTimerMux.setTickHandler(nullptr);
+#else
+        TIMSK0 &= ~_BV(OCIE0A);
+#endif
+        _timerSampling = false;
+        // Hand the stable state back to the polled debouncer.
+        for (uint8_t i = 0; i < 4; i++) {
+            _lastReading[i] = _stableState[i];
+        }
+    }
+#else
+    if (enabled) {
+        DL_LOGLN("Timer sampling is not supported on this board, using scanButtons().");
+    }
+#endif
+}
+
+void _DoorLockImpl::sampleButtonsFromISR()
+{
+#if defined(__AVR__)
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < 4; i++) {
+        int currentReading = _buttonPins[i].read();
+        if (currentReading != _lastReading[i]) {
+            _lastReading[i] = currentReading;
+            _debounce[i].contactChanged(now);
+        } else {
+            _debounce[i].update(now);
+        }
+
+        if (currentReading == _stableState[i]) {
+            if (_sampleCount[i] > 0) {
+                DL_COUNT(bounces[i]);
+            }
+            _sampleCount[i] = 0; // Bounce (or no change): start counting again
+        } else if (++_sampleCount[i] >= _settleSamples(_debounce[i].windowMs()) && _debounce[i].settled(now)) {
+            _sampleCount[i] = 0;
+            _stableState[i] = currentReading;
+            _debounce[i].accepted(now);
+            _buttonChanged(i, currentReading == LOW, now); // Pressed when LOW (INPUT_PULLUP)
+        }
+    }
+    _checkHeldButtons(now);
+#endif
+}
+
+#if !DOORLOCK_USE_TIMER_MUX && defined(__AVR__) && defined(TIMER0_COMPA_vect)
+ISR(TIMER0_COMPA_vect)
+{
+    _theDoorLockInstance.sampleButtonsFromISR();
+}
+#endif
+
+
+// --- Implementation of Global Functions in DoorLock Namespace ---
+// These functions are what campers will call directly from their sketch.
+// Each function simply forwards the call to the single '_theDoorLockInstance'.
+
+namespace DoorLock {
+    bool& locked = _theDoorLockInstance.locked;
+    
+/**
+ * @brief Initializes and starts the door lock system with default settings.
+ * @note This method uses both the default secret code and the default hardware pin assignments.
+ * It is the simplest way to get the system running.
+ */
+void start() {
+    _theDoorLockInstance.start();
+}
+
+/**
+ * @brief Initializes the system with a custom secret code and default pins.
+ * @param[in] correctCode A pointer to an integer array representing the secret code sequence.
+ * @param[in] codeLength The number of elements in the correctCode array.
+ * @note This method uses the default hardware pin assignments for all components.
+ */
+void start(int* correctCode, int codeLength) {
+    // Creates a temporary pins array with default values
+    _theDoorLockInstance.setPins(
+        DOORLOCK_BUTTON1_PIN, DOORLOCK_BUTTON2_PIN, DOORLOCK_BUTTON3_PIN,
+        DOORLOCK_LOCK_BUTTON_PIN, DOORLOCK_GREEN_LED_PIN, DOORLOCK_RED_LED_PIN,
+        DOORLOCK_SERVO_PIN, DOORLOCK_BUZZER_PIN
+    );
+    _theDoorLockInstance.setCorrectCode(correctCode, codeLength);
+    _theDoorLockInstance.start();
+}
+
+/**
+ * @brief Initializes the system with custom pin assignments and the default secret code.
+ * @param[in] button1 The GPIO pin for the first input button.
+ * @param[in] button2 The GPIO pin for the second input button.
+ * @param[in] button3 The GPIO pin for the third input button.
+ * @param[in] lockButton The GPIO pin for the button that finalizes code entry.
+ * @param[in] greenLED The GPIO pin for the green status LED (success).
+ * @param[in] redLED The GPIO pin for the red status LED (failure).
+ * @param[in] servoPin The GPIO pin controlling the door lock servo motor.
+ * @param[in] buzzerPin The GPIO pin for the audible buzzer.
+ * @note This will use the predefined default secret code.
+ */
+void start(int button1, int button2, int button3, int lockButton,
+           int greenLED, int redLED, int servoPin, int buzzerPin) {
+    // Creates a temporary correctCode array with default values
+    int code[] = {DOORLOCK_DEFAULT_CODE[0], DOORLOCK_DEFAULT_CODE[1], DOORLOCK_DEFAULT_CODE[2]};
+    int codeLength = DOORLOCK_DEFAULT_CODE_LENGTH;
+
+    _theDoorLockInstance.setCorrectCode(code, codeLength); // Set default code
+    _theDoorLockInstance._DoorLockImpl::setPins(button1, button2, button3, lockButton, greenLED, redLED, servoPin, buzzerPin);   // Set custom pins
+    _theDoorLockInstance.start();
+}
+
+/**
+ * @brief Initializes the system with a custom secret code and custom pin assignments.
+ * @param[in] correctCode A pointer to an integer array representing the secret code sequence.
+ * @param[in] codeLength The number of elements in the correctCode array.
+ * @param[in] button1 The GPIO pin for the first input button.
+ * @param[in] button2 The GPIO pin for the second input button.
+ * @param[in] button3 The GPIO pin for the third input button.
+ * @param[in] lockButton The GPIO pin for the button that finalizes code entry.
+ * @param[in] greenLED The GPIO pin for the green status LED (success).
+ * @param[in] redLED The GPIO pin for the red status LED (failure).
+ * @param[in] servoPin The GPIO pin controlling the door lock servo motor.
+ * @param[in] buzzerPin The GPIO pin for the audible buzzer.
+ */
+void start(int* correctCode, int codeLength, int button1, int button2, int button3,
+           int lockButton, int greenLED, int redLED, int servoPin, int buzzerPin) {
+    _theDoorLockInstance.setCorrectCode(correctCode, codeLength);
+    _theDoorLockInstance._DoorLockImpl::setPins(button1, button2, button3, lockButton, greenLED, redLED, servoPin, buzzerPin);
+    _theDoorLockInstance.start();
+}
+
+    /* This is a premade unlock the door function.
+    You may use this one if you would like, but try to make your own!
+    */
+    void DoorUnlock() {
+        _theDoorLockInstance.DoorUnlock();
+    }
+
+    /* This is a premade lock the door function.
+    You may use this one if you would like, but try to make your own!
+    */
+    void DoorLock() {
+        _theDoorLockInstance.DoorLock(); // Calls the internally renamed function
+    }
+
+    void DoorIncorrect() {
+        _theDoorLockInstance.DoorIncorrect();
+    }
+
+    /* This method opens the door by turning the servo to 180 degrees. The door counts as unlocked. */
+    void open() {
+        _theDoorLockInstance.open();
+    }
+    /* This method closes the door by turning the servo to 0 degrees. The door counts as locked. */
+    void close() {
+        _theDoorLockInstance.close();
+    }
+
+    /* This method resets the attempt array/list that holds the previous entered code. */
+    void resetAttempt() {
+        _theDoorLockInstance.resetAttempt();
+    }
+    /* This method checks if the current attempt matches the correct code.
+    It returns true if the attempt is correct, false otherwise. */
+    bool isAttemptCorrect() {
+        return _theDoorLockInstance.isAttemptCorrect();
+    }
+
+    /** This method sets the correct code for the door lock.
+    @param[in] code A pointer to an integer array representing the secret code sequence.
+    @param[in] codeLength The number of elements in the code array (1 to DOORLOCK_MAX_CODE_LENGTH).
+    @return True if the code was changed, false if codeLength is out of range (the old code stays).
+    */
+    bool setCorrectCode(int* code, int codeLength) {
+        return _theDoorLockInstance.setCorrectCode(code, codeLength);
+    }
+
+    /**
+     * @brief Gets a new secret code ready without changing the current one yet.
+     * @param[in] code A pointer to an integer array representing the new secret code sequence.
+     * @param[in] codeLength The number of elements in the code array (1 to DOORLOCK_MAX_CODE_LENGTH).
+     * @return True if the code was staged, false if codeLength is out of range (nothing changes).
+     * @note The old code keeps working until commitCorrectCode() is called.
+     */
+    bool stageCorrectCode(int* code, int codeLength) {
+        return _theDoorLockInstance.stageCorrectCode(code, codeLength);
+    }
+
+    /**
+     * @brief Switches to the code given to stageCorrectCode(), all at once.
+     * @return True if a staged code was switched in, false if nothing was staged.
+     * @note A code that is halfway typed in is kept if it still fits in the new code.
+     */
+    bool commitCorrectCode() {
+        return _theDoorLockInstance.commitCorrectCode();
+    }
+
+    /** 
+     * @brief Sets the pin assignments for the door lock system.
+     * @param[in] button1 The pin for the first input button.
+     * @param[in] button2 The pin for the second input button.
+     * @param[in] button3 The pin for the third input button.
+     * @param[in] lockButton The pin for the button that finalizes code entry.
+     * @param[in] greenLED The pin for the green status LED (success).
+     * @param[in] redLED The pin for the red status LED (failure).
+     * @param[in] servoPin The pin controlling the door lock servo motor.
+     * @param[in] buzzerPin The pin for the buzzer.
+     */
+    void setPins(int button1, int button2, int button3, int lockButton, int greenLED, int redLED, int servoPin, int buzzerPin) {
+        _theDoorLockInstance.setPins(button1, button2, button3, lockButton, greenLED, redLED, servoPin, buzzerPin);
+    }
+
+    // This method tells the door lock system the button 1 was pressed.
+    void button1Pressed() {
+        _theDoorLockInstance.button1Pressed();
+    }
+    // This method tells the door lock system the button 2 was pressed.
+    void button2Pressed() {
+        _theDoorLockInstance.button2Pressed();
+    }
+    // This method tells the door lock system the button 3 was pressed.
+    void button3Pressed() {
+        _theDoorLockInstance.button3Pressed();
+    }
+
+    // This method returns true if button 1 is being pressed
+    bool isButton1Pressed() {
+        return _theDoorLockInstance.isButton1Pressed();
+    }
+    // This method returns true if button 2 is being pressed
+    bool isButton2Pressed() {
+        return _theDoorLockInstance.isButton2Pressed();
+    }
+    // This method returns true if button 3 is being pressed
+    bool isButton3Pressed() {
+        return _theDoorLockInstance.isButton3Pressed();
+    }
+    // This method returns true if the lock button is being pressed
+    bool isLockButtonPressed() {
+        return _theDoorLockInstance.isLockButtonPressed();
+    }
+
+    /**
+     * @brief Toggles the state of the red LED.
+     * @param[in] state True to turn on the red LED, false to turn it off.
+     */
+    void redLEDToggle(bool state) {
+        _theDoorLockInstance.redLEDToggle(state);
+    }
+    /**
+     * @brief Toggles the state of the green LED.
+     * @param[in] state True to turn on the green LED, false to turn it off.
+     */
+    void greenLEDToggle(bool state) {
+        _theDoorLockInstance.greenLEDToggle(state);
+    }
+    /**
+     * @brief Sets how bright the red LED is.
+     * @param[in] level 0 is off, 255 is fully on, anything in between dims the LED.
+     * @note Dimming needs DOORLOCK_USE_TIMER_MUX in DoorLockConfig.h. Without it any level above 0 is fully on.
+     */
+    void redLEDBrightness(uint8_t level) {
+        _theDoorLockInstance.redLEDBrightness(level);
+    }
+    /**
+     * @brief Sets how bright the green LED is.
+     * @param[in] level 0 is off, 255 is fully on, anything in between dims the LED.
+     * @note Dimming needs DOORLOCK_USE_TIMER_MUX in DoorLockConfig.h. Without it any level above 0 is fully on.
+     */
+    void greenLEDBrightness(uint8_t level) {
+        _theDoorLockInstance.greenLEDBrightness(level);
+    }
+
+    /**
+     * @brief Turns on the buzzer at a specified frequency.
+     * @param[in] hz The frequency in Hertz to set the buzzer.
+     */
+    void buzzerOn(int hz) {
+        _theDoorLockInstance.buzzerOn(hz);
+    }
+    /**
+     * @brief Turns off the buzzer.
+     */
+    void buzzerOff() {
+        _theDoorLockInstance.buzzerOff();
+    }
+
+    // Getter methods (forwarding to internal getters)
+    int getButton1() { return _theDoorLockInstance.getButton1(); }
+    int getButton2() { return _theDoorLockInstance.getButton2(); }
+    int getButton3() { return _theDoorLockInstance.getButton3(); }
+    int getLockButton() { return _theDoorLockInstance.getLockButton(); }
+    int getGreenLED() { return _theDoorLockInstance.getGreenLED(); }
+    int getRedLED() { return _theDoorLockInstance.getRedLED(); }
+    int getServoPin() { return _theDoorLockInstance.getServoPin(); }
+    int getBuzzerPin() { return _theDoorLockInstance.getBuzzerPin(); }
+
+    /**
+     * @brief This method scans the buttons and updates the system.
+     */
+    void scanButtons() {
+        _theDoorLockInstance.scanButtons();
+    }
+
+    /**
+     * @brief Turns timer-interrupt button sampling on or off.
+     * @param[in] enabled True to let a timer interrupt debounce the buttons about 1000 times a second,
+     * false to go back to debouncing inside scanButtons().
+     * @note While it is on, button presses are caught even during delay(), and scanButtons() has nothing left to do.
+     */
+    void useTimerSampling(bool enabled) {
+        _theDoorLockInstance.setTimerSampling(enabled);
+    }
+
+    /**
+     * @brief Starts a task made with DL_TASK (see DoorLockTask.h).
+     * @param[in] task The name of the task function.
+     * @return True if the task started, false if it is already running or too many tasks are running.
+     * @note The task keeps going every time scanButtons() is called, until it reaches DL_TASK_END().
+     */
+    bool runTask(DoorLockTaskFunction task) {
+        return _theDoorLockInstance.runTask(task);
+    }
+    /**
+     * @brief Checks whether a task is still running.
+     * @param[in] task The name of the task function.
+     */
+    bool isTaskRunning(DoorLockTaskFunction task) {
+        return _theDoorLockInstance.isTaskRunning(task);
+    }
+    /**
+     * @brief Stops a task wherever it is. It will start from the top the next time runTask() is called.
+     * @param[in] task The name of the task function.
+     */
+    void stopTask(DoorLockTaskFunction task) {
+        _theDoorLockInstance.stopTask(task);
+    }
+
+    /**
+     * @brief Tells the lock state machine that something happened (see LockStateMachine.h).
+     * @param[in] event DL_LOCK_EVENT_RIGHT_CODE, DL_LOCK_EVENT_LOCK_BUTTON, DL_LOCK_EVENT_LOCK or DL_LOCK_EVENT_UNLOCK.
+     * @return The action that ran: DL_LOCK_ACTION_NONE, DL_LOCK_ACTION_UNLOCK, DL_LOCK_ACTION_LOCK or DL_LOCK_ACTION_INCORRECT.
+     * @note `locked` is updated by the table, so your tasks don't need to change it.
+     */
+    uint8_t lockEvent(uint8_t event) {
+        return _theDoorLockInstance.lockEvent(event);
+    }
+    /**
+     * @brief Does what the lock button should do: lock an open door, or check the code of a locked one.
+     * @return The action that ran (see lockEvent()).
+     */
+    uint8_t lockButtonPressed() {
+        return _theDoorLockInstance.lockButtonPressed();
+    }
+    /**
+     * @brief Picks the tasks the lock state machine runs to unlock, lock and show a wrong code.
+     * @param[in] unlockTask Task that opens the door, or nullptr for the built-in DoorUnlock().
+     * @param[in] lockTask Task that closes the door, or nullptr for the built-in DoorLock().
+     * @param[in] incorrectTask Task for a wrong code, or nullptr for the built-in DoorIncorrect().
+     * @note A task that is still running when its action comes round again starts over.
+     */
+    void setLockActions(DoorLockTaskFunction unlockTask, DoorLockTaskFunction lockTask,
+                        DoorLockTaskFunction incorrectTask) {
+        _theDoorLockInstance.setLockActions(unlockTask, lockTask, incorrectTask);
+    }
+
+    /**
+     * @brief Looks an RFID card up in the card table (src/RfidCards.h, made by tools/rfid_table.py).
+     * @param[in] uid The card's UID bytes.
+     * @param[in] length How many bytes the UID has (4, 7 or 10).
+     * @return The card's number in the list given to rfid_table.py (from 0), or -1 if it isn't enrolled.
+     * @note Needs DOORLOCK_USE_RFID in DoorLockConfig.h; without it this always returns -1.
+     */
+    int16_t findCard(const uint8_t* uid, uint8_t length) {
+        return _theDoorLockInstance.findCard(uid, length);
+    }
+    /**
+     * @brief Gets the UID of the last badge held against the reader, enrolled or not.
+     * @param[out] uid Room for DL_RFID_MAX_UID (10) bytes.
+     * @return How many bytes the UID has, or 0 if no badge has been read yet.
+     */
+    uint8_t lastCard(uint8_t* uid) {
+        return _theDoorLockInstance.lastCard(uid);
+    }
+
+    /**
+     * @brief Sets the clock that access schedules go by, without a date.
+     * @param[in] day Day of the week: 0 is Monday, 6 is Sunday.
+     * @param[in] hour 0-23.
+     * @param[in] minute 0-59.
+     * @param[in] second 0-59.
+     * @note Needs DOORLOCK_USE_SCHEDULES. With DOORLOCK_USE_DS3231 the time is kept by the clock chip,
+     * otherwise it is forgotten at every reset and has to be set again. One-time codes need
+     * setDateTime() instead.
+     */
+    void setTime(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+        _theDoorLockInstance.setTime(day, hour, minute, second);
+    }
+    /**
+     * @brief Sets the date and the local time, e.g. setDateTime(2024, 3, 15, 14, 30, 0).
+     * @param[in] year 2000-2099.
+     * @param[in] month 1-12.
+     * @param[in] day 1-31.
+     * @param[in] hour, minute, second Local time (DOORLOCK_UTC_OFFSET_MINUTES says how far it is from UTC).
+     * @return false if there is no such date.
+     * @note Needs DOORLOCK_USE_SCHEDULES or DOORLOCK_USE_TOTP. The day of the week is worked out from the date.
+     */
+    bool setDateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+        return _theDoorLockInstance.setDateTime(year, month, day, hour, minute, second);
+    }
+    /**
+     * @brief Lets a user in at certain times, e.g. setAccessWindow(0, DL_SCHEDULE_EVERY_DAY, 9, 0, 17, 30).
+     * @param[in] user 0 for the keypad code, card number + 1 for an RFID badge.
+     * @param[in] days Which days: bit 0 is Monday ... bit 6 is Sunday (0x1F is Monday to Friday).
+     * @param[in] fromHour, fromMinute When the window opens (rounded down to 15 minutes).
+     * @param[in] toHour, toMinute When it closes (rounded up to 15 minutes, 24:00 is midnight).
+     * @param[in] allowed false to keep the user out during the window instead.
+     * @return true if the window was saved, false for a bad user, day mask or time.
+     * @note The first window turns on a schedule for the user: outside their windows they are kept out.
+     * Windows are saved in EEPROM and still apply after a reset.
+     */
+    bool setAccessWindow(uint8_t user, uint8_t days, uint8_t fromHour, uint8_t fromMinute,
+                         uint8_t toHour, uint8_t toMinute, bool allowed) {
+        return _theDoorLockInstance.setAccessWindow(user, days, fromHour, fromMinute, toHour, toMinute, allowed);
+    }
+    /**
+     * @brief Removes a user's schedule, so they can come in at any time again.
+     * @param[in] user 0 for the keypad code, card number + 1 for an RFID badge.
+     */
+    void clearAccessSchedule(uint8_t user) {
+        _theDoorLockInstance.clearAccessSchedule(user);
+    }
+
+    /**
+     * @brief Sets a secret for one-time codes, the same secret an authenticator app is given.
+     * @param[in] slot 0 to DOORLOCK_TOTP_SECRETS - 1.
+     * @param[in] key The secret as bytes (tools/totp_code.py turns a base32 secret into bytes).
+     * @param[in] length Up to 64 bytes.
+     * @return false for a bad slot or a secret that is too long.
+     * @note Needs DOORLOCK_USE_TOTP and the date (setDateTime() or a DS3231). The secret itself is not
+     * kept, and is lost at a reset like the rest of the settings.
+     */
+    bool setOneTimeSecret(uint8_t slot, const uint8_t* key, uint8_t length) {
+        return _theDoorLockInstance.setOneTimeSecret(slot, key, length);
+    }
+    /**
+     * @brief Forgets a secret, so its one-time codes don't open the door any more.
+     * @param[in] slot 0 to DOORLOCK_TOTP_SECRETS - 1.
+     */
+    void clearOneTimeSecret(uint8_t slot) {
+        _theDoorLockInstance.clearOneTimeSecret(slot);
+    }
+
+    /**
+     * @brief Shows a short text on the bottom row of the status display for 3 seconds.
+     * @param[in] text Up to 21 characters. Lower case is shown as upper case.
+     * @note Needs DOORLOCK_USE_DISPLAY; otherwise it does nothing. The text is copied right away.
+     */
+    void displayMessage(const char* text) {
+        _theDoorLockInstance.displayMessage(text);
+    }
+
+    /**
+     * @brief Checks whether the last servo move got stuck (see DOORLOCK_USE_SERVO_SENSE).
+     * @return True after a move stalled on every try, until the next move. `locked` then says
+     * where the bolt really is.
+     * @note Always false without DOORLOCK_USE_SERVO_SENSE.
+     */
+    bool isJammed() {
+        return _theDoorLockInstance.isJammed();
+    }
+
+    /**
+     * @brief Lets the Arduino rest until something happens (a button, a timer, Serial data...).
+     * @note Put this at the end of loop() to save power. It only sleeps when DOORLOCK_USE_EDGE_EVENTS
+     * (or, on Linux, DOORLOCK_USE_LINUX_GPIO) is turned on in DoorLockConfig.h; otherwise it does nothing.
+     */
+    void idleUntilEvent() {
+        _theDoorLockInstance.idleUntilEvent();
+    }
+
+    /**
+     * @brief Checks whether DoorUnlock(), DoorLock() or DoorIncorrect() are still moving the servo or lighting LEDs.
+     * @return True until every queued servo/LED/buzzer command has finished.
+     */
+    bool isActuatorBusy() {
+        return _theDoorLockInstance.isActuatorBusy();
+    }
+    /**
+     * @brief Reports how long it takes from DoorUnlock()/DoorLock()/DoorIncorrect() to the first servo or LED change.
+     * @param[in] percent Which percentile to report, e.g. 50 for the median or 99 for the worst 1%.
+     * @return The latency in microseconds (rounded up to a power of two), or 0 if nothing was measured yet.
+     */
+    unsigned long actuationLatency(uint8_t percent) {
+        return _theDoorLockInstance.actuationLatency(percent);
+    }
+    /**
+     * @brief Clears the measurements reported by actuationLatency().
+     */
+    void resetActuationLatency() {
+        _theDoorLockInstance.resetActuationLatency();
+    }
+
+    /**
+     * @brief Turns the binary Serial command channel on or off.
+     * @param[in] enabled True to accept commands (status, new code, lock, unlock, stats, audit log) over Serial.
+     * @note The commands are sent by tools/doorlock_client.py, not typed into the Serial Monitor.
+     */
+    void enableSerialCommands(bool enabled) {
+        _theDoorLockInstance.enableSerialCommands(enabled);
+    }
+
+    /**
+     * @brief Locks the door again automatically some time after it was unlocked.
+     * @param[in] seconds How long the door stays unlocked, or 0 to turn auto-relock off.
+     * @param[in] handler Your own function to run when the time is up (for example one that calls runTask(lock)),
+     * or nullptr to just call DoorLock().
+     * @note The countdown starts whenever DoorUnlock() or open() is called, and stops on DoorLock() or close().
+     * If the door is already unlocked (for example after a reset with fast boot), it starts now.
+     */
+    void setAutoRelock(unsigned long seconds, void (*handler)()) {
+        _theDoorLockInstance.setAutoRelock(seconds, handler);
+    }
+    /**
+     * @brief Forgets a half-typed code if no button is pressed for a while.
+     * @param[in] ms How long to wait after the last digit, or 0 to turn the timeout off.
+     * @param[in] handler Your own function to run after the code is cleared (for example a short beep), or nullptr.
+     */
+    void setEntryTimeout(unsigned long ms, void (*handler)()) {
+        _theDoorLockInstance.setEntryTimeout(ms, handler);
+    }
+
+    /**
+     * @brief Measures how the 2 KB of RAM are being used right now.
+     * @return The sizes of the globals, the heap and the free RAM, and how close the stack ever came to the heap.
+     * @note If stackFreeMin gets near 0 the stack is about to overwrite other variables. Use fewer
+     * or smaller global arrays, or fewer big local variables.
+     */
+    DoorLockMemoryStats memoryStats() {
+        return _theDoorLockInstance.memoryStats();
+    }
+    /**
+     * @brief Prints memoryStats() to the Serial Monitor in one line.
+     */
+    void printMemoryStats() {
+        _theDoorLockInstance.printMemoryStats();
+    }
+
+    /**
+     * @brief Tells you how quickly the lock was ready after a reset.
+     * @return Microseconds from power-on/reset to the first scanButtons() call (0 if it hasn't been called yet).
+     */
+    unsigned long bootTimeMicros() {
+        return _theDoorLockInstance.bootTimeMicros();
+    }
+
+    /**
+     * @brief Shows how long one button's contacts bounce and how long the debouncer waits for them.
+     * @param[in] button DL_BUTTON_1, DL_BUTTON_2, DL_BUTTON_3 or DL_BUTTON_LOCK.
+     * @return The settle window, the worst bounce, a histogram of bounce lengths and whether the switch is wearing out (see AdaptiveDebounce.h).
+     * @note Each button starts with a safe 50 ms window and learns a shorter one after about 16 presses.
+     */
+    DoorLockDebounceReport debounceReport(uint8_t button) {
+        return _theDoorLockInstance.debounceReport(button);
+    }
+    /**
+     * @brief Prints debounceReport() of every button to the Serial Monitor, one line each.
+     * @note A button marked as wearing out bounces much longer than when it was new. It still works, but is getting slower.
+     */
+    void printDebounceReport() {
+        _theDoorLockInstance.printDebounceReport();
+    }
+
+    /**
+     * @brief Gets the usage counters: unlocks, locks, wrong codes, key presses and bounces per button, and more.
+     * @return A copy of the counters (see Telemetry.h). They stop at 65535 instead of going back to 0.
+     */
+    DoorLockTelemetry telemetry() {
+        return _theDoorLockInstance.telemetry();
+    }
+    /**
+     * @brief Packs the counters into DL_TELEMETRY_SNAPSHOT_SIZE bytes, ready to send somewhere.
+     * @param[out] out Where to write the snapshot; must have room for DL_TELEMETRY_SNAPSHOT_SIZE bytes.
+     * @return The number of bytes written.
+     */
+    uint8_t telemetrySnapshot(uint8_t* out) {
+        return _theDoorLockInstance.telemetrySnapshot(out);
+    }
+    /**
+     * @brief Sets every usage counter back to 0.
+     */
+    void resetTelemetry() {
+        _theDoorLockInstance.resetTelemetry();
+    }
+
+    /**
+     * @brief Turns on the watchdog, which resets the board if the sketch gets stuck.
+     * @param[in] ms How long scanButtons() may go without being called, e.g. 2000. 0 turns the watchdog off.
+     * @note Before resetting, the board writes down what was running. start() prints it after the reset.
+     * Don't use long delay()s in loop() with the watchdog on. AVR boards only.
+     */
+    void enableWatchdog(unsigned long ms) {
+        _theDoorLockInstance.enableWatchdog(ms);
+    }
+    /**
+     * @brief Tells you the longest time loop() went without calling scanButtons(), and what was running then.
+     * @return longestGapMs, longestGapSite (a DL_SITE_... value) and longestGapCallback (the task or handler, if any).
+     */
+    DoorLockStallReport stallReport() {
+        return _theDoorLockInstance.stallReport();
+    }
+    /**
+     * @brief Same as stallReport(), but for the time before the last reset, plus what the watchdog caught (if it fired).
+     */
+    DoorLockStallReport previousStallReport() {
+        return _theDoorLockInstance.previousStallReport();
+    }
+
+    /**
+     * @brief Gets the next button event (press, release, long press, repeat, double tap or chord).
+     * @param[out] event Filled in with the event's type, buttons and time.
+     * @return True if there was an event, false if nothing new happened.
+     * @note Call scanButtons() in loop() so events keep coming. See ButtonEvents.h for the event types.
+     * Up to 7 events wait to be read; newer ones are dropped and counted in telemetry().eventsDropped.
+     */
+    bool nextButtonEvent(DoorLockButtonEvent& event) {
+        return _theDoorLockInstance.nextButtonEvent(event);
+    }
+    /**
+     * @brief Sets how long a button must be held for a long press.
+     * @param[in] ms Hold time in milliseconds (default 800).
+     */
+    void setLongPressTime(unsigned long ms) {
+        _theDoorLockInstance.setLongPressTime(ms);
+    }
+    /**
+     * @brief Sets how often repeat events are sent while a button stays held after a long press.
+     * @param[in] ms Time between repeats in milliseconds (default 200), or 0 for no repeats.
+     */
+    void setRepeatInterval(unsigned long ms) {
+        _theDoorLockInstance.setRepeatInterval(ms);
+    }
+    /**
+     * @brief Sets how quickly a button must be pressed again after a tap to count as a double tap.
+     * @param[in] ms Longest gap in milliseconds (default 300).
+     */
+    void setDoubleTapTime(unsigned long ms) {
+        _theDoorLockInstance.setDoubleTapTime(ms);
+    }
+
+} // end namespace DoorLock
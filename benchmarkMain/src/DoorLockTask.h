@@ -0,0 +1,82 @@
+#ifndef ARDUINO_DOORLOCK_TASK_H
+#define ARDUINO_DOORLOCK_TASK_H
+
+#include <Arduino.h>
+
+// --- Tasks: "Wait" Without Freezing the Door Lock ---
+// delay() stops EVERYTHING, so no buttons are read while an LED blinks or the buzzer beeps.
+// A task is a function you write top to bottom like normal, but with DL_WAIT_MS() instead
+// of delay(). While it waits, the library goes back to reading buttons, and every time
+// scanButtons() runs it picks the task back up right where it left off.
+//
+//   DL_TASK(unlock) {
+//     DL_TASK_BEGIN();
+//     greenLEDToggle(true);
+//     DL_WAIT_MS(500);        // instead of delay(500)
+//     greenLEDToggle(false);
+//     DL_TASK_END();
+//   }
+//
+//   ...then in loop():  runTask(unlock);
+//
+// Rules for tasks:
+//  - Put DL_TASK_BEGIN() first and DL_TASK_END() last.
+//  - Local variables are forgotten while waiting. Use global (or static) variables instead.
+//  - Only one DL_WAIT_MS() per line of code.
+//  - Don't put DL_WAIT_MS() inside a switch statement.
+
+// Where a task is up to. The library keeps one of these for every running task.
+struct DoorLockTask {
+    uint16_t resumeLine;     // Line to continue from (0 means start from the top)
+    unsigned long waitStart; // millis() when the current wait began
+    unsigned long waitMs;    // How long the current wait lasts
+};
+
+// A task function returns true once it has finished, false while it is still waiting.
+typedef bool (*DoorLockTaskFunction)(DoorLockTask* task);
+
+// Declares a task function called `name`.
+#define DL_TASK(name) bool name(DoorLockTask* _dlTask)
+
+// Tells the compiler that running on into the next `case` is meant (no -Wimplicit-fallthrough).
+// A /* fallthrough */ comment doesn't work here: comments are gone before macros are expanded.
+#if defined(__has_attribute)
+#if __has_attribute(fallthrough)
+#define DL_FALLTHROUGH __attribute__((fallthrough))
+#endif
+#endif
+#ifndef DL_FALLTHROUGH
+#define DL_FALLTHROUGH do {} while (0)
+#endif
+
+// Marks the start of the task body.
+#define DL_TASK_BEGIN() switch (_dlTask->resumeLine) { case 0:
+
+// Waits ms milliseconds, letting the rest of the door lock keep running meanwhile.
+#define DL_WAIT_MS(ms)                                                    \
+    do {                                                                  \
+        _dlTask->waitStart = millis();                                    \
+        _dlTask->waitMs = (ms);                                           \
+        _dlTask->resumeLine = __LINE__;                                   \
+        DL_FALLTHROUGH;                                                   \
+        case __LINE__:                                                    \
+        if (millis() - _dlTask->waitStart < _dlTask->waitMs) {            \
+            return false;                                                 \
+        }                                                                 \
+    } while (0)
+
+// Waits until condition is true, letting the rest of the door lock keep running meanwhile.
+#define DL_WAIT_UNTIL(condition)                                          \
+    do {                                                                  \
+        _dlTask->resumeLine = __LINE__;                                   \
+        DL_FALLTHROUGH;                                                   \
+        case __LINE__:                                                    \
+        if (!(condition)) {                                               \
+            return false;                                                 \
+        }                                                                 \
+    } while (0)
+
+// Marks the end of the task body.
+#define DL_TASK_END() } _dlTask->resumeLine = 0; return true
+
+#endif // ARDUINO_DOORLOCK_TASK_H
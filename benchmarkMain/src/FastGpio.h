@@ -0,0 +1,80 @@
+#ifndef ARDUINO_DOORLOCK_FASTGPIO_H
+#define ARDUINO_DOORLOCK_FASTGPIO_H
+
+#include <Arduino.h>
+
+// --- Internal Fast GPIO Helper ---
+// digitalRead() and digitalWrite() look up the port and bit mask of a pin in
+// lookup tables, and turn off any PWM timer on that pin, on EVERY call.
+// _FastPin does all of that once when a pin is bound (from start() or setPins())
+// and afterwards reads/writes the port register directly.
+// On boards that are not AVR based it simply falls back to digitalRead/digitalWrite.
+// Pins of the I2C port expander (DL_EXPANDER_PIN and up, see PortExpander.h) read and write the
+// expander's copy of its pins in RAM instead, on every board.
+// With DOORLOCK_USE_LINUX_GPIO the other pins are GPIO chip lines, and read and write the copy
+// kept by LinuxGpio.h the same way.
+class _FastPin
+{
+private:
+#if defined(__AVR__)
+    volatile uint8_t* _in;  // PINx register, used for reading
+    volatile uint8_t* _out; // PORTx register, used for writing
+    uint8_t _mask;          // Bit of this pin inside the port
+#else
+    int _pin;
+    volatile uint8_t* _shadow; // Port expander pins and Linux GPIO lines only
+    uint8_t _mask;
+#endif
+
+    bool _bindExpander(int pin, bool output);
+    bool _bindLinux(int pin, bool output);
+
+public:
+    _FastPin();
+
+    // Configures the pin as a button input (INPUT_PULLUP) and caches its registers.
+    void bindInput(int pin);
+    // Configures the pin as an output, drives it LOW and caches its registers.
+    void bindOutput(int pin);
+
+    // Returns HIGH or LOW, same as digitalRead().
+    inline int read() const
+    {
+#if defined(__AVR__)
+        return (*_in & _mask) ? HIGH : LOW;
+#else
+        if (_shadow) {
+            return (*_shadow & _mask) ? HIGH : LOW;
+        }
+        return digitalRead(_pin);
+#endif
+    }
+
+    // Same as digitalWrite(pin, high ? HIGH : LOW).
+    inline void write(bool high)
+    {
+#if defined(__AVR__)
+        // Interrupts are held off so an ISR touching the same port can't lose our write.
+        uint8_t oldSREG = SREG;
+        cli();
+        if (high) {
+            *_out |= _mask;
+        } else {
+            *_out &= ~_mask;
+        }
+        SREG = oldSREG;
+#else
+        if (_shadow) {
+            if (high) {
+                *_shadow |= _mask;
+            } else {
+                *_shadow &= ~_mask;
+            }
+            return;
+        }
+        digitalWrite(_pin, high ? HIGH : LOW);
+#endif
+    }
+};
+
+#endif // ARDUINO_DOORLOCK_FASTGPIO_H
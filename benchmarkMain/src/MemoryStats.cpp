@@ -0,0 +1,118 @@
+#include "MemoryStats.h"
+
+#if defined(__AVR__) && DOORLOCK_ENABLE_MEMORY_STATS
+
+// Symbols from the avr-libc linker script and malloc()
+extern char __data_start, __data_end, __bss_start, __bss_end, __heap_start;
+extern char* __brkval; // Top of the heap, or 0 while nothing has been allocated
+struct __freelist {
+    size_t sz; // Usable bytes in this block (not counting sz itself)
+    struct __freelist* nx;
+};
+extern struct __freelist* __flp; // Blocks that were freed but are still below __brkval
+
+static const uint8_t STACK_PAINT = 0xC5;
+
+// Runs in .init3, after the stack pointer is set up and before .data/.bss are filled in and any
+// constructor or setup() runs. Only the (still empty) RAM above the globals is painted.
+extern "C" void _doorLockPaintStack() __attribute__((naked, used, section(".init3")));
+extern "C" void _doorLockPaintStack()
+{
+    uint8_t* p = (uint8_t*)&__heap_start;
+    uint8_t* top = (uint8_t*)(uintptr_t)SP;
+    while (p < top) {
+        *p++ = STACK_PAINT;
+    }
+}
+
+void _readMemoryStats(DoorLockMemoryStats& stats)
+{
+    char* heapTop = __brkval ? __brkval : &__heap_start;
+
+    stats.dataBytes = &__data_end - &__data_start;
+    stats.bssBytes = &__bss_end - &__bss_start;
+    stats.heapPeak = 0;
+    stats.allocations = 0;
+
+    uint16_t freeListBytes = 0;
+    uint16_t largest = 0;
+    for (struct __freelist* block = __flp; block; block = block->nx) {
+        freeListBytes += block->sz + sizeof(size_t);
+        if (block->sz > largest) {
+            largest = block->sz;
+        }
+    }
+    stats.heapUsed = (heapTop - &__heap_start) - freeListBytes;
+
+    uint16_t gap = (char*)(uintptr_t)SP - heapTop;
+    stats.freeBytes = gap + freeListBytes;
+    stats.largestFreeBlock = gap > largest ? gap : largest;
+
+    // Count the painted bytes still left above the heap
+    uint16_t untouched = 0;
+    for (const uint8_t* p = (const uint8_t*)heapTop; p < (const uint8_t*)(uintptr_t)SP && *p == STACK_PAINT; p++) {
+        untouched++;
+    }
+    stats.stackFreeMin = untouched;
+}
+
+#elif DOORLOCK_MEMORY_HOOKS
+
+#include <new>
+
+// Every block gets a small header in front that remembers its size, so delete can subtract it.
+// A program on a computer may allocate from several threads (host_bench.py's two-thread runs do),
+// so the counters are updated atomically.
+union _AllocationHeader {
+    size_t size;
+    max_align_t align;
+};
+
+static uint32_t _heapUsed = 0;
+static uint32_t _heapPeak = 0;
+static uint32_t _allocations = 0;
+
+// new[] and the nothrow/sized versions all end up in these two.
+void* operator new(size_t size)
+{
+    _AllocationHeader* header = (_AllocationHeader*)malloc(sizeof(_AllocationHeader) + size);
+    if (!header) {
+        throw std::bad_alloc();
+    }
+    header->size = size;
+    uint32_t used = __atomic_add_fetch(&_heapUsed, (uint32_t)size, __ATOMIC_RELAXED);
+    uint32_t peak = __atomic_load_n(&_heapPeak, __ATOMIC_RELAXED);
+    while (used > peak && !__atomic_compare_exchange_n(&_heapPeak, &peak, used, true, __ATOMIC_RELAXED,
+                                                       __ATOMIC_RELAXED)) {
+    }
+    __atomic_add_fetch(&_allocations, 1, __ATOMIC_RELAXED);
+    return header + 1;
+}
+
+void operator delete(void* block) noexcept
+{
+    if (!block) {
+        return;
+    }
+    _AllocationHeader* header = (_AllocationHeader*)block - 1;
+    __atomic_sub_fetch(&_heapUsed, (uint32_t)header->size, __ATOMIC_RELAXED);
+    free(header);
+}
+
+void _readMemoryStats(DoorLockMemoryStats& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.heapUsed = __atomic_load_n(&_heapUsed, __ATOMIC_RELAXED);
+    stats.heapPeak = __atomic_load_n(&_heapPeak, __ATOMIC_RELAXED);
+    stats.allocations = __atomic_load_n(&_allocations, __ATOMIC_RELAXED);
+}
+
+#else
+
+// No way to look at memory on this board (or DOORLOCK_ENABLE_MEMORY_STATS is off).
+void _readMemoryStats(DoorLockMemoryStats& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+#endif
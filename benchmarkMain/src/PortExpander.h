@@ -0,0 +1,53 @@
+#ifndef ARDUINO_DOORLOCK_PORTEXPANDER_H
+#define ARDUINO_DOORLOCK_PORTEXPANDER_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+#include "FastGpio.h"
+
+// --- I2C Port Expander (MCP23017) ---
+// Moves the buttons and LEDs onto the 16 pins of an MCP23017, so they don't use up pins of the
+// Arduino. Give them pin numbers from DL_EXPANDER_PIN up (see below) in setPins().
+//
+// Talking over I2C is slow compared to reading a port register, so the library keeps a copy of
+// the expander's pins in RAM and _FastPin reads and writes that copy, as if it were a port:
+//   - inputs are only read when the expander pulls its INT line LOW (a button pin changed), and
+//     then both ports in one burst. While nothing changes there is no I2C traffic at all.
+//   - outputs are collected and written in one burst at most once per scanButtons(), only if
+//     something changed.
+// The servo and the buzzer need exact timing, so they stay on Arduino pins. The LEDs can move, but
+// only fully on and fully off work there: dimming them needs an Arduino pin.
+
+const int DL_EXPANDER_PIN = 100; // 100-107 are GPA0-GPA7, 108-115 are GPB0-GPB7
+
+class _PortExpander
+{
+public:
+    volatile uint8_t inputs[2] = {0xFF, 0xFF}; // GPIOA and GPIOB as last read
+    volatile uint8_t outputs[2] = {0, 0};      // What the output pins should be (OLATA, OLATB)
+
+private:
+    bool _started = false;
+    uint8_t _written[2] = {0, 0};           // OLAT as last written
+    uint8_t _direction[2] = {0xFF, 0xFF};   // IODIR: 1 = input
+    uint8_t _watched[2] = {0, 0};           // Bound inputs: pull-up and interrupt-on-change on
+    _FastPin _interrupt;                    // The expander's INT line (LOW: an input changed)
+
+    void _begin();
+    void _writeRegisters(uint8_t reg, const uint8_t* values, uint8_t count);
+    void _readInputs();
+
+public:
+    // Set up one expander pin (0-15) and return the RAM copy _FastPin should use for it.
+    volatile uint8_t* bindInput(uint8_t pin);
+    volatile uint8_t* bindOutput(uint8_t pin);
+
+    // Once per scanButtons(): writes changed outputs, and reads the inputs if INT is LOW.
+    void update();
+};
+
+#if DOORLOCK_USE_EXPANDER
+extern _PortExpander _thePortExpander;
+#endif
+
+#endif // ARDUINO_DOORLOCK_PORTEXPANDER_H
@@ -0,0 +1,21 @@
+#ifndef ARDUINO_DOORLOCK_RFIDCARDS_H
+#define ARDUINO_DOORLOCK_RFIDCARDS_H
+
+// --- Enrolled RFID Cards ---
+// Made by tools/rfid_table.py with no cards yet. Run it with your card list to enroll them.
+
+const uint16_t DL_RFID_CARD_COUNT = 0;
+const uint16_t DL_RFID_BUCKET_COUNT = 1;
+const uint8_t DL_RFID_UID_BYTES = 4;
+
+// Seed of the second hash, per bucket
+const uint16_t DL_RFID_SEEDS[1] PROGMEM = {
+    0,
+};
+
+// Per slot: UID length, UID (padded with zeros), card number (low byte first)
+const uint8_t DL_RFID_CARDS[1][1 + DL_RFID_UID_BYTES + 2] PROGMEM = {
+    {0}, // No cards enrolled
+};
+
+#endif // ARDUINO_DOORLOCK_RFIDCARDS_H
@@ -0,0 +1,192 @@
+#include "Supervisor.h"
+
+#if DOORLOCK_ENABLE_SUPERVISOR
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+#endif
+
+_Supervisor _theSupervisor;
+
+// --- Crash Record ---
+// Lives in .noinit, so a reset (watchdog, reset button, brown-out) leaves it as it was. After
+// power-up it holds random bytes, which the magic number and checksum catch.
+const uint16_t CRASH_RECORD_MAGIC = 0xD10C;
+const uint8_t NO_WATCHDOG = 0xFF;
+
+struct _CrashRecord {
+    uint16_t magic;
+    uint8_t watchdogSite; // NO_WATCHDOG unless the watchdog interrupt wrote it
+    uintptr_t watchdogCallback;
+    uint32_t longestGapMs;
+    uint8_t longestGapSite;
+    uintptr_t longestGapCallback;
+    uint8_t checksum;
+};
+
+#if defined(__AVR__)
+static _CrashRecord _crashRecord __attribute__((section(".noinit")));
+#else
+static _CrashRecord _crashRecord;
+#endif
+
+static uint8_t _crashRecordChecksum()
+{
+    const uint8_t* bytes = (const uint8_t*)&_crashRecord;
+    uint8_t sum = 0x5A;
+    for (uint8_t i = 0; i < offsetof(_CrashRecord, checksum); i++) {
+        sum += bytes[i];
+    }
+    return sum;
+}
+
+static void _sealCrashRecord()
+{
+    _crashRecord.magic = CRASH_RECORD_MAGIC;
+    _crashRecord.checksum = _crashRecordChecksum();
+}
+
+#if defined(__AVR__)
+// After a watchdog reset the watchdog is still running with the shortest timeout, so it has
+// to be switched off before anything else (the bootloader may not do it).
+extern "C" void _doorLockWatchdogOff() __attribute__((naked, used, section(".init3")));
+extern "C" void _doorLockWatchdogOff()
+{
+    MCUSR &= ~_BV(WDRF);
+    wdt_disable();
+}
+#endif
+
+// --- Stall Detection ---
+void _Supervisor::scanned(unsigned long now)
+{
+    if (_scanned) {
+        uint32_t gap = now - _lastScanMs;
+        if (gap > _crashRecord.longestGapMs) {
+            // Blame the slowest piece of library code (or task/handler) if it took at least
+            // half of the gap, otherwise the time went by in the sketch itself.
+            bool blame = _slowestMs * 2 >= gap;
+            _crashRecord.longestGapMs = gap;
+            _crashRecord.longestGapSite = blame ? _slowestSite : (uint8_t)DL_SITE_SKETCH;
+            _crashRecord.longestGapCallback = blame ? _slowestCallback : 0;
+            _sealCrashRecord();
+        }
+    }
+    _scanned = true;
+    _lastScanMs = now;
+    _slowestMs = 0;
+
+#if defined(__AVR__)
+    if (_watchdogOn) {
+        wdt_reset();
+        WDTCSR |= _BV(WDIE); // The interrupt clears this when it fires; ask for it again
+    }
+#endif
+}
+
+void _Supervisor::enter(_SiteGuard& guard)
+{
+    guard._previousSite = _site;
+    guard._previousCallback = _callback;
+    guard._outerNestedMs = _nestedMs;
+    guard._start = millis();
+    _nestedMs = 0;
+    _callback = guard._callback;
+    _site = guard._site; // Written last: the watchdog interrupt reads these two
+}
+
+void _Supervisor::leave(_SiteGuard& guard)
+{
+    uint32_t ms = millis() - guard._start;
+    uint32_t ownMs = ms - _nestedMs; // Time inside nested guards belongs to them
+    if (ownMs > _slowestMs) {
+        _slowestMs = ownMs;
+        _slowestSite = guard._site;
+        _slowestCallback = guard._callback;
+    }
+    _nestedMs = guard._outerNestedMs + ms;
+    _site = guard._previousSite;
+    _callback = guard._previousCallback;
+}
+
+// --- Hardware Watchdog ---
+// The watchdog runs in "interrupt, then reset" mode: when it first runs out, the interrupt
+// writes down what was running; if scanButtons() still isn't called it resets the board one
+// watchdog time later.
+void _Supervisor::enableWatchdog(unsigned long ms)
+{
+#if defined(__AVR__)
+    static const uint16_t TIMEOUTS_MS[] = {15, 30, 60, 120, 250, 500, 1000, 2000, 4000, 8000};
+    if (ms == 0) {
+        wdt_disable();
+        _watchdogOn = false;
+        return;
+    }
+    uint8_t setting = 0;
+    while (setting < 9 && TIMEOUTS_MS[setting] < ms) {
+        setting++;
+    }
+    wdt_enable(setting);
+    WDTCSR |= _BV(WDIE);
+    _watchdogOn = true;
+#else
+    (void)ms;
+#endif
+}
+
+void _Supervisor::watchdogInterrupt()
+{
+    _crashRecord.watchdogSite = _site;
+    _crashRecord.watchdogCallback = _callback;
+    uint32_t gap = millis() - _lastScanMs;
+    if (gap > _crashRecord.longestGapMs) {
+        _crashRecord.longestGapMs = gap;
+        _crashRecord.longestGapSite = _site;
+        _crashRecord.longestGapCallback = _callback;
+    }
+    _sealCrashRecord();
+}
+
+#if defined(__AVR__)
+ISR(WDT_vect)
+{
+    _theSupervisor.watchdogInterrupt();
+}
+#endif
+
+// --- Reports ---
+bool _Supervisor::takePreviousReport(DoorLockStallReport& report)
+{
+    bool valid = _crashRecord.magic == CRASH_RECORD_MAGIC && _crashRecord.checksum == _crashRecordChecksum();
+    if (valid) {
+        report.watchdogReset = _crashRecord.watchdogSite != NO_WATCHDOG;
+        report.watchdogSite = report.watchdogReset ? _crashRecord.watchdogSite : (uint8_t)DL_SITE_SKETCH;
+        report.watchdogCallback = _crashRecord.watchdogCallback;
+        report.longestGapMs = _crashRecord.longestGapMs;
+        report.longestGapSite = _crashRecord.longestGapSite;
+        report.longestGapCallback = _crashRecord.longestGapCallback;
+    }
+
+    // Start a fresh record for this run
+    _crashRecord.watchdogSite = NO_WATCHDOG;
+    _crashRecord.watchdogCallback = 0;
+    _crashRecord.longestGapMs = 0;
+    _crashRecord.longestGapSite = DL_SITE_SKETCH;
+    _crashRecord.longestGapCallback = 0;
+    _sealCrashRecord();
+    _scanned = false;
+    return valid;
+}
+
+void _Supervisor::currentReport(DoorLockStallReport& report)
+{
+    report.watchdogReset = false;
+    report.watchdogSite = DL_SITE_SKETCH;
+    report.watchdogCallback = 0;
+    report.longestGapMs = _crashRecord.longestGapMs;
+    report.longestGapSite = _crashRecord.longestGapSite;
+    report.longestGapCallback = _crashRecord.longestGapCallback;
+}
+
+#endif // DOORLOCK_ENABLE_SUPERVISOR
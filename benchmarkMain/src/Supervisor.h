@@ -0,0 +1,112 @@
+#ifndef ARDUINO_DOORLOCK_SUPERVISOR_H
+#define ARDUINO_DOORLOCK_SUPERVISOR_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+
+// --- Loop-Stall Supervisor ---
+// The lock only reacts to buttons while scanButtons() keeps getting called. If something
+// blocks (a long delay() in the sketch, a task or callback that never returns...), the lock
+// looks frozen. The supervisor keeps track of:
+//   - the longest time between two scanButtons() calls, and which part of the library (or
+//     which task/callback of the sketch) was running during that time
+//   - optionally the hardware watchdog: if scanButtons() isn't called for the watchdog time,
+//     the watchdog interrupt writes down what was running and the board resets shortly after.
+// Both are kept in a crash record in RAM that is not cleared on reset (.noinit), and start()
+// prints what happened before the reset.
+
+// Which part of the code was running
+enum DoorLockSite : uint8_t {
+    DL_SITE_SKETCH = 0,       // The sketch's own code, outside the library
+    DL_SITE_SCAN,             // scanButtons() itself
+    DL_SITE_BUTTON_HANDLER,   // button1Pressed(), button2Pressed() or button3Pressed()
+    DL_SITE_DOOR_UNLOCK,      // DoorUnlock()
+    DL_SITE_DOOR_LOCK,        // DoorLock()
+    DL_SITE_DOOR_INCORRECT,   // DoorIncorrect()
+    DL_SITE_TASK,             // A task started with runTask()
+    DL_SITE_TIMEOUT_HANDLER,  // The auto-relock or entry timeout handler
+    DL_SITE_SERIAL_COMMAND,   // A command from the Serial command channel
+    DL_SITE_RFID,             // Talking to the RFID reader
+    DL_SITE_COUNT
+};
+
+struct DoorLockStallReport {
+    bool watchdogReset;          // The last reset was caused by the watchdog
+    uint8_t watchdogSite;        // DoorLockSite running when the watchdog ran out
+    uintptr_t watchdogCallback;  // Address of the task/handler running then (0 = none)
+    uint32_t longestGapMs;       // Longest time between two scanButtons() calls
+    uint8_t longestGapSite;      // DoorLockSite that took up most of that time
+    uintptr_t longestGapCallback; // Address of the task/handler that did (0 = none)
+};
+
+#if DOORLOCK_ENABLE_SUPERVISOR
+
+class _SiteGuard;
+
+class _Supervisor
+{
+private:
+    volatile uint8_t _site = DL_SITE_SKETCH;
+    volatile uintptr_t _callback = 0;
+    unsigned long _lastScanMs = 0;
+    bool _scanned = false;          // scanButtons() has run at least once
+    uint32_t _slowestMs = 0;        // Longest single site visit since the last scan...
+    uint8_t _slowestSite = DL_SITE_SKETCH;
+    uintptr_t _slowestCallback = 0; // ...and the callback it ran
+    uint32_t _nestedMs = 0;         // Time spent in guards inside the current one
+    bool _watchdogOn = false;
+
+public:
+    // Called at the top of every scanButtons(); measures the gap since the previous call.
+    void scanned(unsigned long now);
+
+    // Used by _SiteGuard
+    void enter(_SiteGuard& guard);
+    void leave(_SiteGuard& guard);
+
+    void enableWatchdog(unsigned long ms);
+    void watchdogInterrupt(); // Only called by the watchdog interrupt
+
+    // Takes the record left by the previous run (and clears it for this one)
+    bool takePreviousReport(DoorLockStallReport& report);
+    void currentReport(DoorLockStallReport& report);
+};
+
+extern _Supervisor _theSupervisor;
+
+// Marks a stretch of code as `site` for as long as the guard exists:
+//     _SiteGuard guard(DL_SITE_TASK, (uintptr_t)task);
+// On AVR a callback address is a word address; double it to find it in avr-nm output.
+class _SiteGuard
+{
+private:
+    friend class _Supervisor;
+    uint8_t _site;
+    uint8_t _previousSite;
+    uintptr_t _callback;
+    uintptr_t _previousCallback;
+    unsigned long _start;
+    uint32_t _outerNestedMs;
+
+public:
+    _SiteGuard(uint8_t site, uintptr_t callback = 0) : _site(site), _callback(callback)
+    {
+        _theSupervisor.enter(*this);
+    }
+    ~_SiteGuard()
+    {
+        _theSupervisor.leave(*this);
+    }
+};
+
+#else
+
+class _SiteGuard
+{
+public:
+    _SiteGuard(uint8_t, uintptr_t = 0) {}
+};
+
+#endif
+
+#endif // ARDUINO_DOORLOCK_SUPERVISOR_H
@@ -0,0 +1,50 @@
+#ifndef ARDUINO_DOORLOCK_TELEMETRY_H
+#define ARDUINO_DOORLOCK_TELEMETRY_H
+
+#include <Arduino.h>
+
+// --- Telemetry Counters ---
+// A fixed block of counters that the library keeps up to date as it runs. Counters stop at
+// their largest value instead of wrapping around to 0. Read them with telemetry(), or as a
+// packed snapshot with telemetrySnapshot() / the DL_CMD_TELEMETRY Serial command.
+//
+// Snapshot layout (version 2, little-endian, DL_TELEMETRY_SNAPSHOT_SIZE bytes):
+//   u8  version
+//   u32 uptime ms
+//   u16 unlocks, locks, incorrect attempts, servo moves
+//   u16 key presses of button 1, 2, 3, lock button
+//   u16 bounces filtered on button 1, 2, 3, lock button
+//   u16 codes entered (timed)
+//   u32 total code entry time ms (divide by codes entered for the mean)
+//   u16 button events dropped (new in version 2; version 1 ends before it)
+// tools/doorlock_client.py has the matching decoder.
+
+const uint8_t DL_TELEMETRY_VERSION = 2;
+const uint8_t DL_TELEMETRY_SNAPSHOT_SIZE = 37;
+
+struct DoorLockTelemetry {
+    uint16_t unlocks;        // DoorUnlock() or open()
+    uint16_t locks;          // DoorLock() or close()
+    uint16_t incorrect;      // isAttemptCorrect() said no to an entered code
+    uint16_t servoMoves;     // Times the servo was told to move
+    uint16_t keyPresses[4];  // Debounced presses of button 1, 2, 3 and the lock button
+    uint16_t bounces[4];     // Contact bounces the debouncer filtered out, per button
+    uint16_t entries;        // Codes whose entry time was measured
+    uint32_t entryTimeMs;    // First digit to isAttemptCorrect(), summed over those codes
+    uint16_t eventsDropped;  // Button events lost because the sketch didn't read them in time
+};
+
+// Adds one, but stops at the largest value instead of wrapping around.
+inline void _saturatingIncrement(uint16_t& counter)
+{
+    if (counter != 0xFFFF) {
+        counter++;
+    }
+}
+
+inline void _saturatingAdd(uint32_t& counter, uint32_t amount)
+{
+    counter = (counter > 0xFFFFFFFFUL - amount) ? 0xFFFFFFFFUL : counter + amount;
+}
+
+#endif // ARDUINO_DOORLOCK_TELEMETRY_H
@@ -0,0 +1,235 @@
+#include "TimerMux.h"
+
+#if DOORLOCK_USE_TIMER_MUX
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+_TimerMux _theTimerMux;
+
+// Servo timing, matching the defaults of the Arduino Servo library
+const uint16_t SERVO_MIN_PULSE_US = 544;   // Pulse width at 0 degrees
+const uint16_t SERVO_MAX_PULSE_US = 2400;  // Pulse width at 180 degrees
+const uint16_t SERVO_PERIOD_US = 20000;    // One pulse every 20 ms
+
+// Software PWM period for the LEDs (about 490 Hz, the same as analogWrite())
+const uint16_t LED_PWM_PERIOD_US = 2048;
+
+// The longest the timer can wait in one go (Timer2 is only 8 bits)
+const uint8_t MAX_INTERVAL_TICKS = 250;
+
+// Private helper: sets up Timer2 the first time any channel is used.
+void _TimerMux::_begin()
+{
+    if (_running) {
+        return;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR2A = _BV(WGM21); // CTC mode: count up to OCR2A, then start again from 0
+        TCCR2B = _BV(CS22);  // Prescaler 64
+        TCNT2 = 0;
+        _lastInterval = MAX_INTERVAL_TICKS;
+        OCR2A = MAX_INTERVAL_TICKS - 1;
+        TIFR2 = _BV(OCF2A);  // Clear any old pending interrupt
+        TIMSK2 |= _BV(OCIE2A);
+        _running = true;
+    }
+}
+
+// Private helper: (re)starts a channel with new HIGH/LOW times.
+// If the channel is already running only the times change, so a servo pulse
+// or a tone isn't cut short in the middle.
+void _TimerMux::_setChannel(uint8_t id, uint16_t highTicks, uint16_t lowTicks)
+{
+    _begin();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        Channel& ch = _channels[id];
+        ch.highTicks = highTicks;
+        ch.lowTicks = lowTicks;
+        if (!ch.active) {
+            ch.level = true;
+            ch.pin.write(true);
+            ch.active = true;
+            // The next interrupt will subtract the whole current interval, part of which has
+            // already passed, so add that part back on.
+            uint8_t now = TCNT2;
+            if (TIFR2 & _BV(OCF2A)) {
+                // The interval has just ended and its interrupt waits for us: count from its end
+                // (the counter has started again from 0, so read it again)
+                ch.remaining = _lastInterval + TCNT2 + highTicks;
+            } else {
+                ch.remaining = highTicks + now;
+                // If this edge comes before the interrupt the timer is set for, bring the
+                // interrupt forward, or the first HIGH would last until then (up to 250 ticks).
+                // Never ask for a count the timer has already passed, like handleInterrupt().
+                uint16_t due = ch.remaining < (uint16_t)now + 3 ? now + 3 : ch.remaining;
+                if (due < _lastInterval) {
+                    OCR2A = due - 1;
+                    _lastInterval = due;
+                }
+            }
+        }
+    }
+}
+
+// Private helper: stops a channel and leaves its pin at a fixed level.
+void _TimerMux::_stopChannel(uint8_t id, bool level)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        Channel& ch = _channels[id];
+        ch.active = false;
+        ch.level = level;
+        ch.pin.write(level);
+    }
+}
+
+// --- Servo ---
+void _TimerMux::attachServo(int pin)
+{
+    _stopChannel(DL_MUX_SERVO, false);
+    _channels[DL_MUX_SERVO].pin.bindOutput(pin);
+}
+
+void _TimerMux::writeServo(int angle)
+{
+    if (angle < 0) {
+        angle = 0;
+    } else if (angle > 180) {
+        angle = 180;
+    }
+    uint16_t pulse = SERVO_MIN_PULSE_US + (uint32_t)(SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) * angle / 180;
+    _setChannel(DL_MUX_SERVO, pulse / TICK_US, (SERVO_PERIOD_US - pulse) / TICK_US);
+}
+
+void _TimerMux::detachServo()
+{
+    _stopChannel(DL_MUX_SERVO, false);
+}
+
+// --- Buzzer ---
+void _TimerMux::bindBuzzer(int pin)
+{
+    _stopChannel(DL_MUX_BUZZER, false);
+    _channels[DL_MUX_BUZZER].pin.bindOutput(pin);
+}
+
+void _TimerMux::buzzerOn(unsigned int hz)
+{
+    if (hz == 0) {
+        buzzerOff();
+        return;
+    }
+    uint32_t halfPeriodTicks = 500000UL / hz / TICK_US;
+    if (halfPeriodTicks == 0) {
+        halfPeriodTicks = 1;
+    } else if (halfPeriodTicks > 0xFFFF) {
+        halfPeriodTicks = 0xFFFF;
+    }
+    _setChannel(DL_MUX_BUZZER, halfPeriodTicks, halfPeriodTicks);
+}
+
+void _TimerMux::buzzerOff()
+{
+    _stopChannel(DL_MUX_BUZZER, false);
+}
+
+// --- LEDs ---
+void _TimerMux::bindLED(uint8_t id, int pin)
+{
+    _stopChannel(id, false);
+    _channels[id].pin.bindOutput(pin);
+}
+
+void _TimerMux::setLED(uint8_t id, uint8_t duty)
+{
+    // Fully off and fully on don't need the timer at all.
+    if (duty == 0 || duty == 255) {
+        _stopChannel(id, duty == 255);
+        return;
+    }
+    const uint16_t periodTicks = LED_PWM_PERIOD_US / TICK_US;
+    uint16_t highTicks = (uint32_t)periodTicks * duty / 255;
+    if (highTicks == 0) {
+        highTicks = 1;
+    }
+    _setChannel(id, highTicks, periodTicks - highTicks);
+}
+
+// --- Periodic Tick ---
+void _TimerMux::setTickHandler(void (*handler)())
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _tickHandler = handler;
+    }
+    if (handler) {
+        // A 1 ms square wave with no pin; the handler runs on every rising edge.
+        const uint16_t halfTicks = 500 / TICK_US;
+        _setChannel(DL_MUX_TICK, halfTicks, halfTicks);
+    } else {
+        _stopChannel(DL_MUX_TICK, false);
+    }
+}
+
+// --- Interrupt ---
+// Every active channel counts down by the time that has passed since the last interrupt.
+// Channels that reach zero flip their pin and load their next HIGH or LOW time.
+// Then the timer is set to wake us at the nearest upcoming edge.
+void _TimerMux::handleInterrupt()
+{
+    uint16_t elapsed = _lastInterval;
+    uint16_t next = MAX_INTERVAL_TICKS;
+    bool tick = false;
+
+    for (uint8_t id = 0; id < DL_MUX_CHANNEL_COUNT; id++) {
+        Channel& ch = _channels[id];
+        if (!ch.active) {
+            continue;
+        }
+        if (ch.remaining > elapsed) {
+            ch.remaining -= elapsed;
+        } else {
+            // If we woke up late, take the lateness off the next period so the
+            // average frequency stays right.
+            uint16_t late = elapsed - ch.remaining;
+            ch.level = !ch.level;
+            ch.pin.write(ch.level);
+            uint16_t period = ch.level ? ch.highTicks : ch.lowTicks;
+            ch.remaining = (period > late) ? period - late : 1;
+            if (id == DL_MUX_TICK && ch.level) {
+                tick = true;
+            }
+        }
+        if (ch.remaining < next) {
+            next = ch.remaining;
+        }
+    }
+
+    // The counter kept running while we worked. Never ask for a compare value it has
+    // already passed, or we would wait for a full wrap-around.
+    uint8_t now = TCNT2;
+    if (next < (uint16_t)now + 3) {
+        next = now + 3;
+    }
+    if (next > 256) {
+        next = 256;
+    }
+    OCR2A = next - 1;
+    _lastInterval = next;
+
+    // The handler runs with interrupts on, so a slow one (button sampling) doesn't hold up the
+    // next edges. The compare is already set, and _inTick keeps the handler from nesting.
+    if (tick && _tickHandler && !_inTick) {
+        _inTick = true;
+        sei();
+        _tickHandler();
+        cli();
+        _inTick = false;
+    }
+}
+
+ISR(TIMER2_COMPA_vect)
+{
+    _theTimerMux.handleInterrupt();
+}
+
+#endif // DOORLOCK_USE_TIMER_MUX
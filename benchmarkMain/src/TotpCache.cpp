@@ -0,0 +1,210 @@
+#include "TotpCache.h"
+
+#if DOORLOCK_USE_TOTP
+
+#include <string.h>
+
+static const uint32_t SHA1_START[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+const unsigned long CLOCK_RETRY_MS = 1000; // How often to look again while the date isn't known
+
+static uint32_t _rotateLeft(uint32_t value, uint8_t bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// --- SHA-1, a few rounds at a time ---
+void _Sha1Block::begin(const uint32_t* state, const uint32_t* block)
+{
+    for (uint8_t i = 0; i < 5; i++) {
+        h[i] = v[i] = state[i];
+    }
+    for (uint8_t i = 0; i < 16; i++) {
+        w[i] = block[i];
+    }
+    round = 0;
+}
+
+bool _Sha1Block::run(uint8_t rounds)
+{
+    for (; rounds > 0 && round < 80; rounds--, round++) {
+        uint8_t t = round & 15;
+        if (round >= 16) {
+            w[t] = _rotateLeft(w[(round - 3) & 15] ^ w[(round - 8) & 15] ^ w[(round - 14) & 15] ^ w[t], 1);
+        }
+        uint32_t f;
+        uint32_t k;
+        if (round < 20) {
+            f = (v[1] & v[2]) | (~v[1] & v[3]);
+            k = 0x5A827999;
+        } else if (round < 40) {
+            f = v[1] ^ v[2] ^ v[3];
+            k = 0x6ED9EBA1;
+        } else if (round < 60) {
+            f = (v[1] & v[2]) | (v[1] & v[3]) | (v[2] & v[3]);
+            k = 0x8F1BBCDC;
+        } else {
+            f = v[1] ^ v[2] ^ v[3];
+            k = 0xCA62C1D6;
+        }
+        uint32_t temp = _rotateLeft(v[0], 5) + f + v[4] + k + w[t];
+        v[4] = v[3];
+        v[3] = v[2];
+        v[2] = _rotateLeft(v[1], 30);
+        v[1] = v[0];
+        v[0] = temp;
+    }
+    if (round < 80) {
+        return false;
+    }
+    for (uint8_t i = 0; i < 5; i++) {
+        h[i] += v[i];
+    }
+    return true;
+}
+
+// --- Cache ---
+// Picks the next code to work out: for each secret the current step first, then the next and
+// the previous one.
+bool _TotpCache::_startNext()
+{
+    if (!_stepKnown) {
+        return false;
+    }
+    static const int8_t ORDER[DL_TOTP_WINDOWS] = {0, 1, -1};
+    for (uint8_t s = 0; s < DOORLOCK_TOTP_SECRETS; s++) {
+        Secret& secret = _secrets[s];
+        if (!secret.set) {
+            continue;
+        }
+        for (uint8_t i = 0; i < DL_TOTP_WINDOWS; i++) {
+            uint32_t counter = _step + ORDER[i];
+            uint8_t slot = counter % DL_TOTP_WINDOWS;
+            if ((secret.ready & (1 << slot)) && secret.counters[slot] == counter) {
+                continue;
+            }
+            // Inner hash: the 8 byte counter, then SHA-1 padding for 64 + 8 bytes
+            uint32_t block[16] = {0, counter, 0x80000000};
+            block[15] = (64 + 8) * 8;
+            _sha.begin(secret.inner, block);
+            secret.ready &= ~(1 << slot);
+            _jobSecret = s;
+            _jobCounter = counter;
+            _outerBlock = false;
+            _busy = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The outer hash is done: truncate it to a keypad code (RFC 4226 dynamic truncation).
+void _TotpCache::_finish()
+{
+    uint8_t digest[20];
+    for (uint8_t i = 0; i < 20; i++) {
+        digest[i] = _sha.h[i / 4] >> (24 - 8 * (i % 4));
+    }
+    uint8_t offset = digest[19] & 0x0F;
+    uint32_t number = ((uint32_t)(digest[offset] & 0x7F) << 24) | ((uint32_t)digest[offset + 1] << 16) |
+                      ((uint32_t)digest[offset + 2] << 8) | digest[offset + 3];
+    uint32_t modulus = 1;
+    for (uint8_t i = 0; i < DOORLOCK_TOTP_DIGITS; i++) {
+        modulus *= 3;
+    }
+    Secret& secret = _secrets[_jobSecret];
+    uint8_t slot = _jobCounter % DL_TOTP_WINDOWS;
+    secret.counters[slot] = _jobCounter;
+    secret.codes[slot] = number % modulus;
+    secret.ready |= 1 << slot;
+    _busy = false;
+}
+
+void _TotpCache::poll(unsigned long now, const _LockClock& clock)
+{
+    if ((long)(now - _nextStepMs) >= 0) {
+        uint32_t seconds;
+        _stepKnown = clock.unixTime(now, &seconds);
+        _pending = true;
+        if (_stepKnown) {
+            _step = seconds / DL_TOTP_STEP_SECONDS;
+            _nextStepMs = now + (DL_TOTP_STEP_SECONDS - seconds % DL_TOTP_STEP_SECONDS) * 1000UL;
+        } else {
+            _nextStepMs = now + CLOCK_RETRY_MS;
+        }
+    }
+    if (!_busy && !_startNext()) {
+        _pending = false; // Every code is there until the step or a secret changes
+        return;
+    }
+    if (!_sha.run(DL_TOTP_ROUNDS_PER_TICK)) {
+        return;
+    }
+    if (_outerBlock) {
+        _finish();
+        return;
+    }
+    // Outer hash: the 20 byte inner hash, then SHA-1 padding for 64 + 20 bytes
+    uint32_t block[16] = {_sha.h[0], _sha.h[1], _sha.h[2], _sha.h[3], _sha.h[4], 0x80000000};
+    block[15] = (64 + 20) * 8;
+    _sha.begin(_secrets[_jobSecret].outer, block);
+    _outerBlock = true;
+}
+
+bool _TotpCache::setSecret(uint8_t slot, const uint8_t* key, uint8_t length)
+{
+    if (slot >= DOORLOCK_TOTP_SECRETS || length > DL_TOTP_MAX_KEY) {
+        return false;
+    }
+    clearSecret(slot);
+    Secret& secret = _secrets[slot];
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        uint8_t pad = pass == 0 ? 0x36 : 0x5C;
+        uint32_t block[16] = {};
+        for (uint8_t i = 0; i < 64; i++) {
+            uint8_t byte = (i < length ? key[i] : 0) ^ pad;
+            block[i / 4] = (block[i / 4] << 8) | byte;
+        }
+        _sha.begin(SHA1_START, block);
+        _sha.run(80);
+        memcpy(pass == 0 ? secret.inner : secret.outer, _sha.h, sizeof(secret.inner));
+    }
+    secret.set = true;
+    _pending = true;
+    return true;
+}
+
+void _TotpCache::clearSecret(uint8_t slot)
+{
+    if (slot >= DOORLOCK_TOTP_SECRETS) {
+        return;
+    }
+    _secrets[slot] = Secret();
+    _busy = false; // Whatever was being worked out starts over
+    _pending = true;
+}
+
+// No early exit: every cached code of every secret is compared, whatever was typed.
+bool _TotpCache::matches(const int* digits, uint8_t length)
+{
+    uint16_t typed = 0;
+    uint8_t invalid = length != DOORLOCK_TOTP_DIGITS || !_stepKnown;
+    for (uint8_t i = 0; i < DOORLOCK_TOTP_DIGITS; i++) {
+        uint8_t digit = i < length ? digits[i] - 1 : 0;
+        invalid |= digit > 2;
+        typed = typed * 3 + digit;
+    }
+    uint8_t found = 0;
+    for (uint8_t s = 0; s < DOORLOCK_TOTP_SECRETS; s++) {
+        Secret& secret = _secrets[s];
+        for (uint8_t slot = 0; slot < DL_TOTP_WINDOWS; slot++) {
+            uint32_t counter = secret.counters[slot];
+            uint8_t match = secret.set & ((secret.ready >> slot) & 1) & (counter - (_step - 1) < DL_TOTP_WINDOWS) &
+                            (counter > secret.lastUsed) & (secret.codes[slot] == typed) & !invalid;
+            secret.lastUsed = match ? counter : secret.lastUsed;
+            found |= match;
+        }
+    }
+    return found;
+}
+
+#endif // DOORLOCK_USE_TOTP
@@ -17,39 +17,62 @@ using namespace DoorLock;
   setCorrectCode(array, 3);
 } */
 
+// This setup method is an example of how to lock the door again by itself 10 seconds after it opens,
+// and forget a half-typed code when nobody presses a button for 5 seconds.
+// With no relock function of its own, the door runs the lock() task below.
+/* void setup() {
+  start();
+  setLockActions(unlock, lock, incorrect);
+  setAutoRelock(10, nullptr);
+  setEntryTimeout(5000, nullptr);
+} */
+
+DL_TASK(unlock);
+DL_TASK(lock);
+DL_TASK(incorrect);
+
 void setup() {
   start();
+  setLockActions(unlock, lock, incorrect); // What the door does when it unlocks, locks or gets a wrong code
 }
 
-void unlock() {
-  locked = false;
+// unlock(), lock() and incorrect() are tasks (see src/DoorLockTask.h).
+// They use DL_WAIT_MS() instead of delay(), so the buttons keep working while they wait.
+// The door lock keeps `locked` up to date by itself, so the tasks don't have to.
+// They reset the attempt before waiting, so digits typed during the wait aren't thrown away.
+DL_TASK(unlock) {
+  DL_TASK_BEGIN();
   open(); // This turns the servo to open
   greenLEDToggle(true); // Turn on the green LED
   buzzerOn(2000); // Turn on the buzzer at 2000Hz
-  delay(500); // Wait for 500ms
+  resetAttempt(); // Reset the attempt array that holds the previous entered code.
+  DL_WAIT_MS(500); // Wait for 500ms
   buzzerOff(); // Turn off the buzzer
   greenLEDToggle(false); // Turn off the green LED
-  resetAttempt(); // Reset the attempt array that holds the previous entered code.
+  DL_TASK_END();
 }
 
-void lock() {
-  locked = true;
+DL_TASK(lock) {
+  DL_TASK_BEGIN();
   close(); // This turns the servo to close
   redLEDToggle(true); // Turn on the red LED
   buzzerOn(500); // Turn on the buzzer at 500Hz
-  delay(2000); // Wait for 2000ms
+  resetAttempt(); // Reset the attempt array that holds the previous entered code.
+  DL_WAIT_MS(2000); // Wait for 2000ms
   buzzerOff(); // Turn off the buzzer
   redLEDToggle(false); // Turn off the red LED
-  resetAttempt(); // Reset the attempt array that holds the previous entered code.
+  DL_TASK_END();
 }
 
-void incorrect() {
+DL_TASK(incorrect) {
+  DL_TASK_BEGIN();
   redLEDToggle(true); // Turn on the red LED
   buzzerOn(2000); // Turn on the buzzer at 2000Hz
-  delay(1000); // Wait for 1000ms
+  resetAttempt(); // Reset the attempt array that holds the previous entered code.
+  DL_WAIT_MS(1000); // Wait for 1000ms
   buzzerOff(); // Turn off the buzzer
   redLEDToggle(false); // Turn off the red LED
-  resetAttempt(); // Reset the attempt array that holds the previous entered code.
+  DL_TASK_END();
 }
 
 
@@ -71,16 +94,10 @@ void loop() {
     button3Pressed();
   }
 
-  // Check if the lock button is pressed, if it is, check if the door is locked or unlocked
+  // Check if the lock button is pressed, if it is, let the door lock decide what to do:
   // if the door is unlocked, Lock it.
   // if the door is locked, check if the attempt is correct, if it is, unlock the door, otherwise do the incorrect action.
   if(isLockButtonPressed()) {
-    if (!locked) {
-      lock();
-    } else if(isAttemptCorrect()) {
-      unlock();
-    } else if(locked) {
-      incorrect();
-    }
+    lockButtonPressed();
   }
 }
\ No newline at end of file
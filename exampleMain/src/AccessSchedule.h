@@ -0,0 +1,55 @@
+#ifndef ARDUINO_DOORLOCK_ACCESSSCHEDULE_H
+#define ARDUINO_DOORLOCK_ACCESSSCHEDULE_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+#include "LockClock.h"
+
+// --- Access Schedules ---
+// Each user can be limited to certain times of the week. The week is cut into 7 x 96 slots of
+// 15 minutes, and every user has one bit per slot (84 bytes) saying whether they may come in
+// then. The bits live in EEPROM right after the fast boot bytes, so:
+//   - checking a user is one EEPROM byte read and one bit test, with the current slot already
+//     worked out by _LockClock (LockClock.h)
+//   - changing a window only rewrites the bytes that cover it (EEPROM.update() skips bytes
+//     that stay the same), and nothing has to be rebuilt at start()
+//
+// User 0 is the keypad code. With the RFID reader, card number n in the card table is user n + 1.
+// A user without a schedule (the default, and anybody past DOORLOCK_SCHEDULE_USERS) may come in
+// at any time, like before. A user with a schedule is kept out while the time isn't known.
+
+const uint8_t DL_SCHEDULE_DAYS = 7;                  // Day 0 is Monday, day 6 is Sunday
+const uint8_t DL_SCHEDULE_SLOTS_PER_DAY = DL_CLOCK_SLOTS_PER_DAY;
+const uint16_t DL_SCHEDULE_SLOTS = DL_SCHEDULE_DAYS * DL_SCHEDULE_SLOTS_PER_DAY;
+const uint8_t DL_SCHEDULE_BYTES = DL_SCHEDULE_SLOTS / 8; // Bitmap of one user
+const uint8_t DL_SCHEDULE_EVERY_DAY = 0x7F;          // Day mask with all 7 days
+
+static_assert(DOORLOCK_SCHEDULE_USERS >= 1 && DOORLOCK_SCHEDULE_USERS <= 8,
+              "DOORLOCK_SCHEDULE_USERS must be 1 to 8");
+#if defined(E2END)
+static_assert(DOORLOCK_EEPROM_ADDRESS + 2 + DOORLOCK_SCHEDULE_USERS * (1 + DL_SCHEDULE_BYTES) <= E2END + 1,
+              "The access schedules don't fit in this board's EEPROM");
+#endif
+
+class _AccessSchedule
+{
+private:
+    uint8_t _restricted = 0; // Bit n: user n has a schedule (a copy of the flags in EEPROM)
+
+public:
+    // Loads which users have a schedule. Call once from start().
+    void begin();
+
+    // True if `user` may come in during `slot` (from _LockClock::slot()).
+    bool allows(uint8_t user, uint16_t slot) const;
+
+    // Lets `user` in (or keeps them out) on the days in `days` (bit 0 = Monday) from slot
+    // `firstSlot` of the day (0-95) for `count` slots. The first window given to a user without
+    // a schedule starts them off with no access at all. Returns false for bad arguments.
+    bool setWindow(uint8_t user, uint8_t days, uint8_t firstSlot, uint8_t count, bool allowed);
+
+    // Removes a user's schedule: they may come in at any time again.
+    void clear(uint8_t user);
+};
+
+#endif // ARDUINO_DOORLOCK_ACCESSSCHEDULE_H
@@ -0,0 +1,56 @@
+#ifndef ARDUINO_DOORLOCK_AUDITLOG_H
+#define ARDUINO_DOORLOCK_AUDITLOG_H
+
+#include <Arduino.h>
+
+// --- Internal Audit Log ---
+// Remembers the last few things that happened to the lock, with the millis() time of each.
+// It can be read back over the Serial command channel (see SerialFrame.h).
+
+enum DoorLockAuditEvent : uint8_t {
+    DL_AUDIT_BOOT = 1,
+    DL_AUDIT_UNLOCK,
+    DL_AUDIT_LOCK,
+    DL_AUDIT_INCORRECT,
+    DL_AUDIT_CODE_CHANGED,
+    DL_AUDIT_REMOTE_UNLOCK,
+    DL_AUDIT_REMOTE_LOCK,
+    DL_AUDIT_BADGE,         // An RFID badge was read (any unlock or incorrect entry comes next)
+    DL_AUDIT_ONE_TIME_CODE, // A one-time code was accepted (the unlock comes next)
+    DL_AUDIT_JAM            // The servo got stuck on every try (see ServoSense.h)
+};
+
+struct _AuditEntry {
+    uint8_t event; // DoorLockAuditEvent
+    uint32_t ms;   // millis() when it happened
+};
+
+class _AuditLog
+{
+private:
+    static const uint8_t SIZE = 16;
+    _AuditEntry _entries[SIZE];
+    uint8_t _next = 0;  // Slot the next entry goes into
+    uint8_t _count = 0; // Entries stored (at most SIZE)
+
+public:
+    void record(uint8_t event)
+    {
+        _entries[_next].event = event;
+        _entries[_next].ms = millis();
+        _next = (_next + 1) % SIZE;
+        if (_count < SIZE) {
+            _count++;
+        }
+    }
+
+    uint8_t size() const { return _count; }
+
+    // index 0 is the oldest entry still stored
+    const _AuditEntry& get(uint8_t index) const
+    {
+        return _entries[(_next + SIZE - _count + index) % SIZE];
+    }
+};
+
+#endif // ARDUINO_DOORLOCK_AUDITLOG_H
@@ -0,0 +1,308 @@
+#ifndef ARDUINO_DOORLOCK_CONFIG_H
+#define ARDUINO_DOORLOCK_CONFIG_H
+
+// --- DoorLock Library Build Options ---
+// Change a 0 to a 1 (or the other way around) to turn a library feature on or off.
+// Each option can also be set from the compiler command line, e.g. -DDOORLOCK_USE_TIMER_MUX=1
+
+// Drive the servo, the buzzer and LED dimming from ONE hardware timer (Timer2) instead of
+// using the Servo library (Timer1) and tone() (Timer2). Frees Timer1 and the PWM on pins 9 and 10.
+// Don't call tone() or use the Servo library yourself while this is on. AVR boards only.
+#ifndef DOORLOCK_USE_TIMER_MUX
+#define DOORLOCK_USE_TIMER_MUX 0
+#endif
+
+// Use pin-change interrupts on the button pins. scanButtons() then skips reading the pins
+// when nothing has changed, and idleUntilEvent() can put the CPU to sleep between events.
+// Don't use this together with SoftwareSerial, which needs the same interrupts. AVR boards only.
+#ifndef DOORLOCK_USE_EDGE_EVENTS
+#define DOORLOCK_USE_EDGE_EVENTS 0
+#endif
+
+// Run on a Linux board instead of an Arduino (LinuxGpio.h): the pins in setPins() are lines of the
+// GPIO chip below, button edges come from the kernel (no polling, and idleUntilEvent() sleeps in
+// epoll_wait()), and the servo and buzzer are channels of a sysfs PWM chip. Linux builds only.
+#ifndef DOORLOCK_USE_LINUX_GPIO
+#define DOORLOCK_USE_LINUX_GPIO 0
+#endif
+
+// The GPIO character device the buttons and LEDs are on
+#ifndef DOORLOCK_LINUX_GPIO_CHIP
+#define DOORLOCK_LINUX_GPIO_CHIP "/dev/gpiochip0"
+#endif
+
+// Debounce the kernel applies to the button lines before reporting an edge (0 = none). The
+// library's own settle window still runs on top of it.
+#ifndef DOORLOCK_LINUX_DEBOUNCE_US
+#define DOORLOCK_LINUX_DEBOUNCE_US 5000
+#endif
+
+// The sysfs PWM chip, and its channels for the servo and the buzzer
+#ifndef DOORLOCK_LINUX_PWM_CHIP
+#define DOORLOCK_LINUX_PWM_CHIP "/sys/class/pwm/pwmchip0"
+#endif
+#ifndef DOORLOCK_LINUX_SERVO_PWM
+#define DOORLOCK_LINUX_SERVO_PWM 0
+#endif
+#ifndef DOORLOCK_LINUX_BUZZER_PWM
+#define DOORLOCK_LINUX_BUZZER_PWM 1
+#endif
+
+// Longest idleUntilEvent() sleeps while nothing is going on (milliseconds). Button edges and
+// anything the library is timing wake it sooner; polled inputs such as Serial wait up to this long.
+#ifndef DOORLOCK_LINUX_IDLE_MS
+#define DOORLOCK_LINUX_IDLE_MS 100
+#endif
+
+// Fast boot: start() gets the buttons working first and doesn't move the servo. Whether the
+// door was locked or unlocked is read back from EEPROM (saved on every lock/unlock), the servo is
+// attached the first time it has to move, and Serial is started by the first message.
+// If your sketch prints to Serial itself, call Serial.begin(115200) in setup().
+#ifndef DOORLOCK_FAST_BOOT
+#define DOORLOCK_FAST_BOOT 0
+#endif
+
+// First EEPROM address the library may use (it uses 2 bytes from here for fast boot).
+// With fast boot the second byte is rewritten on every unlock and every lock. An ATmega328P's
+// EEPROM is rated for 100,000 writes per byte, so that is 50,000 unlock/lock cycles: about 7 years
+// at 20 a day, under 3 years at 50. On a door used more than that, move this address to fresh
+// bytes every few years (schedules move with it and have to be set again).
+#ifndef DOORLOCK_EEPROM_ADDRESS
+#define DOORLOCK_EEPROM_ADDRESS 0
+#endif
+
+// An MFRC522 RFID/NFC badge reader on the SPI bus (RfidReader.h), chip select on
+// DOORLOCK_RFID_SS_PIN. A badge from the card table unlocks the door like the right code, any
+// other badge counts as a wrong code. Make the card table with tools/rfid_table.py.
+// SPI uses pins 11, 12 and 13, so move the buzzer off pin 12 with setPins().
+#ifndef DOORLOCK_USE_RFID
+#define DOORLOCK_USE_RFID 0
+#endif
+
+// The card table the RFID reader checks badges against (written by tools/rfid_table.py).
+#ifndef DOORLOCK_RFID_CARDS
+#define DOORLOCK_RFID_CARDS "RfidCards.h"
+#endif
+
+// An MCP23017 I2C port expander for the buttons and LEDs (PortExpander.h). Give them pins
+// DL_EXPANDER_PIN (100) to 115 in setPins(). I2C uses A4 and A5, and the expander's INT output
+// goes to DOORLOCK_EXPANDER_INT_PIN, so move button 3 off pin 2 (or pick another INT pin).
+#ifndef DOORLOCK_USE_EXPANDER
+#define DOORLOCK_USE_EXPANDER 0
+#endif
+
+// The expander's I2C address (0x20 with A0-A2 tied to GND) and the Arduino pin its INTA is on.
+#ifndef DOORLOCK_EXPANDER_ADDRESS
+#define DOORLOCK_EXPANDER_ADDRESS 0x20
+#endif
+
+#ifndef DOORLOCK_EXPANDER_INT_PIN
+#define DOORLOCK_EXPANDER_INT_PIN 2
+#endif
+
+// Longest secret code the library can store (1-32 key presses). Each extra digit costs 6 bytes of
+// RAM. setCorrectCode() and stageCorrectCode() refuse a longer code and keep the current one.
+#ifndef DOORLOCK_MAX_CODE_LENGTH
+#define DOORLOCK_MAX_CODE_LENGTH 8
+#endif
+
+// Time-of-day access schedules (AccessSchedule.h): the keypad code and each badge can be limited
+// to certain 15 minute slots of the week with setAccessWindow(). Uses EEPROM after the fast boot
+// bytes: 85 bytes per user.
+#ifndef DOORLOCK_USE_SCHEDULES
+#define DOORLOCK_USE_SCHEDULES 0
+#endif
+
+// How many users can have a schedule (1-8). User 0 is the keypad code, user n + 1 is card n of
+// the RFID card table.
+#ifndef DOORLOCK_SCHEDULE_USERS
+#define DOORLOCK_SCHEDULE_USERS 4
+#endif
+
+// One-time keypad codes for visitors (TotpCache.h): codes that change every 30 seconds, like an
+// authenticator app shows, from up to DOORLOCK_TOTP_SECRETS secrets set with setOneTimeSecret().
+// Needs the date and time (setDateTime() or a DS3231).
+#ifndef DOORLOCK_USE_TOTP
+#define DOORLOCK_USE_TOTP 0
+#endif
+
+#ifndef DOORLOCK_TOTP_SECRETS
+#define DOORLOCK_TOTP_SECRETS 2
+#endif
+
+// Keypad digits in a one-time code (at most DOORLOCK_MAX_CODE_LENGTH). 8 digits of 1-3 give
+// 6561 different codes.
+#ifndef DOORLOCK_TOTP_DIGITS
+#define DOORLOCK_TOTP_DIGITS 8
+#endif
+
+// Where the schedules and one-time codes get the time from: a DS3231 real-time clock on I2C
+// (A4/A5, address 0x68) that keeps the time while the Arduino is off. Off: setTime() and
+// setDateTime() start a clock that counts with millis() and forgets the time at every reset.
+#ifndef DOORLOCK_USE_DS3231
+#define DOORLOCK_USE_DS3231 0
+#endif
+
+// The clock runs on local time; one-time codes need UTC. Minutes east of UTC, e.g. 60 for CET.
+#ifndef DOORLOCK_UTC_OFFSET_MINUTES
+#define DOORLOCK_UTC_OFFSET_MINUTES 0
+#endif
+
+// A 128 x 32 or 128 x 64 SSD1306 OLED on I2C (A4/A5, StatusDisplay.h) that shows whether the door
+// is locked, a star for every digit typed and short messages. The screen is kept as text and
+// sent a few characters per scanButtons(), so it never holds the buttons up. Only the SSD1306 is
+// driven: an HD44780 character LCD would need a driver of its own for the same text, and there
+// isn't one yet.
+#ifndef DOORLOCK_USE_DISPLAY
+#define DOORLOCK_USE_DISPLAY 0
+#endif
+
+#ifndef DOORLOCK_DISPLAY_ADDRESS
+#define DOORLOCK_DISPLAY_ADDRESS 0x3C
+#endif
+
+// Pixel rows of the display: 32 or 64
+#ifndef DOORLOCK_DISPLAY_HEIGHT
+#define DOORLOCK_DISPLAY_HEIGHT 32
+#endif
+
+// Watch the servo's current through a shunt resistor (ServoSense.h). A move that still draws a
+// lot of current after it should have finished has stalled: the drive is cut and the move tried
+// again, and if that stalls too the lock reports a jam instead of claiming the door is unlocked.
+#ifndef DOORLOCK_USE_SERVO_SENSE
+#define DOORLOCK_USE_SERVO_SENSE 0
+#endif
+
+// Analog pin that reads the voltage across the shunt (A0-A7)
+#ifndef DOORLOCK_SERVO_SENSE_PIN
+#define DOORLOCK_SERVO_SENSE_PIN A0
+#endif
+
+// How long the servo takes to turn 180 degrees when nothing is in its way, bolt included
+#ifndef DOORLOCK_SERVO_TRAVEL_MS
+#define DOORLOCK_SERVO_TRAVEL_MS 600
+#endif
+
+// ADC reading (0-1023 for 0-5 V) above which the servo is still pushing. Pick it between what the
+// servo draws holding still and what it draws stalled: a small servo on a 1 ohm shunt holds at
+// about 10 (50 mA) and stalls at about 130 (650 mA).
+#ifndef DOORLOCK_SERVO_STALL_LEVEL
+#define DOORLOCK_SERVO_STALL_LEVEL 80
+#endif
+
+// How many times a stalled move is tried again before it counts as a jam
+#ifndef DOORLOCK_SERVO_RETRIES
+#define DOORLOCK_SERVO_RETRIES 1
+#endif
+
+// Count every new/delete so memoryStats() can report heap use when the library is built on a
+// computer (for tests and benchmarks). Replaces the global operator new/delete. AVR boards measure
+// memory directly and ignore this.
+#ifndef DOORLOCK_MEMORY_HOOKS
+#define DOORLOCK_MEMORY_HOOKS 0
+#endif
+
+// --- Feature Switches ---
+// Every feature below is on by default. Turning one off (0) removes its code and its variables
+// from the library, which matters on small boards. The functions stay, so sketches still compile,
+// but they do nothing (see each switch). tools/size_report.py shows what each one costs.
+
+// Text messages on the Serial Monitor ("Door unlocked.", the digits typed so far, ...).
+// With this and DOORLOCK_ENABLE_SERIAL_COMMANDS both off, start() doesn't call Serial.begin().
+#ifndef DOORLOCK_ENABLE_LOGGING
+#define DOORLOCK_ENABLE_LOGGING 1
+#endif
+
+// The binary Serial command channel and the audit log it reads (SerialFrame.h, AuditLog.h).
+// Off: enableSerialCommands() does nothing.
+#ifndef DOORLOCK_ENABLE_SERIAL_COMMANDS
+#define DOORLOCK_ENABLE_SERIAL_COMMANDS 1
+#endif
+
+// The buzzer. Off: buzzerOn() and buzzerOff() do nothing and tone() is never used.
+#ifndef DOORLOCK_ENABLE_BUZZER
+#define DOORLOCK_ENABLE_BUZZER 1
+#endif
+
+// The red and green LEDs. Off: the LED functions do nothing.
+#ifndef DOORLOCK_ENABLE_LEDS
+#define DOORLOCK_ENABLE_LEDS 1
+#endif
+
+// Button events: long press, repeat, double tap, chords (ButtonEvents.h).
+// Off: nextButtonEvent() always returns false. isButton1Pressed() and friends still work.
+#ifndef DOORLOCK_ENABLE_GESTURES
+#define DOORLOCK_ENABLE_GESTURES 1
+#endif
+
+// Tasks (DoorLockTask.h). Off: runTask() returns false and nothing runs.
+#ifndef DOORLOCK_ENABLE_TASKS
+#define DOORLOCK_ENABLE_TASKS 1
+#endif
+
+// Auto-relock and the code entry timeout. Off: setAutoRelock() and setEntryTimeout() do nothing.
+#ifndef DOORLOCK_ENABLE_TIMEOUTS
+#define DOORLOCK_ENABLE_TIMEOUTS 1
+#endif
+
+// Actuation latency measurements. Off: actuationLatency() returns 0.
+#ifndef DOORLOCK_ENABLE_LATENCY_STATS
+#define DOORLOCK_ENABLE_LATENCY_STATS 1
+#endif
+
+// RAM usage and the stack high-water mark (MemoryStats.h). Off: memoryStats() returns all zeros.
+#ifndef DOORLOCK_ENABLE_MEMORY_STATS
+#define DOORLOCK_ENABLE_MEMORY_STATS 1
+#endif
+
+// The loop-stall supervisor and the watchdog (Supervisor.h). Off: enableWatchdog() does nothing
+// and stallReport() returns all zeros.
+#ifndef DOORLOCK_ENABLE_SUPERVISOR
+#define DOORLOCK_ENABLE_SUPERVISOR 1
+#endif
+
+// Saving settings and state in EEPROM. Off: fast boot can't restore the lock state and always
+// starts locked.
+#ifndef DOORLOCK_ENABLE_EEPROM
+#define DOORLOCK_ENABLE_EEPROM 1
+#endif
+
+// Usage counters (Telemetry.h). Off: telemetry() returns all zeros.
+#ifndef DOORLOCK_ENABLE_TELEMETRY
+#define DOORLOCK_ENABLE_TELEMETRY 1
+#endif
+
+// Per-button settle windows learned from how long each switch bounces (AdaptiveDebounce.h).
+// Off: every button waits a fixed 50 ms and debounceReport() only fills in windowMs.
+#ifndef DOORLOCK_ENABLE_ADAPTIVE_DEBOUNCE
+#define DOORLOCK_ENABLE_ADAPTIVE_DEBOUNCE 1
+#endif
+
+#if DOORLOCK_USE_EDGE_EVENTS && !defined(__AVR__)
+#undef DOORLOCK_USE_EDGE_EVENTS
+#define DOORLOCK_USE_EDGE_EVENTS 0
+#endif
+
+#if DOORLOCK_USE_TIMER_MUX && !defined(__AVR__)
+#undef DOORLOCK_USE_TIMER_MUX
+#define DOORLOCK_USE_TIMER_MUX 0
+#endif
+
+#if DOORLOCK_USE_LINUX_GPIO && (defined(__AVR__) || !defined(__linux__))
+#undef DOORLOCK_USE_LINUX_GPIO
+#define DOORLOCK_USE_LINUX_GPIO 0
+#endif
+
+// The clock (LockClock.h) is built in when something needs it
+#define DOORLOCK_USE_CLOCK (DOORLOCK_USE_SCHEDULES || DOORLOCK_USE_TOTP)
+
+#if DOORLOCK_USE_SCHEDULES && !DOORLOCK_ENABLE_EEPROM
+#error "DOORLOCK_USE_SCHEDULES keeps the schedules in EEPROM and needs DOORLOCK_ENABLE_EEPROM"
+#endif
+
+#if DOORLOCK_MEMORY_HOOKS && defined(__AVR__)
+#undef DOORLOCK_MEMORY_HOOKS
+#define DOORLOCK_MEMORY_HOOKS 0
+#endif
+
+#endif // ARDUINO_DOORLOCK_CONFIG_H
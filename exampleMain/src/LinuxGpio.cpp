@@ -0,0 +1,296 @@
+#include "LinuxGpio.h"
+
+#if DOORLOCK_USE_LINUX_GPIO
+
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+_LinuxGpio _theLinuxGpio;
+
+// Servo timing, matching the defaults of the Arduino Servo library
+const uint32_t SERVO_MIN_PULSE_NS = 544000UL;  // Pulse width at 0 degrees
+const uint32_t SERVO_MAX_PULSE_NS = 2400000UL; // Pulse width at 180 degrees
+const uint32_t SERVO_PERIOD_NS = 20000000UL;   // One pulse every 20 ms
+
+const uint8_t PWM_SERVO = 0; // Slots in _pwmPeriodNs
+const uint8_t PWM_BUZZER = 1;
+
+static const char* const CONSUMER = "doorlock"; // Shown as the lines' user by gpioinfo
+
+// Private helper: opens the chip and the epoll set the first time a line is bound.
+bool _LinuxGpio::_begin()
+{
+    if (_chip >= 0) {
+        return true;
+    }
+    _chip = open(DOORLOCK_LINUX_GPIO_CHIP, O_RDWR | O_CLOEXEC);
+    if (_chip < 0) {
+        return false;
+    }
+    if (_epoll < 0) {
+        _epoll = epoll_create1(EPOLL_CLOEXEC);
+    }
+    return true;
+}
+
+// Private helper: (re)requests every bound button line in one request and reads their levels.
+// A line request can't grow, so binding another button replaces the old request.
+void _LinuxGpio::_requestInputs()
+{
+    if (_inputRequest >= 0) {
+        close(_inputRequest); // Also takes it out of the epoll set
+        _inputRequest = -1;
+    }
+    if (_inputCount == 0 || !_begin()) {
+        return;
+    }
+    struct gpio_v2_line_request request;
+    memset(&request, 0, sizeof(request));
+    memcpy(request.offsets, _inputLines, _inputCount * sizeof(_inputLines[0]));
+    request.num_lines = _inputCount;
+    strncpy(request.consumer, CONSUMER, sizeof(request.consumer) - 1);
+    request.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_BIAS_PULL_UP |
+                           GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    if (DOORLOCK_LINUX_DEBOUNCE_US > 0) {
+        request.config.num_attrs = 1;
+        request.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+        request.config.attrs[0].attr.debounce_period_us = DOORLOCK_LINUX_DEBOUNCE_US;
+        request.config.attrs[0].mask = (1ULL << _inputCount) - 1;
+    }
+    if (ioctl(_chip, GPIO_V2_GET_LINE_IOCTL, &request) < 0) {
+        // No debounce on this chip: the library's own debouncing still runs
+        request.config.num_attrs = 0;
+        if (ioctl(_chip, GPIO_V2_GET_LINE_IOCTL, &request) < 0) {
+            return;
+        }
+    }
+    _inputRequest = request.fd;
+    fcntl(_inputRequest, F_SETFL, fcntl(_inputRequest, F_GETFL) | O_NONBLOCK);
+
+    // Levels from now on come from the events; start from the lines as they are
+    struct gpio_v2_line_values values;
+    values.mask = (1ULL << _inputCount) - 1;
+    values.bits = 0xFF;
+    ioctl(_inputRequest, GPIO_V2_LINE_GET_VALUES_IOCTL, &values);
+    inputs = (uint8_t)values.bits | (uint8_t)~values.mask;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = _inputRequest;
+    epoll_ctl(_epoll, EPOLL_CTL_ADD, _inputRequest, &event);
+}
+
+// Private helper: (re)requests every bound LED line, driving each at its current level.
+void _LinuxGpio::_requestOutputs()
+{
+    if (_outputRequest >= 0) {
+        close(_outputRequest);
+        _outputRequest = -1;
+    }
+    if (_outputCount == 0 || !_begin()) {
+        return;
+    }
+    struct gpio_v2_line_request request;
+    memset(&request, 0, sizeof(request));
+    memcpy(request.offsets, _outputLines, _outputCount * sizeof(_outputLines[0]));
+    request.num_lines = _outputCount;
+    strncpy(request.consumer, CONSUMER, sizeof(request.consumer) - 1);
+    request.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+    request.config.num_attrs = 1; // Start at the right level, so a LED never flashes
+    request.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+    _written = outputs;
+    request.config.attrs[0].attr.values = _written;
+    request.config.attrs[0].mask = (1ULL << _outputCount) - 1;
+    if (ioctl(_chip, GPIO_V2_GET_LINE_IOCTL, &request) == 0) {
+        _outputRequest = request.fd;
+    }
+}
+
+// Private helper: applies the queued edge events to `inputs`.
+void _LinuxGpio::_readEvents()
+{
+    struct gpio_v2_line_event events[16];
+    ssize_t length;
+    while ((length = read(_inputRequest, events, sizeof(events))) > 0) {
+        for (size_t i = 0; i < (size_t)length / sizeof(events[0]); i++) {
+            for (uint8_t slot = 0; slot < _inputCount; slot++) {
+                if (_inputLines[slot] != events[i].offset) {
+                    continue;
+                }
+                if (events[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE) {
+                    inputs |= (1 << slot);
+                } else {
+                    inputs &= ~(1 << slot);
+                }
+            }
+        }
+    }
+}
+
+void _LinuxGpio::releaseLines()
+{
+    _inputCount = 0;
+    _outputCount = 0;
+    inputs = 0xFF;
+    outputs = 0;
+    _requestInputs();
+    _requestOutputs();
+}
+
+// Input with pull-up (released buttons read HIGH) and edge events.
+volatile uint8_t* _LinuxGpio::bindInput(int line, uint8_t* mask)
+{
+    uint8_t slot = 0;
+    while (slot < _inputCount && _inputLines[slot] != (uint32_t)line) {
+        slot++;
+    }
+    if (slot == DL_LINUX_GPIO_MAX_LINES) {
+        *mask = 0; // No room: reads as released
+        return &inputs;
+    }
+    if (slot == _inputCount) {
+        _inputLines[_inputCount++] = line;
+        _requestInputs();
+    }
+    *mask = 1 << slot;
+    return &inputs;
+}
+
+// Output, driven LOW to start with (like _FastPin::bindOutput()).
+volatile uint8_t* _LinuxGpio::bindOutput(int line, uint8_t* mask)
+{
+    uint8_t slot = 0;
+    while (slot < _outputCount && _outputLines[slot] != (uint32_t)line) {
+        slot++;
+    }
+    if (slot == DL_LINUX_GPIO_MAX_LINES) {
+        *mask = 0;
+        return &outputs;
+    }
+    outputs &= ~(1 << slot);
+    if (slot == _outputCount) {
+        _outputLines[_outputCount++] = line;
+    }
+    _requestOutputs();
+    *mask = 1 << slot;
+    return &outputs;
+}
+
+bool _LinuxGpio::update()
+{
+    uint8_t out = outputs;
+    if (out != _written && _outputRequest >= 0) {
+        struct gpio_v2_line_values values;
+        values.bits = out;
+        values.mask = (1ULL << _outputCount) - 1;
+        if (ioctl(_outputRequest, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) == 0) {
+            _written = out;
+        }
+    }
+    return _inputRequest >= 0 && wait(0);
+}
+
+bool _LinuxGpio::wait(unsigned long timeoutMs)
+{
+    if (_epoll < 0) {
+        _epoll = epoll_create1(EPOLL_CLOEXEC); // Nothing bound yet: just sleep
+    }
+    struct epoll_event event;
+    if (epoll_wait(_epoll, &event, 1, timeoutMs > 0x7FFFFFFFUL ? -1 : (int)timeoutMs) <= 0) {
+        return false;
+    }
+    _readEvents();
+    return true;
+}
+
+// --- PWM (sysfs) ---
+// Private helper: writes a number to a file of a PWM channel, e.g. "pwm0/period".
+static bool _pwmWrite(int channel, const char* file, uint32_t value)
+{
+    char path[128];
+    if (channel >= 0) {
+        snprintf(path, sizeof(path), "%s/pwm%d/%s", DOORLOCK_LINUX_PWM_CHIP, channel, file);
+    } else {
+        snprintf(path, sizeof(path), "%s/%s", DOORLOCK_LINUX_PWM_CHIP, file);
+    }
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char text[12];
+    int length = snprintf(text, sizeof(text), "%lu", (unsigned long)value);
+    bool ok = write(fd, text, length) == length;
+    close(fd);
+    return ok;
+}
+
+static int _pwmChannel(uint8_t slot)
+{
+    return slot == PWM_SERVO ? DOORLOCK_LINUX_SERVO_PWM : DOORLOCK_LINUX_BUZZER_PWM;
+}
+
+// Private helper: sets a channel's period and pulse width, exporting it the first time.
+void _LinuxGpio::_pwmSet(uint8_t slot, uint32_t periodNs, uint32_t dutyNs)
+{
+    int channel = _pwmChannel(slot);
+    if (_pwmPeriodNs[slot] == 0) {
+        _pwmWrite(-1, "export", channel); // Fails harmlessly if it is exported already
+    }
+    if (periodNs != _pwmPeriodNs[slot]) {
+        // The pulse may never be longer than the period, so shorten it first
+        _pwmWrite(channel, "duty_cycle", 0);
+        _pwmWrite(channel, "period", periodNs);
+        _pwmPeriodNs[slot] = periodNs;
+    }
+    _pwmWrite(channel, "duty_cycle", dutyNs);
+}
+
+void _LinuxGpio::_pwmEnable(uint8_t slot, bool enabled)
+{
+    _pwmWrite(_pwmChannel(slot), "enable", enabled ? 1 : 0);
+}
+
+// --- Servo ---
+// Pulses start with the first writeServo(), so the servo doesn't jump to some old angle first.
+void _LinuxGpio::attachServo() {}
+
+void _LinuxGpio::writeServo(int angle)
+{
+    if (angle < 0) {
+        angle = 0;
+    } else if (angle > 180) {
+        angle = 180;
+    }
+    _pwmSet(PWM_SERVO, SERVO_PERIOD_NS, SERVO_MIN_PULSE_NS + (SERVO_MAX_PULSE_NS - SERVO_MIN_PULSE_NS) / 180 * angle);
+    _pwmEnable(PWM_SERVO, true);
+}
+
+void _LinuxGpio::detachServo()
+{
+    _pwmEnable(PWM_SERVO, false);
+}
+
+// --- Buzzer ---
+void _LinuxGpio::buzzerOn(unsigned int hz)
+{
+    if (hz == 0) {
+        buzzerOff();
+        return;
+    }
+    uint32_t periodNs = 1000000000UL / hz;
+    _pwmSet(PWM_BUZZER, periodNs, periodNs / 2);
+    _pwmEnable(PWM_BUZZER, true);
+}
+
+void _LinuxGpio::buzzerOff()
+{
+    _pwmEnable(PWM_BUZZER, false);
+}
+
+#endif // DOORLOCK_USE_LINUX_GPIO
@@ -0,0 +1,103 @@
+#ifndef ARDUINO_DOORLOCK_LOCKSTATEMACHINE_H
+#define ARDUINO_DOORLOCK_LOCKSTATEMACHINE_H
+
+#include <Arduino.h>
+
+// --- Lock State Machine ---
+// What the door does is one table: for every state (locked / unlocked) and every event
+// (lock button pressed, remote lock command...) it says which action to run and what the
+// state is afterwards. lockEvent() looks the answer up in one step; there are no if/else
+// chains to get out of step with each other.
+//
+//   state     event                    action       next state
+//   LOCKED    lock button, right code  UNLOCK       UNLOCKED
+//   LOCKED    lock button              INCORRECT    LOCKED
+//   LOCKED    lock command             (nothing)    LOCKED
+//   LOCKED    unlock command           UNLOCK       UNLOCKED
+//   LOCKED    enrolled badge           UNLOCK       UNLOCKED
+//   LOCKED    unknown badge            INCORRECT    LOCKED
+//   UNLOCKED  lock button, right code  LOCK         LOCKED
+//   UNLOCKED  lock button              LOCK         LOCKED
+//   UNLOCKED  lock command             LOCK         LOCKED
+//   UNLOCKED  unlock command           (nothing)    UNLOCKED
+//   UNLOCKED  enrolled badge           (nothing)    UNLOCKED
+//   UNLOCKED  unknown badge            (nothing)    UNLOCKED
+//
+// The compiler checks the table: every state/event pair must be written out, in order, and
+// UNLOCK must lead to UNLOCKED, LOCK to LOCKED and the rest must stay where they are. The host
+// tests (lockstate/ in tools/host_bench/tests.cpp) then drive every pair through lockEvent() and
+// check that the servo ends up where `locked` says.
+
+enum DoorLockState : uint8_t {
+    DL_LOCK_STATE_UNLOCKED = 0,
+    DL_LOCK_STATE_LOCKED = 1,   // Same as `locked` being true
+    DL_LOCK_STATE_COUNT
+};
+
+enum DoorLockEvent : uint8_t {
+    DL_LOCK_EVENT_RIGHT_CODE = 0, // Lock button pressed and the typed code is right
+    DL_LOCK_EVENT_LOCK_BUTTON,    // Lock button pressed (any other code, or the door is open)
+    DL_LOCK_EVENT_LOCK,           // Lock command (Serial command, auto-relock)
+    DL_LOCK_EVENT_UNLOCK,         // Unlock command (Serial command)
+    DL_LOCK_EVENT_RIGHT_BADGE,    // Enrolled RFID badge read
+    DL_LOCK_EVENT_WRONG_BADGE,    // Unknown RFID badge read
+    DL_LOCK_EVENT_COUNT
+};
+
+enum DoorLockAction : uint8_t {
+    DL_LOCK_ACTION_NONE = 0,
+    DL_LOCK_ACTION_UNLOCK,
+    DL_LOCK_ACTION_LOCK,
+    DL_LOCK_ACTION_INCORRECT,
+    DL_LOCK_ACTION_COUNT
+};
+
+struct _LockTransition {
+    uint8_t state;  // Row and column of this entry; only used by the compile-time check
+    uint8_t event;
+    uint8_t action; // DoorLockAction to run
+    uint8_t next;   // DoorLockState afterwards
+};
+
+constexpr _LockTransition DL_LOCK_TABLE[DL_LOCK_STATE_COUNT][DL_LOCK_EVENT_COUNT] PROGMEM = {
+    {
+        {DL_LOCK_STATE_UNLOCKED, DL_LOCK_EVENT_RIGHT_CODE, DL_LOCK_ACTION_LOCK, DL_LOCK_STATE_LOCKED},
+        {DL_LOCK_STATE_UNLOCKED, DL_LOCK_EVENT_LOCK_BUTTON, DL_LOCK_ACTION_LOCK, DL_LOCK_STATE_LOCKED},
+        {DL_LOCK_STATE_UNLOCKED, DL_LOCK_EVENT_LOCK, DL_LOCK_ACTION_LOCK, DL_LOCK_STATE_LOCKED},
+        {DL_LOCK_STATE_UNLOCKED, DL_LOCK_EVENT_UNLOCK, DL_LOCK_ACTION_NONE, DL_LOCK_STATE_UNLOCKED},
+        {DL_LOCK_STATE_UNLOCKED, DL_LOCK_EVENT_RIGHT_BADGE, DL_LOCK_ACTION_NONE, DL_LOCK_STATE_UNLOCKED},
+        {DL_LOCK_STATE_UNLOCKED, DL_LOCK_EVENT_WRONG_BADGE, DL_LOCK_ACTION_NONE, DL_LOCK_STATE_UNLOCKED},
+    },
+    {
+        {DL_LOCK_STATE_LOCKED, DL_LOCK_EVENT_RIGHT_CODE, DL_LOCK_ACTION_UNLOCK, DL_LOCK_STATE_UNLOCKED},
+        {DL_LOCK_STATE_LOCKED, DL_LOCK_EVENT_LOCK_BUTTON, DL_LOCK_ACTION_INCORRECT, DL_LOCK_STATE_LOCKED},
+        {DL_LOCK_STATE_LOCKED, DL_LOCK_EVENT_LOCK, DL_LOCK_ACTION_NONE, DL_LOCK_STATE_LOCKED},
+        {DL_LOCK_STATE_LOCKED, DL_LOCK_EVENT_UNLOCK, DL_LOCK_ACTION_UNLOCK, DL_LOCK_STATE_UNLOCKED},
+        {DL_LOCK_STATE_LOCKED, DL_LOCK_EVENT_RIGHT_BADGE, DL_LOCK_ACTION_UNLOCK, DL_LOCK_STATE_UNLOCKED},
+        {DL_LOCK_STATE_LOCKED, DL_LOCK_EVENT_WRONG_BADGE, DL_LOCK_ACTION_INCORRECT, DL_LOCK_STATE_LOCKED},
+    },
+};
+
+// --- Compile-Time Check of the Table ---
+constexpr bool _lockTransitionValid(const _LockTransition& t, uint8_t state, uint8_t event)
+{
+    return t.state == state && t.event == event && t.action < DL_LOCK_ACTION_COUNT &&
+           t.next < DL_LOCK_STATE_COUNT &&
+           (t.action == DL_LOCK_ACTION_UNLOCK ? t.next == DL_LOCK_STATE_UNLOCKED
+            : t.action == DL_LOCK_ACTION_LOCK ? t.next == DL_LOCK_STATE_LOCKED
+                                              : t.next == state);
+}
+
+// Checks entry i and everything after it (C++11 constexpr functions can't loop)
+constexpr bool _lockTableValid(uint8_t i = 0)
+{
+    return i == DL_LOCK_STATE_COUNT * DL_LOCK_EVENT_COUNT ||
+           (_lockTransitionValid(DL_LOCK_TABLE[i / DL_LOCK_EVENT_COUNT][i % DL_LOCK_EVENT_COUNT],
+                                 i / DL_LOCK_EVENT_COUNT, i % DL_LOCK_EVENT_COUNT) &&
+            _lockTableValid(i + 1));
+}
+
+static_assert(_lockTableValid(), "DL_LOCK_TABLE: every state/event pair needs its own entry, in order, "
+                                 "and its action must agree with the next state");
+
+#endif // ARDUINO_DOORLOCK_LOCKSTATEMACHINE_H
@@ -0,0 +1,82 @@
+#ifndef ARDUINO_DOORLOCK_LOCKTIMERS_H
+#define ARDUINO_DOORLOCK_LOCKTIMERS_H
+
+#include <Arduino.h>
+
+// --- Internal One-Shot Timers ---
+// A handful of cancellable deadlines on the millis() clock (auto-relock, code entry timeout...).
+// The earliest deadline is cached, so the check done on every update is one subtraction and
+// one compare no matter how many timers are armed. Only when something is actually due are
+// the slots looked at.
+
+enum _LockTimerId : uint8_t {
+    DL_TIMER_RELOCK = 0, // Lock the door again after it has been open for a while
+    DL_TIMER_ENTRY,      // Forget a half-typed code after no key for a while
+    DL_TIMER_COUNT
+};
+
+class _LockTimers
+{
+private:
+    unsigned long _due[DL_TIMER_COUNT];
+    uint8_t _armed = 0;         // Bit per armed timer
+    unsigned long _nextDue = 0; // Earliest deadline of the armed timers
+
+    void _updateNextDue(unsigned long now)
+    {
+        bool first = true;
+        for (uint8_t id = 0; id < DL_TIMER_COUNT; id++) {
+            if ((_armed & (1 << id)) && (first || (long)(_due[id] - _nextDue) < 0)) {
+                _nextDue = _due[id];
+                first = false;
+            }
+        }
+        if (first) {
+            _nextDue = now;
+        }
+    }
+
+public:
+    // (Re)starts timer `id` so it expires `delayMs` from now.
+    void arm(uint8_t id, unsigned long now, unsigned long delayMs)
+    {
+        _due[id] = now + delayMs;
+        _armed |= (1 << id);
+        _updateNextDue(now);
+    }
+
+    void cancel(uint8_t id)
+    {
+        _armed &= ~(1 << id);
+    }
+
+    bool isArmed(uint8_t id) const { return _armed & (1 << id); }
+
+    // Milliseconds until timer `id` expires (0 if it isn't armed or is already due).
+    unsigned long remaining(uint8_t id, unsigned long now) const
+    {
+        if (!isArmed(id) || (long)(_due[id] - now) <= 0) {
+            return 0;
+        }
+        return _due[id] - now;
+    }
+
+    // Disarms and returns the bits of every timer that has expired. O(1) when nothing is due.
+    uint8_t expired(unsigned long now)
+    {
+        if (_armed == 0 || (long)(now - _nextDue) < 0) {
+            return 0;
+        }
+        uint8_t fired = 0;
+        for (uint8_t id = 0; id < DL_TIMER_COUNT; id++) {
+            if ((_armed & (1 << id)) && (long)(now - _due[id]) >= 0) {
+                fired |= (1 << id);
+            }
+        }
+        _armed &= ~fired;
+        _updateNextDue(now);
+        return fired;
+    }
+};
+
+#endif // ARDUINO_DOORLOCK_LOCKTIMERS_H
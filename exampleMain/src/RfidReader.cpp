@@ -0,0 +1,321 @@
+#include "RfidReader.h"
+#include "DoorLockConfig.h"
+
+#if DOORLOCK_USE_RFID
+
+#include <SPI.h>
+#include DOORLOCK_RFID_CARDS // The enrolled cards, made by tools/rfid_table.py
+
+// MFRC522 registers
+const uint8_t RC_COMMAND = 0x01;
+const uint8_t RC_COM_IRQ = 0x04;
+const uint8_t RC_ERROR = 0x06;
+const uint8_t RC_FIFO_DATA = 0x09;
+const uint8_t RC_FIFO_LEVEL = 0x0A;
+const uint8_t RC_BIT_FRAMING = 0x0D;
+const uint8_t RC_MODE = 0x11;
+const uint8_t RC_TX_CONTROL = 0x14;
+const uint8_t RC_TX_ASK = 0x15;
+const uint8_t RC_T_MODE = 0x2A;
+const uint8_t RC_T_PRESCALER = 0x2B;
+const uint8_t RC_T_RELOAD_HIGH = 0x2C;
+const uint8_t RC_T_RELOAD_LOW = 0x2D;
+
+// MFRC522 commands
+const uint8_t RC_IDLE = 0x00;
+const uint8_t RC_TRANSCEIVE = 0x0C;
+const uint8_t RC_SOFT_RESET = 0x0F;
+
+// Bits of RC_COM_IRQ and RC_ERROR
+const uint8_t RC_IRQ_RX_OR_IDLE = 0x30;
+const uint8_t RC_IRQ_TIMER = 0x01;
+const uint8_t RC_ERRORS = 0x1B; // Buffer overflow, collision, parity, protocol
+
+// ISO 14443A card commands
+const uint8_t PICC_REQA = 0x26;
+const uint8_t PICC_SELECT_CL1 = 0x93; // CL2 is 0x95, CL3 is 0x97
+const uint8_t PICC_HALT = 0x50;
+const uint8_t PICC_CASCADE_TAG = 0x88; // First UID byte when the UID continues on the next level
+const uint8_t SAK_UID_NOT_COMPLETE = 0x04;
+
+// How long the reader needs after a soft reset, and how long it may stay silent before it is reset
+const uint8_t RC_RESET_MS = 50;
+const uint8_t RC_STUCK_MS = 50;
+
+// Steps of poll(), one per call
+enum : uint8_t {
+    STEP_RESET = 0,
+    STEP_SETUP,
+    STEP_REQUEST,  // Is there a card?
+    STEP_WAIT_ATQA,
+    STEP_WAIT_UID, // One cascade level of the UID
+    STEP_WAIT_SAK, // Card selected at this level: is the UID complete?
+    STEP_WAIT_HALT
+};
+
+// ISO 14443A CRC_A, appended low byte first
+static void _appendCrc(uint8_t* data, uint8_t length)
+{
+    uint16_t crc = 0x6363;
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t ch = data[i] ^ (uint8_t)crc;
+        ch ^= ch << 4;
+        crc = (crc >> 8) ^ ((uint16_t)ch << 8) ^ ((uint16_t)ch << 3) ^ (ch >> 4);
+    }
+    data[length] = crc & 0xFF;
+    data[length + 1] = crc >> 8;
+}
+
+// --- SPI Access ---
+void _RfidReader::_select(bool selected)
+{
+    if (selected) {
+        SPI.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
+        _ss.write(false);
+    } else {
+        _ss.write(true);
+        SPI.endTransaction();
+    }
+}
+
+void _RfidReader::_writeRegister(uint8_t reg, uint8_t value)
+{
+    _select(true);
+    SPI.transfer(reg << 1);
+    SPI.transfer(value);
+    _select(false);
+}
+
+// Writes all bytes into the FIFO in one go (the address stays the same for every byte).
+void _RfidReader::_writeFifo(const uint8_t* data, uint8_t length)
+{
+    _select(true);
+    SPI.transfer(RC_FIFO_DATA << 1);
+    for (uint8_t i = 0; i < length; i++) {
+        SPI.transfer(data[i]);
+    }
+    _select(false);
+}
+
+uint8_t _RfidReader::_readRegister(uint8_t reg)
+{
+    _select(true);
+    SPI.transfer(0x80 | (reg << 1));
+    uint8_t value = SPI.transfer(0);
+    _select(false);
+    return value;
+}
+
+// Starts sending a frame to the card. The answer is picked up later by _answer().
+// lastBits: how many bits of the last byte to send (0 = all 8).
+void _RfidReader::_transceive(const uint8_t* data, uint8_t length, uint8_t lastBits)
+{
+    _writeRegister(RC_COMMAND, RC_IDLE);
+    _writeRegister(RC_COM_IRQ, 0x7F);    // Clear every interrupt flag
+    _writeRegister(RC_FIFO_LEVEL, 0x80); // Empty the FIFO
+    _writeFifo(data, length);
+    _writeRegister(RC_BIT_FRAMING, lastBits);
+    _writeRegister(RC_COMMAND, RC_TRANSCEIVE);
+    _writeRegister(RC_BIT_FRAMING, 0x80 | lastBits); // Start sending
+    _sentAt = millis();
+}
+
+// Returns how many bytes the card answered (copied into _frame), 0 if it didn't answer or the
+// answer was garbled, or -1 while the reader is still waiting for it.
+int8_t _RfidReader::_answer()
+{
+    uint8_t irq = _readRegister(RC_COM_IRQ);
+    if (irq & RC_IRQ_RX_OR_IDLE) {
+        if (_readRegister(RC_ERROR) & RC_ERRORS) {
+            return 0;
+        }
+        uint8_t length = _readRegister(RC_FIFO_LEVEL);
+        if (length > sizeof(_frame)) {
+            return 0;
+        }
+        for (uint8_t i = 0; i < length; i++) {
+            _frame[i] = _readRegister(RC_FIFO_DATA);
+        }
+        return length;
+    }
+    if (irq & RC_IRQ_TIMER) {
+        return 0; // No card answered in DL_RFID_ANSWER_TIMEOUT_MS
+    }
+    return -1;
+}
+
+// Asks for the part of the UID at the current cascade level.
+void _RfidReader::_sendAnticollision()
+{
+    uint8_t frame[2] = {(uint8_t)(PICC_SELECT_CL1 + 2 * _level), 0x20};
+    _transceive(frame, 2, 0);
+}
+
+void _RfidReader::_after(uint8_t step, unsigned long now, unsigned long delayMs)
+{
+    _step = step;
+    _due = now + delayMs;
+}
+
+// --- Reading Cards ---
+void _RfidReader::begin(int ssPin, unsigned long now)
+{
+    _ss.bindOutput(ssPin);
+    _ss.write(true); // Not selected
+    SPI.begin();
+    _after(STEP_RESET, now, 0);
+}
+
+bool _RfidReader::poll(unsigned long now)
+{
+    if (!due(now)) {
+        return false;
+    }
+
+    int8_t length = 0;
+    if (_step >= STEP_WAIT_ATQA) {
+        length = _answer();
+        if (length < 0) {
+            if (now - _sentAt > RC_STUCK_MS) {
+                _after(STEP_RESET, now, 0); // The reader stopped answering; start it again
+            } else {
+                _due = now + 1;
+            }
+            return false;
+        }
+    }
+
+    switch (_step) {
+    case STEP_RESET:
+        _writeRegister(RC_COMMAND, RC_SOFT_RESET);
+        _after(STEP_SETUP, now, RC_RESET_MS);
+        break;
+
+    case STEP_SETUP:
+        // The reader's timer gives up on a silent card: 13.56 MHz / (2 * 169 + 1) = 40 kHz,
+        // so DL_RFID_ANSWER_TIMEOUT_MS * 40 ticks
+        _writeRegister(RC_T_MODE, 0x80); // Start the timer when a frame has been sent
+        _writeRegister(RC_T_PRESCALER, 169);
+        _writeRegister(RC_T_RELOAD_HIGH, 0);
+        _writeRegister(RC_T_RELOAD_LOW, DL_RFID_ANSWER_TIMEOUT_MS * 40);
+        _writeRegister(RC_TX_ASK, 0x40); // 100% ASK modulation
+        _writeRegister(RC_MODE, 0x3D);   // CRC preset 0x6363 (ISO 14443A)
+        _writeRegister(RC_TX_CONTROL, _readRegister(RC_TX_CONTROL) | 0x03); // Antenna on
+        _after(STEP_REQUEST, now, 0);
+        break;
+
+    case STEP_REQUEST: {
+        uint8_t request = PICC_REQA;
+        _transceive(&request, 1, 7); // REQA is a short frame of 7 bits
+        _after(STEP_WAIT_ATQA, now, 1);
+        break;
+    }
+
+    case STEP_WAIT_ATQA:
+        if (length != 2) {
+            _after(STEP_REQUEST, now, DL_RFID_POLL_MS); // No card
+            break;
+        }
+        _level = 0;
+        _readingLength = 0;
+        _sendAnticollision();
+        _after(STEP_WAIT_UID, now, 1);
+        break;
+
+    case STEP_WAIT_UID: {
+        // 4 UID bytes and their check byte (BCC, all 4 XORed)
+        if (length != 5 || (_frame[0] ^ _frame[1] ^ _frame[2] ^ _frame[3]) != _frame[4]) {
+            _after(STEP_REQUEST, now, DL_RFID_POLL_MS);
+            break;
+        }
+        uint8_t first = (_level < 2 && _frame[0] == PICC_CASCADE_TAG) ? 1 : 0;
+        if (_readingLength + 4 - first > DL_RFID_MAX_UID) {
+            _after(STEP_REQUEST, now, DL_RFID_POLL_MS); // Not a valid UID
+            break;
+        }
+        for (uint8_t i = first; i < 4; i++) {
+            _reading[_readingLength++] = _frame[i];
+        }
+        uint8_t select[9] = {(uint8_t)(PICC_SELECT_CL1 + 2 * _level), 0x70,
+                             _frame[0], _frame[1], _frame[2], _frame[3], _frame[4]};
+        _appendCrc(select, 7);
+        _transceive(select, sizeof(select), 0);
+        _after(STEP_WAIT_SAK, now, 1);
+        break;
+    }
+
+    case STEP_WAIT_SAK:
+        if (length != 3) {
+            _after(STEP_REQUEST, now, DL_RFID_POLL_MS);
+        } else if (_frame[0] & SAK_UID_NOT_COMPLETE) {
+            if (++_level > 2) {
+                _after(STEP_REQUEST, now, DL_RFID_POLL_MS);
+                break;
+            }
+            _sendAnticollision();
+            _after(STEP_WAIT_UID, now, 1);
+        } else {
+            // Got the whole UID. Halt the card so it isn't read again while it stays on the reader.
+            memcpy(_uid, _reading, _readingLength);
+            _uidLength = _readingLength;
+            uint8_t halt[4] = {PICC_HALT, 0x00};
+            _appendCrc(halt, 2);
+            _transceive(halt, sizeof(halt), 0);
+            _after(STEP_WAIT_HALT, now, 1);
+            return true;
+        }
+        break;
+
+    case STEP_WAIT_HALT:
+        // A halted card doesn't answer, so the timer running out is the normal ending
+        _after(STEP_REQUEST, now, DL_RFID_POLL_MS);
+        break;
+    }
+    return false;
+}
+
+// --- Card Table Lookup ---
+// RfidCards.h is a minimal perfect hash table: DL_RFID_CARD_COUNT slots for exactly that many
+// cards. The first hash of a UID picks a bucket, the bucket's seed from DL_RFID_SEEDS gives the
+// second hash, and that picks the only slot the card can be in. tools/rfid_table.py found seeds
+// that put every enrolled card in a slot of its own, so a lookup is two hashes and one compare.
+// The hash must match _hash() in tools/rfid_table.py.
+static uint32_t _rfidHash(uint16_t seed, const uint8_t* uid, uint8_t length)
+{
+    uint32_t hash = 2166136261UL ^ seed; // FNV-1a
+    for (uint8_t i = 0; i < length; i++) {
+        hash ^= uid[i];
+        hash *= 16777619UL;
+    }
+    hash ^= hash >> 16; // Mix the low bits into the high ones used by _rfidReduce()
+    hash *= 0x85EBCA6BUL;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+// Maps a hash onto 0 .. count-1 with a multiply instead of a (slow) division.
+static uint16_t _rfidReduce(uint32_t hash, uint16_t count)
+{
+    return ((uint32_t)(uint16_t)(hash >> 16) * count) >> 16;
+}
+
+int16_t _rfidCardNumber(const uint8_t* uid, uint8_t length)
+{
+    if (DL_RFID_CARD_COUNT == 0 || length > DL_RFID_UID_BYTES) {
+        return -1;
+    }
+    uint16_t bucket = _rfidReduce(_rfidHash(0, uid, length), DL_RFID_BUCKET_COUNT);
+    uint16_t seed = pgm_read_word(&DL_RFID_SEEDS[bucket]);
+    const uint8_t* card = DL_RFID_CARDS[_rfidReduce(_rfidHash(seed, uid, length), DL_RFID_CARD_COUNT)];
+    if (pgm_read_byte(card) != length) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        if (pgm_read_byte(card + 1 + i) != uid[i]) {
+            return -1;
+        }
+    }
+    return pgm_read_byte(card + 1 + DL_RFID_UID_BYTES) | (pgm_read_byte(card + 2 + DL_RFID_UID_BYTES) << 8);
+}
+
+#endif // DOORLOCK_USE_RFID
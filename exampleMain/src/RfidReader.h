@@ -0,0 +1,65 @@
+#ifndef ARDUINO_DOORLOCK_RFIDREADER_H
+#define ARDUINO_DOORLOCK_RFIDREADER_H
+
+#include <Arduino.h>
+#include "FastGpio.h"
+
+// --- RFID/NFC Card Reader (MFRC522) ---
+// Badges are read by an MFRC522 reader on the SPI bus. Reading a card takes several
+// messages to and from the card, and each one needs a few milliseconds. Instead of
+// waiting for the answers, the reader does one small step (a few SPI bytes) per
+// scanButtons() and then sleeps until its next step is due, so the buttons never wait:
+//
+//   1. every DL_RFID_POLL_MS ask "is there a card?" (REQA)
+//   2. read its UID, one cascade level (4, 7 or 10 byte UIDs) at a time, and select it
+//   3. tell the card to halt, so a badge held against the reader is only read once
+//
+// A read card is looked up in the table from RfidCards.h (made by tools/rfid_table.py), a
+// minimal perfect hash table in flash: two hashes and one compare, however many cards there are.
+
+const uint8_t DL_RFID_MAX_UID = 10;         // Longest card UID (triple size)
+const uint8_t DL_RFID_POLL_MS = 100;        // Time between "is there a card?" questions
+const uint8_t DL_RFID_ANSWER_TIMEOUT_MS = 5; // The reader gives up on a card after this long
+
+class _RfidReader
+{
+private:
+    _FastPin _ss;               // Chip select (active LOW)
+    uint8_t _step = 0;          // What poll() does next (see RfidReader.cpp)
+    unsigned long _due = 0;     // millis() when the next step may run
+    unsigned long _sentAt = 0;  // millis() when the reader was asked to talk to the card
+    uint8_t _level = 0;         // Cascade level of the UID being read (0-2)
+    uint8_t _reading[DL_RFID_MAX_UID]; // UID being read
+    uint8_t _readingLength = 0;
+    uint8_t _uid[DL_RFID_MAX_UID];     // Last card read
+    uint8_t _uidLength = 0;
+    uint8_t _frame[9];          // Last answer from the card
+
+    void _select(bool selected);
+    void _writeRegister(uint8_t reg, uint8_t value);
+    void _writeFifo(const uint8_t* data, uint8_t length);
+    uint8_t _readRegister(uint8_t reg);
+    void _transceive(const uint8_t* data, uint8_t length, uint8_t lastBits);
+    int8_t _answer();
+    void _sendAnticollision();
+    void _after(uint8_t step, unsigned long now, unsigned long delayMs);
+
+public:
+    // Starts SPI and resets the reader. Call once from start().
+    void begin(int ssPin, unsigned long now);
+
+    // True when poll() has something to do.
+    bool due(unsigned long now) const { return (long)(now - _due) >= 0; }
+
+    // Runs the next step if it is due. Returns true when a card has just been read (see uid()).
+    bool poll(unsigned long now);
+
+    const uint8_t* uid() const { return _uid; }
+    uint8_t uidLength() const { return _uidLength; }
+};
+
+// Looks a card up in the RfidCards.h table. Returns its number there (the position of the card
+// in the list given to tools/rfid_table.py), or -1 if it isn't enrolled.
+int16_t _rfidCardNumber(const uint8_t* uid, uint8_t length);
+
+#endif // ARDUINO_DOORLOCK_RFIDREADER_H
@@ -0,0 +1,101 @@
+#include "SerialFrame.h"
+#include "DoorLockConfig.h"
+
+#if DOORLOCK_ENABLE_SERIAL_COMMANDS
+
+// CRC-16/CCITT-FALSE: polynomial 0x1021, starting value 0xFFFF.
+uint16_t _crc16(const uint8_t* data, uint8_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+int _FrameParser::feed(uint8_t byte)
+{
+    if (byte == 0x00) {
+        // End of frame. The implied 0x00 after the last block is not part of the data.
+        int result = -1;
+        if (!_overflow && _blockLeft == 0 && _length >= 3) {
+            uint8_t payloadLength = _length - 2;
+            uint16_t crc = _buffer[payloadLength] | ((uint16_t)_buffer[payloadLength + 1] << 8);
+            if (crc == _crc16(_buffer, payloadLength)) {
+                result = payloadLength;
+            }
+        }
+        _length = 0;
+        _blockLeft = 0;
+        _zeroPending = false;
+        _overflow = false;
+        return result;
+    }
+
+    if (_overflow) {
+        return -1;
+    }
+
+    if (_blockLeft == 0) {
+        // This is a COBS code byte: the previous block ended with a 0x00 (unless it was a full
+        // 254-byte block), and the next (byte - 1) bytes are data.
+        if (_zeroPending) {
+            if (_length >= sizeof(_buffer)) {
+                _overflow = true;
+                return -1;
+            }
+            _buffer[_length++] = 0x00;
+        }
+        _blockLeft = byte - 1;
+        _zeroPending = (byte != 0xFF);
+        return -1;
+    }
+
+    if (_length >= sizeof(_buffer)) {
+        _overflow = true;
+        return -1;
+    }
+    _buffer[_length++] = byte;
+    _blockLeft--;
+    return -1;
+}
+
+// Private helper: writes bytes as COBS blocks. The payload and the CRC are encoded as one
+// continuous stream, so the pending block (`run`) carries over between the two calls.
+// Frames are far shorter than 254 bytes, so a block never has to be split for length.
+static void _cobsWrite(Print& out, const uint8_t* data, uint8_t length, uint8_t* run, uint8_t& runLength)
+{
+    for (uint8_t i = 0; i < length; i++) {
+        if (data[i] == 0x00) {
+            out.write((uint8_t)(runLength + 1));
+            out.write(run, runLength);
+            runLength = 0;
+        } else {
+            run[runLength++] = data[i];
+        }
+    }
+}
+
+void _writeFrame(Print& out, const uint8_t* payload, uint8_t length)
+{
+    if (length > DL_FRAME_MAX_PAYLOAD) {
+        return;
+    }
+    uint16_t crc = _crc16(payload, length);
+    uint8_t crcBytes[2] = {(uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)};
+
+    uint8_t run[DL_FRAME_MAX_PAYLOAD + 2];
+    uint8_t runLength = 0;
+
+    out.write((uint8_t)0x00); // Ends whatever text came before, so the reply starts clean
+    _cobsWrite(out, payload, length, run, runLength);
+    _cobsWrite(out, crcBytes, 2, run, runLength);
+    out.write((uint8_t)(runLength + 1));
+    out.write(run, runLength);
+    out.write((uint8_t)0x00);
+}
+
+#endif // DOORLOCK_ENABLE_SERIAL_COMMANDS
@@ -0,0 +1,70 @@
+#ifndef ARDUINO_DOORLOCK_SERIALFRAME_H
+#define ARDUINO_DOORLOCK_SERIALFRAME_H
+
+#include <Arduino.h>
+
+// --- Internal Binary Serial Framing ---
+// Commands and replies travel as COBS-encoded frames ending in a 0x00 byte:
+//
+//   COBS( payload bytes | CRC-16/CCITT-FALSE of the payload, low byte first ) 0x00
+//
+// COBS removes every 0x00 from the data, so 0x00 only ever marks the end of a frame and a
+// receiver that joins halfway through (or sees text from Serial.println) just drops one bad
+// frame and is back in sync. Replies are also sent with a 0x00 in front for the same reason.
+//
+// _FrameParser decodes one byte at a time, straight from Serial.read() into its frame buffer,
+// so it never holds more than one frame and never needs a String.
+
+const uint8_t DL_FRAME_MAX_PAYLOAD = 48; // Largest payload (without CRC) either side may send
+
+// Every command payload starts with [command, sequence number], followed by its arguments.
+// Every reply starts with [command | 0x80, same sequence number, status], followed by its data.
+// All multi-byte numbers are little-endian.
+enum DoorLockCommand : uint8_t {
+    DL_CMD_STATUS = 0x01, // -> locked, digits entered, code length, actuator busy, uptime ms (u32)
+    DL_CMD_ENROLL = 0x02, // length, digits... (each 1-3) -> (nothing)
+    DL_CMD_LOCK = 0x03,   // -> (nothing)
+    DL_CMD_UNLOCK = 0x04, // -> (nothing)
+    DL_CMD_STATS = 0x05,  // -> actuation latency p50 us (u32), p99 us (u32), audit entries (u8)
+    DL_CMD_AUDIT = 0x06,  // first entry -> entries stored, first entry, then up to 8 x (event, ms u32)
+    DL_CMD_MEMORY = 0x07, // -> .data, .bss, heap used, heap peak, allocations, free, largest free block,
+                          //    stack free minimum (all u32 bytes, see MemoryStats.h)
+    DL_CMD_TELEMETRY = 0x08, // [1 = reset after reading] -> counter snapshot (see Telemetry.h)
+    DL_CMD_SCHEDULE = 0x09,  // user, day mask, first slot (0-95), slot count, 0 = deny / 1 = allow /
+                             //    2 = remove the schedule -> (nothing) (DOORLOCK_USE_SCHEDULES)
+    DL_CMD_TIME = 0x0A       // [day (0 = Monday), hour, minute, second] or [year - 2000, month, day,
+                             //    hour, minute, second] -> slot of the week (u16, 0xFFFF while the
+                             //    time isn't known) (DOORLOCK_USE_SCHEDULES or DOORLOCK_USE_TOTP)
+};
+
+const uint8_t DL_REPLY_FLAG = 0x80;
+
+enum DoorLockCommandStatus : uint8_t {
+    DL_STATUS_OK = 0,
+    DL_STATUS_UNKNOWN_COMMAND = 1,
+    DL_STATUS_BAD_ARGUMENTS = 2
+};
+
+uint16_t _crc16(const uint8_t* data, uint8_t length);
+
+class _FrameParser
+{
+private:
+    uint8_t _buffer[DL_FRAME_MAX_PAYLOAD + 2]; // Decoded payload + CRC
+    uint8_t _length = 0;     // Decoded bytes so far
+    uint8_t _blockLeft = 0;  // Data bytes left in the current COBS block
+    bool _zeroPending = false; // The current block ends with an implied 0x00
+    bool _overflow = false;  // Frame too long; ignore bytes until the next 0x00
+
+public:
+    // Feeds one received byte. Returns the payload length once a complete frame with a valid
+    // CRC has arrived (the payload is then at payload()), or -1 otherwise.
+    int feed(uint8_t byte);
+
+    const uint8_t* payload() const { return _buffer; }
+};
+
+// COBS-encodes payload plus its CRC and writes it as one frame, with a 0x00 before and after.
+void _writeFrame(Print& out, const uint8_t* payload, uint8_t length);
+
+#endif // ARDUINO_DOORLOCK_SERIALFRAME_H
@@ -0,0 +1,58 @@
+#ifndef ARDUINO_DOORLOCK_STATUSDISPLAY_H
+#define ARDUINO_DOORLOCK_STATUSDISPLAY_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+
+// --- Status Display (SSD1306) ---
+// A 128 x 32 or 128 x 64 SSD1306 OLED on I2C that shows whether the door is locked, a star for
+// every digit typed so far and short messages ("WRONG CODE").
+//
+// A full picture is 512 or 1024 bytes, too much to keep in the RAM of an Uno, and sending it
+// takes 10-20 ms at 400 kHz. So the library keeps what is on the screen as text instead: one
+// character per 6 x 8 pixel cell (5 x 7 font and a gap), 21 per row, one row per 8 pixel page.
+//   - print() only marks the cells that really change, as one dirty span per row
+//   - update() (once per scanButtons()) sends at most DL_DISPLAY_CHUNK dirty characters, so
+//     redrawing never holds up the buttons. A whole screen takes 24 or 48 calls.
+//   - the display's column and page address is only set again when a chunk doesn't start where
+//     the last one ended
+// To save flash the font only has ' ' to '_' (0x20-0x5F): lower case letters are shown as upper
+// case and anything else as '?'.
+
+const uint8_t DL_DISPLAY_COLUMNS = 21;                      // Characters per row (126 of 128 pixels)
+const uint8_t DL_DISPLAY_ROWS = DOORLOCK_DISPLAY_HEIGHT / 8; // Text rows
+const uint8_t DL_DISPLAY_CHUNK = 4;                          // Characters per update(): 24 data bytes, fits Wire's buffer
+const uint8_t DL_DISPLAY_CLEAN = 0xFF;                       // _dirtyFirst of a row with nothing to send
+
+static_assert(DOORLOCK_DISPLAY_HEIGHT == 32 || DOORLOCK_DISPLAY_HEIGHT == 64,
+              "DOORLOCK_DISPLAY_HEIGHT must be 32 or 64");
+
+class _StatusDisplay
+{
+private:
+    char _cells[DL_DISPLAY_ROWS][DL_DISPLAY_COLUMNS]; // What the screen shows (or will once sent)
+    uint8_t _dirtyFirst[DL_DISPLAY_ROWS];             // First and last cell of each row to send
+    uint8_t _dirtyLast[DL_DISPLAY_ROWS];
+    uint8_t _addressRow = 0xFF;                       // Where the display writes next, if known
+    uint8_t _addressColumn = 0;
+    bool _present = false;                            // The display answered at start()
+
+    void _markDirty(uint8_t row, uint8_t column);
+    void _print(uint8_t row, uint8_t column, const char* text, bool flash, uint8_t width);
+    void _sendCommands(const uint8_t* commands, uint8_t count);
+
+public:
+    // Sets the display up and blanks it (the blank cells go out over the next update() calls).
+    // Returns false if nothing answers at DOORLOCK_DISPLAY_ADDRESS; update() then does nothing.
+    bool begin();
+
+    // Writes text at a row and column, padded with spaces up to `width` characters. A flash
+    // version is there for messages kept with F().
+    void print(uint8_t row, uint8_t column, const char* text, uint8_t width);
+    void print(uint8_t row, uint8_t column, const __FlashStringHelper* text, uint8_t width);
+
+    // Sends the next few dirty characters, if any.
+    void update();
+};
+
+#endif // ARDUINO_DOORLOCK_STATUSDISPLAY_H
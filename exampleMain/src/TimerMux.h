@@ -0,0 +1,82 @@
+#ifndef ARDUINO_DOORLOCK_TIMERMUX_H
+#define ARDUINO_DOORLOCK_TIMERMUX_H
+
+#include "DoorLockConfig.h"
+
+#if DOORLOCK_USE_TIMER_MUX
+
+#include <Arduino.h>
+#include "FastGpio.h"
+
+// --- Internal Timer Multiplexer ---
+// One hardware timer (Timer2) drives every timed output of the library:
+//   - the servo pulse (544-2400 us HIGH every 20 ms, like the Servo library)
+//   - the buzzer square wave (what tone() normally does)
+//   - software PWM for dimming the red and green LEDs
+//   - a 1 ms periodic tick that other parts of the library can hook into
+// Every channel is just a pin that stays HIGH for highTicks and LOW for lowTicks.
+// The interrupt toggles whichever channels are due and then sets the timer
+// to fire again at the next nearest edge, so it only runs when something changes.
+//
+// Edges are only as exact as the interrupt is quick to start: anything else that runs with
+// interrupts off (millis(), Serial, another interrupt) can make one a few microseconds late.
+// The 1 ms tick handler (timer button sampling) runs at the end of the interrupt with
+// interrupts back on, so its time doesn't count against the other channels.
+
+// Channel slots in the event table
+enum _MuxChannelId : uint8_t {
+    DL_MUX_SERVO = 0,
+    DL_MUX_BUZZER,
+    DL_MUX_RED_LED,
+    DL_MUX_GREEN_LED,
+    DL_MUX_TICK,
+    DL_MUX_CHANNEL_COUNT
+};
+
+class _TimerMux
+{
+private:
+    struct Channel {
+        _FastPin pin;       // Output pin (the tick channel has none)
+        uint16_t highTicks = 0; // Time spent HIGH, in timer ticks
+        uint16_t lowTicks = 0;  // Time spent LOW, in timer ticks
+        uint16_t remaining = 0; // Ticks left until this channel's next edge
+        bool active = false;    // Channel is running
+        bool level = false;     // Current output level
+    };
+
+    Channel _channels[DL_MUX_CHANNEL_COUNT];
+    uint16_t _lastInterval = 250;  // Ticks the timer was last set to wait
+    bool _running = false;         // Timer2 has been configured
+    void (*_tickHandler)() = nullptr; // Called every millisecond from the interrupt
+    volatile bool _inTick = false;    // The tick handler is running
+
+    void _begin();
+    void _setChannel(uint8_t id, uint16_t highTicks, uint16_t lowTicks);
+    void _stopChannel(uint8_t id, bool level);
+
+public:
+    // Length of one timer tick in microseconds (Timer2 runs at F_CPU / 64)
+    static const uint16_t TICK_US = 64000000UL / F_CPU;
+
+    void attachServo(int pin);
+    void writeServo(int angle);
+    void detachServo();
+
+    void bindBuzzer(int pin);
+    void buzzerOn(unsigned int hz);
+    void buzzerOff();
+
+    void bindLED(uint8_t id, int pin);     // id is DL_MUX_RED_LED or DL_MUX_GREEN_LED
+    void setLED(uint8_t id, uint8_t duty); // 0 = off, 255 = fully on, anything else dims
+
+    void setTickHandler(void (*handler)());
+
+    void handleInterrupt(); // Only called by the Timer2 interrupt
+};
+
+extern _TimerMux _theTimerMux;
+
+#endif // DOORLOCK_USE_TIMER_MUX
+
+#endif // ARDUINO_DOORLOCK_TIMERMUX_H
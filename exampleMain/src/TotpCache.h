@@ -0,0 +1,91 @@
+#ifndef ARDUINO_DOORLOCK_TOTPCACHE_H
+#define ARDUINO_DOORLOCK_TOTPCACHE_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+#include "LockClock.h"
+
+// --- One-Time Codes (TOTP) ---
+// Temporary keypad codes that change every 30 seconds, worked out from a shared secret and the
+// time like an authenticator app does (RFC 6238, HMAC-SHA1). The usual 6 decimal digits become
+// DOORLOCK_TOTP_DIGITS keypad digits: the 31-bit number is taken modulo 3^digits and written in
+// base 3, with 1, 2 and 3 for the base-3 digits 0, 1 and 2 (tools/totp_code.py shows the code).
+//
+// One code takes 2 SHA-1 blocks of 80 rounds, which is far too slow to work out after somebody
+// has typed a code. So the codes of the previous, the current and the next 30 seconds are worked
+// out ahead of time and kept in a small cache, DL_TOTP_ROUNDS_PER_TICK rounds per scanButtons().
+// When the 30 seconds are over, the old "next" code is already there; only the new "next" one has
+// to be worked out. Checking a typed code compares it with every cached code, always all of them,
+// so it takes the same time whichever code was typed. Each code opens the door only once.
+//
+// The secrets are not kept: setSecret() only keeps the SHA-1 state after the key's inner and outer
+// pad blocks (what every HMAC starts with), which is all that is needed to work out codes.
+
+const uint8_t DL_TOTP_STEP_SECONDS = 30;     // How long each code is good for
+const uint8_t DL_TOTP_ROUNDS_PER_TICK = 16;  // SHA-1 rounds per scanButtons() (80 per block)
+const uint8_t DL_TOTP_MAX_KEY = 64;          // Longest secret in bytes (one SHA-1 block)
+const uint8_t DL_TOTP_WINDOWS = 3;           // Previous, current and next code
+
+static_assert(DOORLOCK_TOTP_DIGITS >= 1 && DOORLOCK_TOTP_DIGITS <= 10,
+              "DOORLOCK_TOTP_DIGITS must be 1 to 10 (3^digits has to fit in 16 bits)");
+
+// One SHA-1 compression that can be run a few rounds at a time.
+struct _Sha1Block {
+    uint32_t h[5];     // Chaining value; holds the result when done
+    uint32_t v[5];     // Working variables a-e
+    uint32_t w[16];    // The block, then the message schedule (16 word ring)
+    uint8_t round = 0;
+
+    void begin(const uint32_t* state, const uint32_t* block);
+    bool run(uint8_t rounds); // True when all 80 rounds are done
+};
+
+class _TotpCache
+{
+private:
+    struct Secret {
+        bool set = false;
+        uint32_t inner[5];                  // SHA-1 state after the key XOR ipad block
+        uint32_t outer[5];                  // SHA-1 state after the key XOR opad block
+        uint32_t counters[DL_TOTP_WINDOWS]; // Time step of each cached code (slot = step % 3)
+        uint16_t codes[DL_TOTP_WINDOWS];    // The codes, as base-3 numbers
+        uint8_t ready = 0;                  // Bit n: codes[n] is worked out
+        uint32_t lastUsed = 0;              // Step of the last code that opened the door
+    };
+
+    Secret _secrets[DOORLOCK_TOTP_SECRETS];
+    uint32_t _step = 0;              // Current time step (Unix time / 30)
+    bool _stepKnown = false;
+    unsigned long _nextStepMs = 0;   // millis() when the step changes (or to look at the clock again)
+    bool _pending = false;           // A code may be missing (the step or a secret changed)
+
+    // The code being worked out
+    bool _busy = false;
+    bool _outerBlock = false;        // Working on the outer hash
+    uint8_t _jobSecret = 0;
+    uint32_t _jobCounter = 0;
+    _Sha1Block _sha;
+
+    bool _startNext();
+    void _finish();
+
+public:
+    // True when poll() has something to do.
+    bool due(unsigned long now) const { return _busy || _pending || (long)(now - _nextStepMs) >= 0; }
+
+    // Follows the clock and works on the next missing code for a few rounds.
+    void poll(unsigned long now, const _LockClock& clock);
+
+    // The clock was set: look at it again on the next poll() instead of at the next step.
+    void clockChanged(unsigned long now) { _nextStepMs = now; }
+
+    // Sets secret number `slot` (up to DL_TOTP_MAX_KEY bytes). Returns false if it doesn't fit.
+    bool setSecret(uint8_t slot, const uint8_t* key, uint8_t length);
+    void clearSecret(uint8_t slot);
+
+    // Checks a typed code (DOORLOCK_TOTP_DIGITS digits, each 1-3) against every cached code.
+    // A matching code is used up.
+    bool matches(const int* digits, uint8_t length);
+};
+
+#endif // ARDUINO_DOORLOCK_TOTPCACHE_H
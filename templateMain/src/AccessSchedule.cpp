@@ -0,0 +1,86 @@
+#include "AccessSchedule.h"
+
+#if DOORLOCK_USE_SCHEDULES
+
+#include <EEPROM.h>
+
+// EEPROM layout, after the 2 fast boot bytes:
+//   DOORLOCK_SCHEDULE_USERS flag bytes (SCHEDULE_MARKER: the user has a schedule)
+//   DOORLOCK_SCHEDULE_USERS bitmaps of DL_SCHEDULE_BYTES, bit (slot % 8) of byte (slot / 8)
+const int SCHEDULE_FLAGS_ADDRESS = DOORLOCK_EEPROM_ADDRESS + 2;
+const int SCHEDULE_BITMAPS_ADDRESS = SCHEDULE_FLAGS_ADDRESS + DOORLOCK_SCHEDULE_USERS;
+const uint8_t SCHEDULE_MARKER = 0xA5; // Anything else (like 0xFF from a new chip) means no schedule
+
+static int _bitmapAddress(uint8_t user)
+{
+    return SCHEDULE_BITMAPS_ADDRESS + user * DL_SCHEDULE_BYTES;
+}
+
+// --- Schedules ---
+void _AccessSchedule::begin()
+{
+    _restricted = 0;
+    for (uint8_t user = 0; user < DOORLOCK_SCHEDULE_USERS; user++) {
+        if (EEPROM.read(SCHEDULE_FLAGS_ADDRESS + user) == SCHEDULE_MARKER) {
+            _restricted |= 1 << user;
+        }
+    }
+}
+
+bool _AccessSchedule::allows(uint8_t user, uint16_t slot) const
+{
+    if (user >= DOORLOCK_SCHEDULE_USERS || !(_restricted & (1 << user))) {
+        return true;
+    }
+    if (slot >= DL_SCHEDULE_SLOTS) {
+        return false; // Time not known
+    }
+    return (EEPROM.read(_bitmapAddress(user) + slot / 8) >> (slot % 8)) & 1;
+}
+
+bool _AccessSchedule::setWindow(uint8_t user, uint8_t days, uint8_t firstSlot, uint8_t count, bool allowed)
+{
+    if (user >= DOORLOCK_SCHEDULE_USERS || firstSlot >= DL_SCHEDULE_SLOTS_PER_DAY ||
+        count > DL_SCHEDULE_SLOTS_PER_DAY - firstSlot || (days & ~DL_SCHEDULE_EVERY_DAY)) {
+        return false;
+    }
+    int address = _bitmapAddress(user);
+    if (!(_restricted & (1 << user))) {
+        // New schedule: start from "never", then turn it on. Until the flag is written the user
+        // keeps their old access, so a reset in between doesn't lock them out halfway.
+        for (uint8_t i = 0; i < DL_SCHEDULE_BYTES; i++) {
+            EEPROM.update(address + i, 0x00);
+        }
+        EEPROM.update(SCHEDULE_FLAGS_ADDRESS + user, SCHEDULE_MARKER);
+        _restricted |= 1 << user;
+    }
+    // Only the bytes that hold the window are read and rewritten.
+    for (uint8_t day = 0; day < DL_SCHEDULE_DAYS; day++) {
+        if (!(days & (1 << day))) {
+            continue;
+        }
+        uint16_t slot = day * DL_SCHEDULE_SLOTS_PER_DAY + firstSlot;
+        uint16_t end = slot + count;
+        while (slot < end) {
+            uint8_t bit = slot % 8;
+            uint8_t bits = end - slot < 8 - bit ? end - slot : 8 - bit;
+            uint8_t mask = (uint8_t)(((1 << bits) - 1) << bit);
+            int byteAddress = address + slot / 8;
+            uint8_t value = EEPROM.read(byteAddress);
+            EEPROM.update(byteAddress, allowed ? (value | mask) : (value & ~mask));
+            slot += bits;
+        }
+    }
+    return true;
+}
+
+void _AccessSchedule::clear(uint8_t user)
+{
+    if (user >= DOORLOCK_SCHEDULE_USERS) {
+        return;
+    }
+    EEPROM.update(SCHEDULE_FLAGS_ADDRESS + user, 0xFF);
+    _restricted &= ~(1 << user);
+}
+
+#endif // DOORLOCK_USE_SCHEDULES
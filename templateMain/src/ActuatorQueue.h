@@ -0,0 +1,156 @@
+#ifndef ARDUINO_DOORLOCK_ACTUATORQUEUE_H
+#define ARDUINO_DOORLOCK_ACTUATORQUEUE_H
+
+#include <Arduino.h>
+
+// --- Internal Actuator Command Queue ---
+// The premade DoorUnlock()/DoorLock()/DoorIncorrect() don't move the servo or blink the LEDs
+// themselves any more. They post a short list of commands here and return straight away.
+// The library's update loop (scanButtons()) takes commands off the other end and performs
+// them, so reading buttons never has to wait for a servo move or a beep to finish.
+//
+// It is a single-producer / single-consumer ring buffer: only the producer moves _head and
+// only the consumer moves _tail. Both are single bytes, so no locking is needed even if the
+// producer is an interrupt. An item is written before the index that hands it over, and read
+// only after that index has been seen. On the AVR (one core) keeping the compiler from
+// reordering is enough; elsewhere the index is stored with release and loaded with acquire
+// ordering, so the two ends may also be two threads on different cores (tools/host_bench runs
+// them that way).
+//
+// The library itself still runs both ends from scanButtons(). A sketch that wants them on two
+// tasks (POSIX threads, FreeRTOS tasks) can't simply move the consumer yet: the LED copies that
+// _FastPin writes are shared with the button side, and on Linux the LEDs are only written out by
+// the button side's scanButtons().
+
+enum _ActuatorOp : uint8_t {
+    DL_ACT_SERVO = 0, // value = angle
+    DL_ACT_RED_LED,   // value = 0 off, 1 on
+    DL_ACT_GREEN_LED, // value = 0 off, 1 on
+    DL_ACT_BUZZER,    // value = frequency in Hz, 0 = off
+    DL_ACT_WAIT       // value = milliseconds before the next command
+};
+
+// Set on the first command of each posted sequence; used to measure latency.
+const uint8_t DL_ACT_FIRST = 0x80;
+
+struct _ActuatorCommand {
+    uint8_t op;        // _ActuatorOp, plus DL_ACT_FIRST on the first command of a sequence
+    uint16_t value;    // Meaning depends on op
+    uint16_t postedAt; // Low 16 bits of micros() when posted
+};
+
+class _ActuatorQueue
+{
+private:
+    static const uint8_t SIZE = 16; // Must be a power of two
+    _ActuatorCommand _items[SIZE];
+    volatile uint8_t _head = 0; // Next slot the producer writes
+    volatile uint8_t _tail = 0; // Next slot the consumer reads
+
+    static uint8_t _acquire(const volatile uint8_t& index)
+    {
+#if defined(__AVR__)
+        uint8_t value = index;
+        __asm__ __volatile__("" ::: "memory");
+        return value;
+#else
+        return __atomic_load_n(&index, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    static void _release(volatile uint8_t& index, uint8_t value)
+    {
+#if defined(__AVR__)
+        __asm__ __volatile__("" ::: "memory");
+        index = value;
+#else
+        __atomic_store_n(&index, value, __ATOMIC_RELEASE);
+#endif
+    }
+
+public:
+    // Producer side. Returns false (and drops the command) if the queue is full.
+    bool push(uint8_t op, uint16_t value)
+    {
+        uint8_t head = _head;
+        uint8_t next = (head + 1) & (SIZE - 1);
+        if (next == _acquire(_tail)) {
+            return false;
+        }
+        _items[head].op = op;
+        _items[head].value = value;
+        _items[head].postedAt = (uint16_t)micros();
+        _release(_head, next); // Finish writing the item before publishing it
+        return true;
+    }
+
+    // Consumer side. Copies the oldest command into cmd; returns false if the queue is empty.
+    bool pop(_ActuatorCommand& cmd)
+    {
+        uint8_t tail = _tail;
+        if (tail == _acquire(_head)) { // Read the item only after seeing it published
+            return false;
+        }
+        cmd = _items[tail];
+        _release(_tail, (tail + 1) & (SIZE - 1)); // Done with the slot before handing it back
+        return true;
+    }
+
+    // Consumer side (the producer may ask too, e.g. isActuatorBusy()).
+    bool isEmpty() const { return _tail == _acquire(_head); }
+
+    // Producer side. How many more commands fit right now.
+    uint8_t space() const { return (_acquire(_tail) - _head - 1) & (SIZE - 1); }
+};
+
+// --- Actuation Latency Histogram ---
+// Time from posting a command sequence to its first command being carried out.
+// Bucket i counts latencies below 2^(i+4) microseconds. Timestamps are 16 bits, so anything
+// over 65 ms wraps around; the door lock update loop should never be that slow.
+class _LatencyHistogram
+{
+private:
+    static const uint8_t BUCKETS = 13; // 16 us ... 65 ms
+    uint16_t _counts[BUCKETS] = {};
+    uint16_t _total = 0;
+
+public:
+    void record(unsigned long us)
+    {
+        uint8_t bucket = 0;
+        while (bucket < BUCKETS - 1 && us >= (16UL << bucket)) {
+            bucket++;
+        }
+        if (_counts[bucket] < 0xFFFF && _total < 0xFFFF) {
+            _counts[bucket]++;
+            _total++;
+        }
+    }
+
+    // Upper bound (in microseconds) below which `percent` percent of the samples fall. 0 if no samples.
+    unsigned long percentile(uint8_t percent) const
+    {
+        if (_total == 0) {
+            return 0;
+        }
+        uint32_t needed = ((uint32_t)_total * percent + 99) / 100;
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            seen += _counts[i];
+            if (seen >= needed) {
+                return 16UL << i;
+            }
+        }
+        return 16UL << (BUCKETS - 1);
+    }
+
+    void reset()
+    {
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            _counts[i] = 0;
+        }
+        _total = 0;
+    }
+};
+
+#endif // ARDUINO_DOORLOCK_ACTUATORQUEUE_H
@@ -0,0 +1,192 @@
+#ifndef ARDUINO_DOORLOCK_ADAPTIVEDEBOUNCE_H
+#define ARDUINO_DOORLOCK_ADAPTIVEDEBOUNCE_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+#include "Telemetry.h" // _saturatingIncrement()
+
+// --- Adaptive Debounce ---
+// When a button's contacts touch or let go they bounce for a little while, and the debouncer
+// waits until the reading has been steady for a "settle window" before it believes it. A fixed
+// window has to be long enough for the worst switch, so every button feels slow.
+//
+// Instead every button learns how long its own contacts bounce:
+//   - each bounce (first contact change to the last one before things go quiet) is measured
+//     and counted in a histogram
+//   - the first 2 rounds of DL_BOUNCE_ROUND bounces are the learning phase; the button keeps
+//     the safe DL_DEBOUNCE_MAX_MS window until it is over
+//   - after that the window is just above the worst bounce of the last 1-2 rounds, so a good
+//     switch answers in a few milliseconds
+//   - a bounce that still comes after the window accepted the change ("late bounce") can't
+//     undo it for DL_DEBOUNCE_HOLD_MS (no real press is that short) and widens the window
+//     right away
+//   - a switch whose bounces get much longer than when it was learned is reported as degrading
+// Read it with debounceReport() / printDebounceReport().
+
+const uint8_t DL_BOUNCE_BINS = 8;        // Histogram: <1, 1, 2-3, 4-7, 8-15, 16-31, 32-63, 64+ ms
+const uint8_t DL_DEBOUNCE_MIN_MS = 3;    // Shortest settle window
+const uint8_t DL_DEBOUNCE_MAX_MS = 50;   // Longest settle window, and the one used while learning
+const uint8_t DL_DEBOUNCE_HOLD_MS = 25;  // Shortest real press or release
+const uint8_t DL_BOUNCE_QUIET_MS = 20;   // A bounce is over after this long without a change
+const uint8_t DL_BOUNCE_ROUND = 16;      // Bounces per round
+
+struct DoorLockDebounceReport {
+    uint8_t windowMs;       // Settle window in use now
+    uint8_t worstMs;        // Longest bounce of the last 1-2 rounds
+    uint8_t learnedMs;      // Longest bounce while learning (0 = still learning)
+    bool degrading;         // Bounces are now much longer than when the switch was learned
+    uint16_t lateBounces;   // Bounces that came after the window had already accepted a change
+    uint16_t histogram[DL_BOUNCE_BINS]; // Number of bounces per length (see DL_BOUNCE_BINS)
+};
+
+#if DOORLOCK_ENABLE_ADAPTIVE_DEBOUNCE
+
+class _SwitchProfile
+{
+private:
+    unsigned long _bounceStart = 0; // First contact change of the bounce being measured
+    unsigned long _lastChange = 0;  // Latest contact change
+    unsigned long _acceptedAt = 0;  // When the debouncer last accepted a new state
+    bool _bouncing = false;
+    bool _late = false;             // This bounce already counted as a late bounce
+    uint8_t _window = DL_DEBOUNCE_MAX_MS;
+    uint8_t _rounds = 0;            // Finished rounds, up to 2 (learning is over)
+    uint8_t _count = 0;             // Bounces in the current round
+    uint8_t _roundWorst = 0;
+    uint8_t _previousWorst = 0;
+    uint8_t _learnedWorst = 0;
+    uint16_t _lateBounces = 0;
+    uint16_t _histogram[DL_BOUNCE_BINS] = {};
+
+    bool _learned() const { return _rounds >= 2; }
+
+    uint8_t _bounceLength(unsigned long now) const
+    {
+        unsigned long length = now - _bounceStart;
+        return length > 255 ? 255 : length;
+    }
+
+    void _updateWindow()
+    {
+        if (!_learned()) {
+            return;
+        }
+        uint16_t window = worstMs();
+        window += window / 4 + 2; // A bit of margin above the worst bounce seen
+        if (window < DL_DEBOUNCE_MIN_MS) {
+            window = DL_DEBOUNCE_MIN_MS;
+        } else if (window > DL_DEBOUNCE_MAX_MS) {
+            window = DL_DEBOUNCE_MAX_MS;
+        }
+        _window = window;
+    }
+
+    void _bounceFinished()
+    {
+        _bouncing = false;
+        uint8_t length = _bounceLength(_lastChange);
+        uint8_t bin = 0;
+        for (uint8_t ms = length; ms > 0 && bin < DL_BOUNCE_BINS - 1; ms >>= 1) {
+            bin++;
+        }
+        _saturatingIncrement(_histogram[bin]);
+
+        if (length > _roundWorst) {
+            _roundWorst = length;
+        }
+        if (!_learned() && length > _learnedWorst) {
+            _learnedWorst = length;
+        }
+        if (++_count == DL_BOUNCE_ROUND) {
+            _count = 0;
+            _previousWorst = _roundWorst;
+            _roundWorst = 0;
+            if (!_learned()) {
+                _rounds++;
+            }
+        }
+        _updateWindow();
+    }
+
+public:
+    // The raw reading of the contacts changed.
+    void contactChanged(unsigned long now)
+    {
+        update(now);
+        if (!_bouncing) {
+            _bouncing = true;
+            _late = false;
+            _bounceStart = now;
+        }
+        _lastChange = now;
+
+        bool startedBeforeAccepted = (long)(_acceptedAt - _bounceStart) >= 0;
+        if (_learned() && startedBeforeAccepted && now - _acceptedAt < DL_DEBOUNCE_HOLD_MS) {
+            // Still bouncing although the window said it was over: make the window longer now
+            if (!_late) {
+                _late = true;
+                _saturatingIncrement(_lateBounces);
+            }
+            uint8_t length = _bounceLength(now);
+            if (length > _roundWorst) {
+                _roundWorst = length;
+            }
+            _updateWindow();
+        }
+    }
+
+    // Finishes the measured bounce once the contacts have been quiet long enough.
+    void update(unsigned long now)
+    {
+        if (_bouncing && now - _lastChange > DL_BOUNCE_QUIET_MS) {
+            _bounceFinished();
+        }
+    }
+
+    // True if a reading that has been steady since the last contact change may be accepted.
+    bool settled(unsigned long now) const
+    {
+        return now - _lastChange > _window && now - _acceptedAt >= DL_DEBOUNCE_HOLD_MS;
+    }
+
+    void accepted(unsigned long now) { _acceptedAt = now; }
+
+    uint8_t windowMs() const { return _window; }
+    uint8_t worstMs() const { return _roundWorst > _previousWorst ? _roundWorst : _previousWorst; }
+
+    void report(DoorLockDebounceReport& report) const
+    {
+        report.windowMs = _window;
+        report.worstMs = worstMs();
+        report.learnedMs = _learned() ? _learnedWorst : 0;
+        // Twice as long as when it was learned, and long enough that it isn't just noise
+        report.degrading = _learned() && worstMs() > _learnedWorst * 2 && worstMs() >= _learnedWorst + 5;
+        report.lateBounces = _lateBounces;
+        memcpy(report.histogram, _histogram, sizeof(_histogram));
+    }
+};
+
+#else
+
+// Fixed window: every button waits DL_DEBOUNCE_MAX_MS, nothing is measured.
+class _SwitchProfile
+{
+private:
+    unsigned long _lastChange = 0;
+
+public:
+    void contactChanged(unsigned long now) { _lastChange = now; }
+    void update(unsigned long) {}
+    bool settled(unsigned long now) const { return now - _lastChange > DL_DEBOUNCE_MAX_MS; }
+    void accepted(unsigned long) {}
+    uint8_t windowMs() const { return DL_DEBOUNCE_MAX_MS; }
+    void report(DoorLockDebounceReport& report) const
+    {
+        memset(&report, 0, sizeof(report));
+        report.windowMs = DL_DEBOUNCE_MAX_MS;
+    }
+};
+
+#endif
+
+#endif // ARDUINO_DOORLOCK_ADAPTIVEDEBOUNCE_H
@@ -3,6 +3,28 @@
 
 #include <Arduino.h> // Required for Arduino specific functions like pinMode, digitalWrite, etc.
 #include <Servo.h>   // Required for the Servo library
+#include "DoorLockConfig.h" // Library build options
+#include "FastGpio.h" // Direct port access for the buttons and LEDs
+#include "TimerMux.h" // Shared timer for servo, buzzer and LED dimming (when enabled)
+#include "LinuxGpio.h" // GPIO character device and sysfs PWM on Linux boards (when enabled)
+#include "DoorLockTask.h" // DL_TASK / DL_WAIT_MS for feedback code that doesn't block
+#include "ActuatorQueue.h" // Queue between button handling and the servo/LEDs/buzzer
+#include "AuditLog.h"      // Recent lock/unlock history
+#include "SerialFrame.h"   // Binary Serial command channel
+#include "ButtonEvents.h"  // Press/release/long-press/double-tap/chord events
+#include "LockTimers.h"    // Auto-relock and code entry timeouts
+#include "MemoryStats.h"   // RAM usage and stack high-water mark
+#include "Supervisor.h"    // Loop-stall detection and the watchdog
+#include "Telemetry.h"     // Usage counters
+#include "AdaptiveDebounce.h" // Per-button settle windows learned from bounce times
+#include "LockStateMachine.h" // Lock/unlock transition table
+#include "RfidReader.h"       // MFRC522 badge reader (when enabled)
+#include "PortExpander.h"     // MCP23017 I2C port expander for buttons and LEDs (when enabled)
+#include "LockClock.h"        // Clock for schedules and one-time codes (when enabled)
+#include "AccessSchedule.h"   // Time-of-day access windows (when enabled)
+#include "TotpCache.h"        // One-time codes (when enabled)
+#include "StatusDisplay.h"    // SSD1306 status display (when enabled)
+#include "ServoSense.h"       // Servo stall and jam detection (when enabled)
 
 // --- Global Constants for Default Pin Assignments and Code ---
 // These make it easy for campers to see what pins are used by default
@@ -15,11 +37,23 @@ const int DOORLOCK_RED_LED_PIN = 8;
 const int DOORLOCK_GREEN_LED_PIN = 7;
 const int DOORLOCK_SERVO_PIN = 9;
 const int DOORLOCK_BUZZER_PIN = 12;
+const int DOORLOCK_RFID_SS_PIN = 10; // Chip select of the RFID reader (DOORLOCK_USE_RFID)
 
 // Default secret code for the door lock (e.g., 1-2-3)
 const int DOORLOCK_DEFAULT_CODE[] = {1, 2, 3};
 const int DOORLOCK_DEFAULT_CODE_LENGTH = 3;
 
+// Longest secret code the library can store is DOORLOCK_MAX_CODE_LENGTH (DoorLockConfig.h).
+// Codes outside 1 to DOORLOCK_MAX_CODE_LENGTH are refused, not shortened.
+static_assert(DOORLOCK_MAX_CODE_LENGTH >= 1 && DOORLOCK_MAX_CODE_LENGTH <= 32, "DOORLOCK_MAX_CODE_LENGTH must be 1-32");
+
+#if DOORLOCK_USE_TOTP
+static_assert(DOORLOCK_TOTP_DIGITS <= DOORLOCK_MAX_CODE_LENGTH, "A one-time code must fit DOORLOCK_MAX_CODE_LENGTH");
+#endif
+
+// How many tasks (see DoorLockTask.h) can run at the same time.
+const int DOORLOCK_MAX_TASKS = 3;
+
 // --- Internal Implementation Class ---
 // This class holds all the actual state and logic for the door lock.
 // It's given a leading underscore to indicate it's for internal library use,
@@ -27,8 +61,16 @@ const int DOORLOCK_DEFAULT_CODE_LENGTH = 3;
 class _DoorLockImpl
 {
 private:
-    int* _correctCode;   // Dynamically allocated array for the secret code
-    int _codeLength;     // Length of the secret code
+    // The secret code is double buffered: one slot is live, the other is where a new code is
+    // staged. Committing a new code just flips _activeCode, which is a single byte write, and
+    // counts the commit in _codeCommits, so isAttemptCorrect() can tell when it has to compare
+    // again and never sees half of an old code and half of a new one.
+    int _codes[2][DOORLOCK_MAX_CODE_LENGTH]; // Secret code slots
+    int _codeLengths[2];                     // Length of the code in each slot
+    volatile uint8_t _activeCode = 0;        // Slot that holds the live code
+    volatile uint8_t _codeCommits = 0;       // Commits so far (wraps around)
+    bool _codeStaged = false;                // A staged code is waiting for commitCorrectCode()
+    bool _started = false;                   // start() has run; codes set before that aren't audited
     int _inputIndex = 0; // Current index for code input attempt
 	
     // Pin assignments for hardware components
@@ -42,18 +84,192 @@ private:
     int _buzzerPin;
 
     // Variables for button debouncing (original names: lastReading, stableState)
-    int* _lastReading; // Array to store last reading for each button
-    int* _stableState; // Array to store stable state for each button
-	unsigned long _lastDebounceTs[4] = {0, 0, 0, 0}; // Timestamps for debouncing
-	bool _buttonJustPressedFlags[4] = {false, false, false, false}; // Flags for one-shot button press detection
-
+    int _lastReading[4]; // Array to store last reading for each button
+    int _stableState[4]; // Array to store stable state for each button
+	_SwitchProfile _debounce[4]; // Settle window and bounce history of each button
+	volatile bool _buttonJustPressedFlags[4] = {false, false, false, false}; // Flags for one-shot button press detection
+
+    // Timer-interrupt sampling mode (see setTimerSampling())
+    volatile bool _timerSampling = false; // True while the timer interrupt is doing the debouncing
+    uint8_t _sampleCount[4] = {0, 0, 0, 0}; // Consecutive samples that disagreed with the stable state
+
+    uint8_t _heldMask = 0;               // DL_BUTTON_... bits of the buttons currently down (gestures only)
+#if DOORLOCK_ENABLE_GESTURES
+    // Gesture detection, fed by the debouncer (polled or timer interrupt)
+    _ButtonEventQueue _buttonEvents;
+    uint8_t _longPressMask = 0;          // Held buttons that already sent DL_EVENT_LONG_PRESS
+    uint8_t _quickTapMask = 0;           // Buttons whose last press was a short tap
+    unsigned long _pressedAt[4] = {0, 0, 0, 0};
+    unsigned long _releasedAt[4] = {0, 0, 0, 0};
+    unsigned long _nextRepeatAt[4] = {0, 0, 0, 0};
+    unsigned long _longPressMs = 800;    // Hold time for DL_EVENT_LONG_PRESS
+    unsigned long _repeatMs = 200;       // Time between DL_EVENT_REPEAT (0 = no repeats)
+    unsigned long _doubleTapMs = 300;    // Max gap between a tap and the next press for DL_EVENT_DOUBLE_TAP
+#endif
+
+    // Edge events (DOORLOCK_USE_EDGE_EVENTS or DOORLOCK_USE_LINUX_GPIO): scanButtons() only reads
+    // the pins after a pin changed or while a button is still settling.
+    bool _buttonsSettling = true; // Some button's reading differs from its stable state
+
+    // Cached port registers for the pins above, filled in by _bindPins()
+    _FastPin _buttonPins[4]; // Button 1, 2, 3 and the lock button, in scan order
+    _FastPin _redPin;
+    _FastPin _greenPin;
+
+#if !DOORLOCK_USE_TIMER_MUX && !DOORLOCK_USE_LINUX_GPIO
     Servo _servo; // Servo object (original name: servo)
-
-    // Original private helper method
+#endif
+    bool _servoAttached = false;       // The servo is attached the first time it has to move
+    unsigned long _bootToFirstScanUs = 0; // micros() at the first scanButtons() call
+
+    // Actuator commands posted by DoorUnlock()/DoorLock()/DoorIncorrect(), run from scanButtons()
+    _ActuatorQueue _actuators;
+#if DOORLOCK_ENABLE_LATENCY_STATS
+    _LatencyHistogram _actuationLatency; // Post-to-actuation time of each command sequence
+#endif
+    bool _actuatorSequenceStart = false; // Next posted command starts a new sequence
+    volatile uint8_t _actuatorSequencesPosted = 0; // Sequences posted and sequences started. While
+    uint8_t _actuatorSequencesRun = 0;             // they differ, older feedback skips its waits
+    bool _actuatorWaiting = false;       // A DL_ACT_WAIT is in progress
+    unsigned long _actuatorWaitStart = 0;
+    unsigned long _actuatorWaitMs = 0;
+
+#if DOORLOCK_ENABLE_SERIAL_COMMANDS
+    // Serial command channel (see SerialFrame.h)
+    bool _serialCommands = false; // Commands are only read after enableSerialCommands(true)
+    _FrameParser _frameParser;
+    _AuditLog _audit;
+#endif
+
+#if DOORLOCK_ENABLE_TIMEOUTS
+    // Auto-relock and code entry timeout (0 = turned off)
+    _LockTimers _timers;
+    unsigned long _autoRelockMs = 0;
+    unsigned long _entryTimeoutMs = 0;
+    void (*_autoRelockHandler)() = nullptr;  // Sketch's own relock feedback, or null for DoorLock()
+    void (*_entryTimeoutHandler)() = nullptr; // Sketch's own "too slow" feedback, or null for none
+#endif
+
+#if DOORLOCK_ENABLE_TELEMETRY
+    DoorLockTelemetry _telemetry = {};
+    unsigned long _entryStartMs = 0; // millis() of the first digit of the code being typed
+    bool _entryTiming = false;       // A code is being typed and its time isn't counted yet
+#endif
+
+#if DOORLOCK_ENABLE_SUPERVISOR
+    DoorLockStallReport _previousStall = {}; // What the supervisor saw before the last reset
+#endif
+
+#if DOORLOCK_ENABLE_TASKS
+    // Running tasks, resumed from scanButtons(). An empty slot has a null function.
+    DoorLockTaskFunction _taskFunctions[DOORLOCK_MAX_TASKS] = {};
+    DoorLockTask _tasks[DOORLOCK_MAX_TASKS];
+#endif
+
+#if DOORLOCK_USE_RFID
+    _RfidReader _rfid;
+#endif
+
+#if DOORLOCK_USE_CLOCK
+    _LockClock _clock;
+#endif
+#if DOORLOCK_USE_SCHEDULES
+    _AccessSchedule _schedule;
+#endif
+#if DOORLOCK_USE_TOTP
+    _TotpCache _totp;
+    bool _oneTimeCodeAccepted = false; // The code typed so far was a one-time code (already used up)
+#endif
+
+#if DOORLOCK_USE_DISPLAY
+    _StatusDisplay _display;
+    uint8_t _shownLocked = 0xFF;     // Lock state on the screen (0xFF: not drawn yet)
+    uint8_t _shownDigits = 0xFF;     // Digits typed and code length on the screen
+    uint8_t _shownCodeLength = 0;
+    bool _messageShown = false;      // A message is on the screen, since _messageMs
+    unsigned long _messageMs = 0;
+#endif
+#if DOORLOCK_USE_SERVO_SENSE
+    _ServoSense _servoSense;
+#endif
+
+    // Sketch tasks for each DoorLockAction (see setLockActions()); null runs the built-in one
+    DoorLockTaskFunction _lockActions[DL_LOCK_ACTION_COUNT] = {};
+
+    // Private helper: sets pin modes and caches the port registers of every pin
+    void _bindPins();
+    // Private helpers: drive the servo through the Servo library or the timer multiplexer
+    void _servoAttach();
+    void _servoDetach();
+    void _servoWrite(int angle);
+    void _servoDrive(int angle);
+    // Private helper: watches the servo's current and acts on a stall or a jam
+    void _pollServo(unsigned long now);
+    // Private helpers: set `locked` (with its EEPROM copy and the relock timer), and keep the
+    // lock state in EEPROM for fast boot
+    void _setLocked(bool isLocked);
+    void _saveLockState(bool isLocked);
+    bool _restoreLockState();
+    // Private helper: returns and clears the "just pressed" flag of one button
+    bool _consumePress(uint8_t index);
+    // Private helpers: turn debounced button changes (and holds) into button events
+    void _buttonChanged(uint8_t index, bool pressed, unsigned long now);
+    void _checkHeldButtons(unsigned long now);
+    void _pushButtonEvent(uint8_t type, uint8_t buttons, unsigned long now);
+    // Private helpers: arm/cancel the relock timer and the entry timeout, and act on expired timers
+    void _doorOpened();
+    void _doorClosed();
+    void _digitEntered();
+    void _runTimers(unsigned long now);
+    // Private helper: gives every running task a turn
+    void _runTasks();
+    // Private helper: gives the RFID reader a turn and acts on a badge it has read
+    void _pollRfid(unsigned long now);
+    // Private helpers: keep the clock's slot and the one-time code cache current, and check a
+    // user against their schedule
+    void _pollClock(unsigned long now);
+    // Private helpers: keep the status display up to date, a few characters per call
+    void _updateDisplay(unsigned long now);
+    void _showEventMessage(uint8_t event);
+    void _clockChanged();
+    bool _accessAllowed(uint8_t user);
+    // Private helpers: runs the sketch's task or the built-in feedback for a DoorLockAction, and
+    // says whether it can start at all
+    void _runLockAction(uint8_t action);
+    bool _lockActionCanStart(uint8_t action);
+    // Private helpers: producer and consumer ends of the actuator queue
+    bool _startActuatorSequence(uint8_t length);
+    void _postActuator(uint8_t op, uint16_t value);
+    void _runActuators();
+    // Private helpers: read a few Serial bytes per update and act on complete command frames
+    void _pollSerialCommands();
+    void _handleCommand(const uint8_t* frame, uint8_t length);
+    // Private helper: adds an entry to the audit log (when the Serial channel is built in) and
+    // says what happened on the display (when there is one)
+    void _auditEvent(uint8_t event)
+    {
+#if DOORLOCK_ENABLE_SERIAL_COMMANDS
+        _audit.record(event);
+#endif
+#if DOORLOCK_USE_DISPLAY
+        _showEventMessage(event);
+#endif
+        (void)event; // Unused when neither is built in
+    }
+    // Private helper: length of the live secret code
+    int _codeLength() const { return _codeLengths[_activeCode]; }
+    // How many digits the buttons take: the code's length, or a one-time code's if that is longer.
+    int _entryLength() const {
+#if DOORLOCK_USE_TOTP
+        return _codeLength() > DOORLOCK_TOTP_DIGITS ? _codeLength() : DOORLOCK_TOTP_DIGITS;
+#else
+        return _codeLength();
+#endif
+    }
 
     // Public member (original: int* attempt;)
     // Keeping this private within _DoorLockImpl for better encapsulation
-    int* _attempt; // Stores the current code attempt
+    int _attempt[DOORLOCK_MAX_CODE_LENGTH]; // Stores the current code attempt
 	
 public: // Changed constructors to PUBLIC access
     bool locked = true; // Current locked/unlocked state of the door (renamed to avoid conflict)
@@ -67,14 +283,68 @@ public: // Changed constructors to PUBLIC access
 
     _DoorLockImpl(); // Default constructor, now public
 
-    // Public destructor to properly clean up dynamically allocated memory
-    ~_DoorLockImpl();
-
     // --- Core Public Methods (Original Names) ---
 
     void start();
     void scanButtons();
 
+    void setTimerSampling(bool enabled);
+    void sampleButtonsFromISR(); // Only called by the timer interrupt, not by sketches
+
+    bool runTask(DoorLockTaskFunction task);
+    bool isTaskRunning(DoorLockTaskFunction task);
+    void stopTask(DoorLockTaskFunction task);
+
+    uint8_t lockEvent(uint8_t event);
+    uint8_t lockButtonPressed();
+    void setLockActions(DoorLockTaskFunction unlockTask, DoorLockTaskFunction lockTask,
+                        DoorLockTaskFunction incorrectTask);
+
+    int16_t findCard(const uint8_t* uid, uint8_t length);
+    uint8_t lastCard(uint8_t* uid);
+
+    void setTime(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+    bool setDateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+    bool setAccessWindow(uint8_t user, uint8_t days, uint8_t fromHour, uint8_t fromMinute,
+                         uint8_t toHour, uint8_t toMinute, bool allowed);
+    void clearAccessSchedule(uint8_t user);
+    bool setOneTimeSecret(uint8_t slot, const uint8_t* key, uint8_t length);
+    void clearOneTimeSecret(uint8_t slot);
+    void displayMessage(const char* text);
+    bool isJammed();
+
+    void idleUntilEvent();
+
+    bool isActuatorBusy();
+    unsigned long actuationLatency(uint8_t percent);
+    void resetActuationLatency();
+
+    void enableSerialCommands(bool enabled);
+
+    void setAutoRelock(unsigned long seconds, void (*handler)());
+    void setEntryTimeout(unsigned long ms, void (*handler)());
+
+    DoorLockMemoryStats memoryStats();
+    void printMemoryStats();
+
+    void enableWatchdog(unsigned long ms);
+    DoorLockStallReport stallReport();
+    DoorLockStallReport previousStallReport();
+
+    DoorLockTelemetry telemetry();
+    uint8_t telemetrySnapshot(uint8_t* out);
+    void resetTelemetry();
+
+    unsigned long bootTimeMicros();
+
+    DoorLockDebounceReport debounceReport(uint8_t button);
+    void printDebounceReport();
+
+    bool nextButtonEvent(DoorLockButtonEvent& event);
+    void setLongPressTime(unsigned long ms);
+    void setRepeatInterval(unsigned long ms);
+    void setDoubleTapTime(unsigned long ms);
+
     void DoorUnlock();
     void DoorLock(); 
     void DoorIncorrect();
@@ -82,7 +352,9 @@ public: // Changed constructors to PUBLIC access
     void resetAttempt();
     bool isAttemptCorrect();
     
-    void setCorrectCode(int *code, int codeLength);
+    bool setCorrectCode(int *code, int codeLength);
+    bool stageCorrectCode(int* code, int codeLength);
+    bool commitCorrectCode();
     void setPins(int button1, int button2, int button3, int lockButton, int greenLED, int redLED, int servoPin, int buzzerPin);
     
     
@@ -100,6 +372,8 @@ public: // Changed constructors to PUBLIC access
 
     void redLEDToggle(bool state);
     void greenLEDToggle(bool state);
+    void redLEDBrightness(uint8_t level);
+    void greenLEDBrightness(uint8_t level);
 
     void buzzerOn(int hz);
     void buzzerOff();
@@ -123,8 +397,11 @@ public: // Changed constructors to PUBLIC access
 // This namespace provides the simple, direct function calls for campers.
 // They will use these functions like `DoorLock::unlock()` or `DoorLock::button1Pressed()`.
 namespace DoorLock {
-	// This variable stores the current locked state of the door.
-	extern bool locked;
+	// This variable is the current locked state of the door (the library's own, not a copy).
+	// With DOORLOCK_USE_SERVO_SENSE it changes as soon as the servo is sent to the new position.
+	// If the bolt jams it changes back, but only after every retry has failed (with the default
+	// settings about 2 s: the move, the pause, then a full move again). See isJammed().
+	extern bool& locked;
 
 
     void start(); 
@@ -135,6 +412,61 @@ namespace DoorLock {
                int lockButton, int greenLED, int redLED, int servoPin, int buzzerPin);
 
 	void scanButtons();
+	void useTimerSampling(bool enabled);
+
+    bool runTask(DoorLockTaskFunction task);
+    bool isTaskRunning(DoorLockTaskFunction task);
+    void stopTask(DoorLockTaskFunction task);
+
+    uint8_t lockEvent(uint8_t event);
+    uint8_t lockButtonPressed();
+    void setLockActions(DoorLockTaskFunction unlockTask, DoorLockTaskFunction lockTask,
+                        DoorLockTaskFunction incorrectTask);
+
+    int16_t findCard(const uint8_t* uid, uint8_t length);
+    uint8_t lastCard(uint8_t* uid);
+
+    void setTime(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+    bool setDateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+    bool setAccessWindow(uint8_t user, uint8_t days, uint8_t fromHour, uint8_t fromMinute,
+                         uint8_t toHour, uint8_t toMinute, bool allowed = true);
+    void clearAccessSchedule(uint8_t user);
+    bool setOneTimeSecret(uint8_t slot, const uint8_t* key, uint8_t length);
+    void clearOneTimeSecret(uint8_t slot);
+    void displayMessage(const char* text);
+    bool isJammed();
+
+    void idleUntilEvent();
+
+    bool isActuatorBusy();
+    unsigned long actuationLatency(uint8_t percent);
+    void resetActuationLatency();
+
+    void enableSerialCommands(bool enabled);
+
+    void setAutoRelock(unsigned long seconds, void (*handler)());
+    void setEntryTimeout(unsigned long ms, void (*handler)());
+
+    DoorLockMemoryStats memoryStats();
+    void printMemoryStats();
+
+    void enableWatchdog(unsigned long ms);
+    DoorLockStallReport stallReport();
+    DoorLockStallReport previousStallReport();
+
+    DoorLockTelemetry telemetry();
+    uint8_t telemetrySnapshot(uint8_t* out);
+    void resetTelemetry();
+
+    unsigned long bootTimeMicros();
+
+    DoorLockDebounceReport debounceReport(uint8_t button);
+    void printDebounceReport();
+
+    bool nextButtonEvent(DoorLockButtonEvent& event);
+    void setLongPressTime(unsigned long ms);
+    void setRepeatInterval(unsigned long ms);
+    void setDoubleTapTime(unsigned long ms);
 
     
     void DoorUnlock();
@@ -146,8 +478,11 @@ namespace DoorLock {
     void resetAttempt();
     bool isAttemptCorrect();
 
-    void setCorrectCode(int* code);
-    void setPins(int* pins); // Assumes pins array has a fixed order of all pins
+    bool setCorrectCode(int* code, int codeLength);
+    bool stageCorrectCode(int* code, int codeLength);
+    bool commitCorrectCode();
+    void setPins(int button1, int button2, int button3, int lockButton,
+                 int greenLED, int redLED, int servoPin, int buzzerPin);
 
     void button1Pressed();
     void button2Pressed();
@@ -160,6 +495,8 @@ namespace DoorLock {
 
     void redLEDToggle(bool state);
     void greenLEDToggle(bool state);
+    void redLEDBrightness(uint8_t level);
+    void greenLEDBrightness(uint8_t level);
 
     void buzzerOn(int hz);
     void buzzerOff();
@@ -0,0 +1,105 @@
+#include "FastGpio.h"
+#include "PortExpander.h"
+#include "LinuxGpio.h"
+
+#if defined(__AVR__)
+// Pins that aren't bound yet (or don't exist) read and write this byte instead of a real port.
+static volatile uint8_t _fastPinDummyRegister = 0xFF;
+#endif
+
+_FastPin::_FastPin()
+#if defined(__AVR__)
+    : _in(&_fastPinDummyRegister), _out(&_fastPinDummyRegister), _mask(0)
+#else
+    : _pin(-1), _shadow(nullptr), _mask(0)
+#endif
+{
+}
+
+// Private helper: points the pin at the port expander's RAM copy if it is an expander pin.
+bool _FastPin::_bindExpander(int pin, bool output)
+{
+#if DOORLOCK_USE_EXPANDER
+    if (pin < DL_EXPANDER_PIN) {
+#if !defined(__AVR__)
+        _shadow = nullptr;
+#endif
+        return false;
+    }
+    uint8_t expanderPin = pin - DL_EXPANDER_PIN;
+    volatile uint8_t* shadow = output ? _thePortExpander.bindOutput(expanderPin)
+                                      : _thePortExpander.bindInput(expanderPin);
+#if defined(__AVR__)
+    _in = _out = shadow;
+#else
+    _pin = pin;
+    _shadow = shadow;
+#endif
+    _mask = 1 << (expanderPin & 7);
+    return true;
+#else
+    (void)pin;
+    (void)output;
+    return false;
+#endif
+}
+
+// Private helper: points the pin at the Linux GPIO lines' RAM copy (see LinuxGpio.h).
+bool _FastPin::_bindLinux(int pin, bool output)
+{
+#if DOORLOCK_USE_LINUX_GPIO
+    _pin = pin;
+    _shadow = output ? _theLinuxGpio.bindOutput(pin, &_mask) : _theLinuxGpio.bindInput(pin, &_mask);
+    return true;
+#else
+    (void)pin;
+    (void)output;
+    return false;
+#endif
+}
+
+void _FastPin::bindInput(int pin)
+{
+    if (_bindExpander(pin, false) || _bindLinux(pin, false)) {
+        return;
+    }
+    pinMode(pin, INPUT_PULLUP);
+    // One digitalRead() switches off any PWM timer attached to the pin, so the
+    // direct register reads below always see the real input level.
+    digitalRead(pin);
+#if defined(__AVR__)
+    uint8_t port = digitalPinToPort(pin);
+    if (port == NOT_A_PIN) {
+        _in = _out = &_fastPinDummyRegister;
+        _mask = 0;
+        return;
+    }
+    _in = portInputRegister(port);
+    _out = portOutputRegister(port);
+    _mask = digitalPinToBitMask(pin);
+#else
+    _pin = pin;
+#endif
+}
+
+void _FastPin::bindOutput(int pin)
+{
+    if (_bindExpander(pin, true) || _bindLinux(pin, true)) {
+        return;
+    }
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW); // Also switches off PWM on the pin
+#if defined(__AVR__)
+    uint8_t port = digitalPinToPort(pin);
+    if (port == NOT_A_PIN) {
+        _in = _out = &_fastPinDummyRegister;
+        _mask = 0;
+        return;
+    }
+    _in = portInputRegister(port);
+    _out = portOutputRegister(port);
+    _mask = digitalPinToBitMask(pin);
+#else
+    _pin = pin;
+#endif
+}
@@ -0,0 +1,86 @@
+#ifndef ARDUINO_DOORLOCK_LINUXGPIO_H
+#define ARDUINO_DOORLOCK_LINUXGPIO_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+
+#if DOORLOCK_USE_LINUX_GPIO
+
+// --- Linux GPIO Character Device and PWM ---
+// Runs the lock on a Linux board (Raspberry Pi, BeagleBone...) instead of an Arduino. The pin
+// numbers given to setPins() are then line offsets on the GPIO chip DOORLOCK_LINUX_GPIO_CHIP.
+//
+// The buttons and the LEDs are requested from the kernel through the GPIO character device
+// (uAPI v2, the interface libgpiod 2 is built on, used directly so no library is needed):
+//   - the buttons as one request with pull-ups, edge detection on both edges and the kernel's
+//     debounce (DOORLOCK_LINUX_DEBOUNCE_US, left out on kernels that don't have it). The kernel
+//     queues an event for every edge, and update() takes them in through epoll. The lines are
+//     never polled: while no button changes, a scan costs one epoll_wait() that returns at once.
+//   - the LEDs as another request. Changes are written with one ioctl at most once per
+//     scanButtons(), only if something changed.
+// The levels are kept in RAM, and _FastPin reads and writes that copy. wait() sleeps in
+// epoll_wait() until a button edge or a timeout, so idleUntilEvent() uses no CPU while it waits.
+//
+// The servo and the buzzer are PWM channels DOORLOCK_LINUX_SERVO_PWM and DOORLOCK_LINUX_BUZZER_PWM
+// of the sysfs PWM chip DOORLOCK_LINUX_PWM_CHIP (their pins in setPins() aren't used), so their
+// timing comes from the PWM hardware. The channels have to be routed to pins by the board's
+// device tree, e.g. dtoverlay=pwm-2chan on a Raspberry Pi.
+//
+// Everything else the library uses (millis(), Serial, EEPROM...) still comes from the Arduino
+// core, so the sketch is built against an Arduino core for Linux.
+
+const uint8_t DL_LINUX_GPIO_MAX_LINES = 8; // Buttons, and LEDs, that can be bound at a time
+
+class _LinuxGpio
+{
+public:
+    volatile uint8_t inputs = 0xFF; // Bit per bound button line (in bind order), as last seen
+    volatile uint8_t outputs = 0;   // Bit per bound LED line, what it should be
+
+private:
+    int _chip = -1;          // The GPIO chip, open while any line is bound
+    int _inputRequest = -1;  // Line request of the buttons; its edge events come through _epoll
+    int _outputRequest = -1; // Line request of the LEDs
+    int _epoll = -1;
+    uint32_t _inputLines[DL_LINUX_GPIO_MAX_LINES];
+    uint32_t _outputLines[DL_LINUX_GPIO_MAX_LINES];
+    uint8_t _inputCount = 0;
+    uint8_t _outputCount = 0;
+    uint8_t _written = 0;     // outputs as last written
+    uint32_t _pwmPeriodNs[2] = {0, 0}; // Period each PWM channel is set to (0: not set up yet)
+
+    bool _begin();
+    void _requestInputs();
+    void _requestOutputs();
+    void _readEvents();
+    void _pwmSet(uint8_t channel, uint32_t periodNs, uint32_t dutyNs);
+    void _pwmEnable(uint8_t channel, bool enabled);
+
+public:
+    // Give back every line, so setPins() can bind a new set.
+    void releaseLines();
+
+    // Request one line and return the RAM copy _FastPin should use for it, with its bit in `mask`.
+    volatile uint8_t* bindInput(int line, uint8_t* mask);
+    volatile uint8_t* bindOutput(int line, uint8_t* mask);
+
+    // Once per scanButtons(): writes changed outputs and takes in button edges. Returns true if
+    // there were any.
+    bool update();
+
+    // Sleeps until a button edge (returns true) or for at most timeoutMs (returns false).
+    bool wait(unsigned long timeoutMs);
+
+    void attachServo();
+    void writeServo(int angle);
+    void detachServo();
+
+    void buzzerOn(unsigned int hz);
+    void buzzerOff();
+};
+
+extern _LinuxGpio _theLinuxGpio;
+
+#endif // DOORLOCK_USE_LINUX_GPIO
+
+#endif // ARDUINO_DOORLOCK_LINUXGPIO_H
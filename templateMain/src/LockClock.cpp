@@ -0,0 +1,204 @@
+#include "LockClock.h"
+
+#if DOORLOCK_USE_CLOCK
+
+#if DOORLOCK_USE_DS3231
+#include <Wire.h>
+#endif
+
+const uint32_t SECONDS_PER_DAY = 24UL * 60 * 60;
+const uint32_t SECONDS_PER_WEEK = 7 * SECONDS_PER_DAY;
+const uint32_t SECONDS_PER_SLOT = 15UL * 60;
+const uint8_t SATURDAY = 5;               // 2000-01-01 was a Saturday (day 0 is Monday)
+const unsigned long CLOCK_RETRY_MS = 1000; // How often to look again while the time isn't known
+
+// Days from 2000-01-01 to the given date (2000-2099, so every 4th year is a leap year)
+static uint16_t _daysSince2000(uint8_t year, uint8_t month, uint8_t day)
+{
+    static const uint16_t DAYS_BEFORE_MONTH[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    uint16_t days = year * 365U + (year + 3) / 4 + DAYS_BEFORE_MONTH[month - 1] + day - 1;
+    if (year % 4 == 0 && month > 2) {
+        days++;
+    }
+    return days;
+}
+
+static bool _validDate(uint8_t year, uint8_t month, uint8_t day)
+{
+    static const uint8_t DAYS_IN_MONTH[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return year < 100 && month >= 1 && month <= 12 && day >= 1 && day <= DAYS_IN_MONTH[month - 1] &&
+           !(month == 2 && day == 29 && year % 4 != 0);
+}
+
+#if DOORLOCK_USE_DS3231
+const uint8_t DS3231_ADDRESS = 0x68;
+const uint8_t DS3231_SECONDS = 0x00; // Seconds, minutes, hours, day of the week (1-7), date, month, year
+const uint8_t DS3231_STATUS = 0x0F;
+const uint8_t DS3231_STATUS_OSF = 0x80; // The oscillator stopped (battery flat): the time is wrong
+const uint8_t DS3231_FIRST_YEAR = 24;   // A year before 2024 means the date was never set
+
+static uint8_t _fromBcd(uint8_t value)
+{
+    return (value >> 4) * 10 + (value & 0x0F);
+}
+
+static uint8_t _toBcd(uint8_t value)
+{
+    return ((value / 10) << 4) | (value % 10);
+}
+
+// Reads the time, the date and the status register in one burst (registers 0x00-0x0F).
+void _LockClock::_read(unsigned long now)
+{
+    const uint8_t COUNT = DS3231_STATUS + 1;
+    uint8_t registers[COUNT];
+    _known = UNKNOWN;
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_SECONDS);
+    if (Wire.endTransmission(false) != 0 || Wire.requestFrom(DS3231_ADDRESS, COUNT) != COUNT) {
+        return; // No clock answering
+    }
+    for (uint8_t i = 0; i < COUNT; i++) {
+        registers[i] = Wire.read();
+    }
+    uint8_t weekday = registers[3] & 0x07;
+    if ((registers[DS3231_STATUS] & DS3231_STATUS_OSF) || weekday == 0) {
+        return;
+    }
+    uint8_t hour;
+    if (registers[2] & 0x40) { // 12 hour mode, bit 5 is PM
+        hour = _fromBcd(registers[2] & 0x1F) % 12 + ((registers[2] & 0x20) ? 12 : 0);
+    } else {
+        hour = _fromBcd(registers[2] & 0x3F);
+    }
+    uint32_t timeOfDay = ((uint32_t)hour * 60 + _fromBcd(registers[1] & 0x7F)) * 60 + _fromBcd(registers[0] & 0x7F);
+    uint8_t year = _fromBcd(registers[6]);
+    uint8_t month = _fromBcd(registers[5] & 0x1F);
+    uint8_t day = _fromBcd(registers[4] & 0x3F);
+    if (year >= DS3231_FIRST_YEAR && _validDate(year, month, day)) {
+        _known = DATE;
+        _seconds = _daysSince2000(year, month, day) * SECONDS_PER_DAY + timeOfDay;
+    } else {
+        _known = WEEK_ONLY;
+        _seconds = (weekday - 1) * SECONDS_PER_DAY + timeOfDay;
+    }
+    _atMs = now;
+}
+
+// Writes registers 0x00-0x06 and clears OSF, so the time is good again.
+static void _writeClock(const uint8_t* time)
+{
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_SECONDS);
+    Wire.write(time, 7);
+    Wire.endTransmission();
+    uint8_t status[2] = {DS3231_STATUS, 0x00};
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(status, sizeof(status));
+    Wire.endTransmission();
+}
+
+// Setting only the time of the week also sets the year to 2000, so the old date is forgotten.
+void _LockClock::setWeekTime(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, unsigned long now)
+{
+    uint8_t time[7] = {_toBcd(second), _toBcd(minute), _toBcd(hour), (uint8_t)(day + 1), 0x01, 0x01, 0x00};
+    _writeClock(time);
+    _due = now;
+    poll(now);
+}
+
+bool _LockClock::setDate(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute,
+                         uint8_t second, unsigned long now)
+{
+    if (year < 2000 + DS3231_FIRST_YEAR || year > 2099 || !_validDate(year - 2000, month, day)) {
+        return false;
+    }
+    uint8_t weekday = (_daysSince2000(year - 2000, month, day) + SATURDAY) % 7;
+    uint8_t time[7] = {_toBcd(second), _toBcd(minute), _toBcd(hour), (uint8_t)(weekday + 1),
+                       _toBcd(day), _toBcd(month), _toBcd(year - 2000)};
+    _writeClock(time);
+    _due = now;
+    poll(now);
+    return true;
+}
+
+void _LockClock::begin(unsigned long now)
+{
+    Wire.begin();
+    _due = now;
+    poll(now);
+}
+#else
+// millis() since the last setting. Whole seconds are moved into _seconds each time, so the
+// clock keeps going when millis() wraps around after 49 days.
+void _LockClock::_read(unsigned long now)
+{
+    unsigned long elapsed = (now - _atMs) / 1000;
+    _seconds += elapsed;
+    _atMs += elapsed * 1000;
+    if (_known == WEEK_ONLY) {
+        _seconds %= SECONDS_PER_WEEK;
+    }
+}
+
+void _LockClock::setWeekTime(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, unsigned long now)
+{
+    _known = WEEK_ONLY;
+    _seconds = (((uint32_t)day * 24 + hour) * 60 + minute) * 60 + second;
+    _atMs = now;
+    _due = now;
+    poll(now);
+}
+
+bool _LockClock::setDate(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute,
+                         uint8_t second, unsigned long now)
+{
+    if (year < 2000 || year > 2099 || !_validDate(year - 2000, month, day)) {
+        return false;
+    }
+    _known = DATE;
+    _seconds = _daysSince2000(year - 2000, month, day) * SECONDS_PER_DAY +
+               ((uint32_t)hour * 60 + minute) * 60 + second;
+    _atMs = now;
+    _due = now;
+    poll(now);
+    return true;
+}
+
+void _LockClock::begin(unsigned long now)
+{
+    _due = now;
+    poll(now);
+}
+#endif
+
+// Works out the slot and sleeps until the next one starts.
+void _LockClock::poll(unsigned long now)
+{
+    _read(now);
+    if (_known == UNKNOWN) {
+        _slot = DL_CLOCK_NO_SLOT;
+        _due = now + CLOCK_RETRY_MS;
+        return;
+    }
+    uint32_t seconds = _secondsNow(now);
+    uint32_t secondOfWeek;
+    if (_known == DATE) {
+        secondOfWeek = ((seconds / SECONDS_PER_DAY + SATURDAY) % 7) * SECONDS_PER_DAY + seconds % SECONDS_PER_DAY;
+    } else {
+        secondOfWeek = seconds % SECONDS_PER_WEEK;
+    }
+    _slot = secondOfWeek / SECONDS_PER_SLOT;
+    _due = now + (SECONDS_PER_SLOT - secondOfWeek % SECONDS_PER_SLOT) * 1000UL;
+}
+
+bool _LockClock::unixTime(unsigned long now, uint32_t* seconds) const
+{
+    if (_known != DATE) {
+        return false;
+    }
+    *seconds = DL_CLOCK_UNIX_2000 + _secondsNow(now) - (int32_t)DOORLOCK_UTC_OFFSET_MINUTES * 60;
+    return true;
+}
+
+#endif // DOORLOCK_USE_CLOCK
@@ -0,0 +1,57 @@
+#ifndef ARDUINO_DOORLOCK_LOCKCLOCK_H
+#define ARDUINO_DOORLOCK_LOCKCLOCK_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+
+// --- Clock (for access schedules and one-time codes) ---
+// With DOORLOCK_USE_DS3231 the time comes from a DS3231 real-time clock on I2C, which keeps it
+// while the Arduino is off. Otherwise millis() counts on from the last setTime()/setDateTime(),
+// and the time is lost at every reset.
+//
+// The clock chip is read at start() and then only when the next 15 minutes begin; in between
+// millis() counts on from the last reading. So scanButtons() normally just compares millis()
+// with that moment.
+//
+// The clock runs on local time. It can know just the time of the week (after setTime(), which
+// is all the access schedules need) or the whole date (after setDateTime(), which one-time
+// codes need to work out the Unix time).
+
+const uint16_t DL_CLOCK_NO_SLOT = 0xFFFF; // slot() while the time isn't known
+const uint8_t DL_CLOCK_SLOTS_PER_DAY = 96; // 15 minutes each
+const uint32_t DL_CLOCK_UNIX_2000 = 946684800UL; // Unix time of 2000-01-01 00:00
+
+class _LockClock
+{
+private:
+    enum : uint8_t { UNKNOWN, WEEK_ONLY, DATE };
+    uint8_t _known = UNKNOWN;
+    uint32_t _seconds = 0;          // At _atMs: seconds since 2000-01-01 (DATE) or into the week
+    unsigned long _atMs = 0;        // millis() of _seconds
+    uint16_t _slot = DL_CLOCK_NO_SLOT;
+    unsigned long _due = 0;         // millis() when the slot has to be worked out again
+
+    void _read(unsigned long now);
+    uint32_t _secondsNow(unsigned long now) const { return _seconds + (now - _atMs) / 1000; }
+
+public:
+    void begin(unsigned long now);
+
+    bool due(unsigned long now) const { return (long)(now - _due) >= 0; }
+    void poll(unsigned long now);
+
+    // day 0-6 (Monday-Sunday), hour 0-23, minute 0-59, second 0-59
+    void setWeekTime(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second, unsigned long now);
+    // year 2000-2099, month 1-12, day 1-31. Returns false for a date that doesn't exist.
+    bool setDate(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second,
+                 unsigned long now);
+
+    // 15 minute slot of the week (day * 96 + quarter hour, Monday 00:00 is 0), or DL_CLOCK_NO_SLOT.
+    uint16_t slot() const { return _slot; }
+
+    // Seconds since 1970-01-01 00:00 UTC (using DOORLOCK_UTC_OFFSET_MINUTES). Returns false unless
+    // the date is known.
+    bool unixTime(unsigned long now, uint32_t* seconds) const;
+};
+
+#endif // ARDUINO_DOORLOCK_LOCKCLOCK_H
@@ -0,0 +1,31 @@
+#ifndef ARDUINO_DOORLOCK_MEMORYSTATS_H
+#define ARDUINO_DOORLOCK_MEMORYSTATS_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+
+// --- Memory Usage ---
+// An Uno has only 2 KB of RAM, shared by global variables, the heap (new/malloc, the Servo and
+// Serial buffers...) and the stack. When the stack grows down into the heap the sketch breaks in
+// strange ways without any error. These numbers show how close that is.
+//
+// On AVR boards all the free RAM is filled with a known byte before setup() runs. Whatever the
+// stack later overwrites is no longer that byte, so the lowest point the stack ever reached can
+// be found afterwards (the "high-water mark").
+//
+// On a computer (DOORLOCK_MEMORY_HOOKS) new/delete are counted instead; the stack numbers are 0.
+
+struct DoorLockMemoryStats {
+    uint32_t dataBytes;        // Global variables with a starting value (.data)
+    uint32_t bssBytes;         // Global variables that start at zero (.bss)
+    uint32_t heapUsed;         // Bytes handed out by new/malloc right now
+    uint32_t heapPeak;         // Most bytes handed out at once (DOORLOCK_MEMORY_HOOKS only)
+    uint32_t allocations;      // Number of new/malloc calls so far (DOORLOCK_MEMORY_HOOKS only)
+    uint32_t freeBytes;        // Free RAM: the gap between heap and stack plus freed heap blocks
+    uint32_t largestFreeBlock; // Biggest single piece of that free RAM
+    uint32_t stackFreeMin;     // Smallest the gap between heap and stack has ever been
+};
+
+void _readMemoryStats(DoorLockMemoryStats& stats);
+
+#endif // ARDUINO_DOORLOCK_MEMORYSTATS_H
@@ -0,0 +1,103 @@
+#include "PortExpander.h"
+
+#if DOORLOCK_USE_EXPANDER
+
+#include <Wire.h>
+
+_PortExpander _thePortExpander;
+
+// MCP23017 registers. With IOCON.BANK = 0 (the default) the A and B register of each pair are
+// next to each other, and the address counts up by itself, so one burst covers both ports.
+const uint8_t MCP_IODIR = 0x00;
+const uint8_t MCP_GPINTEN = 0x04;
+const uint8_t MCP_IOCON = 0x0A;
+const uint8_t MCP_GPPU = 0x0C;
+const uint8_t MCP_GPIO = 0x12;
+const uint8_t MCP_OLAT = 0x14;
+const uint8_t MCP_IOCON_MIRROR = 0x40; // INTA and INTB both report changes on either port
+
+// Private helper: starts I2C and the expander the first time a pin is bound.
+void _PortExpander::_begin()
+{
+    if (_started) {
+        return;
+    }
+    _started = true;
+    Wire.begin();
+    Wire.setClock(400000);
+    uint8_t iocon = MCP_IOCON_MIRROR;
+    _writeRegisters(MCP_IOCON, &iocon, 1);
+    _interrupt.bindInput(DOORLOCK_EXPANDER_INT_PIN); // INT is LOW while a change hasn't been read
+}
+
+void _PortExpander::_writeRegisters(uint8_t reg, const uint8_t* values, uint8_t count)
+{
+    Wire.beginTransmission(DOORLOCK_EXPANDER_ADDRESS);
+    Wire.write(reg);
+    Wire.write(values, count);
+    Wire.endTransmission();
+}
+
+// Reads GPIOA and GPIOB in one burst. Reading them also makes the expander let go of INT.
+void _PortExpander::_readInputs()
+{
+    Wire.beginTransmission(DOORLOCK_EXPANDER_ADDRESS);
+    Wire.write(MCP_GPIO);
+    Wire.endTransmission(false); // Repeated start: nobody else gets the bus in between
+    if (Wire.requestFrom((uint8_t)DOORLOCK_EXPANDER_ADDRESS, (uint8_t)2) == 2) {
+        inputs[0] = Wire.read();
+        inputs[1] = Wire.read();
+    }
+}
+
+// Input with pull-up (released buttons read HIGH) and interrupt-on-change.
+volatile uint8_t* _PortExpander::bindInput(uint8_t pin)
+{
+    _begin();
+    uint8_t port = (pin >> 3) & 1;
+    uint8_t bit = 1 << (pin & 7);
+    _direction[port] |= bit;
+    _watched[port] |= bit;
+    _writeRegisters(MCP_IODIR, _direction, 2);
+    _writeRegisters(MCP_GPPU, _watched, 2);
+    _writeRegisters(MCP_GPINTEN, _watched, 2);
+    _readInputs();
+    return &inputs[port];
+}
+
+// Output, driven LOW to start with (like _FastPin::bindOutput()).
+volatile uint8_t* _PortExpander::bindOutput(uint8_t pin)
+{
+    _begin();
+    uint8_t port = (pin >> 3) & 1;
+    uint8_t bit = 1 << (pin & 7);
+    outputs[port] &= ~bit;
+    _written[0] = outputs[0];
+    _written[1] = outputs[1];
+    _writeRegisters(MCP_OLAT, _written, 2); // Latch first, so the pin never drives the old level
+    _direction[port] &= ~bit;
+    _watched[port] &= ~bit;
+    _writeRegisters(MCP_IODIR, _direction, 2);
+    _writeRegisters(MCP_GPPU, _watched, 2);
+    _writeRegisters(MCP_GPINTEN, _watched, 2);
+    return &outputs[port];
+}
+
+void _PortExpander::update()
+{
+    if (!_started) {
+        return;
+    }
+    uint8_t a = outputs[0];
+    uint8_t b = outputs[1];
+    if (a != _written[0] || b != _written[1]) {
+        _written[0] = a;
+        _written[1] = b;
+        _writeRegisters(MCP_OLAT, _written, 2);
+    }
+    if (_interrupt.read() == LOW) {
+        _readInputs();
+    }
+}
+
+#endif // DOORLOCK_USE_EXPANDER
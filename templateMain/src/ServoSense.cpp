@@ -0,0 +1,88 @@
+#include "ServoSense.h"
+
+#if DOORLOCK_USE_SERVO_SENSE
+
+// --- Sampling ---
+// Returns true with a new sample in `value`. On AVR each call picks up the conversion the last
+// call started, and starts the next one. A conversion left over from an earlier move is dropped.
+bool _ServoSense::_sample(uint16_t* value)
+{
+#if defined(__AVR__)
+    bool ready = false;
+    if (_converting) {
+        if (ADCSRA & _BV(ADSC)) {
+            return false; // Still converting
+        }
+        *value = ADC;
+        ready = !_stale; // The current of a move that has ended says nothing about this one
+        _stale = false;
+    }
+    uint8_t channel = DOORLOCK_SERVO_SENSE_PIN >= A0 ? DOORLOCK_SERVO_SENSE_PIN - A0 : DOORLOCK_SERVO_SENSE_PIN;
+    ADMUX = _BV(REFS0) | (channel & 0x07); // AVcc reference, like analogRead()
+    ADCSRA |= _BV(ADSC);
+    _converting = true;
+    return ready;
+#else
+    *value = analogRead(DOORLOCK_SERVO_SENSE_PIN);
+    return true;
+#endif
+}
+
+// --- Watching a Move ---
+void _ServoSense::_startMove(unsigned long travelMs, unsigned long now)
+{
+    _state = MOVING;
+    _startMs = now;
+    _travelMs = travelMs + DL_SERVO_SENSE_GRACE_MS;
+    _level = 0;
+    _stale = _converting;
+}
+
+void _ServoSense::moveStarted(int angle, unsigned long now)
+{
+    int degrees = _angle == DL_SERVO_UNKNOWN_ANGLE ? 180 : (angle > _angle ? angle - _angle : _angle - angle);
+    _angle = angle;
+    _tries = 0;
+    _jammed = false;
+    _startMove(DOORLOCK_SERVO_TRAVEL_MS * (unsigned long)degrees / 180, now);
+}
+
+uint8_t _ServoSense::poll(unsigned long now)
+{
+    if (_state == IDLE) {
+        return DL_SERVO_NONE;
+    }
+    if (_state == WAITING) {
+        if (now - _startMs < DL_SERVO_RETRY_MS) {
+            return DL_SERVO_NONE;
+        }
+        // Where the servo stopped isn't known, so it gets the time of a full move
+        _startMove(DOORLOCK_SERVO_TRAVEL_MS, now);
+        return DL_SERVO_RETRY;
+    }
+
+    uint16_t sample;
+    if (_sample(&sample)) {
+        _level = _level + ((int16_t)(sample - _level) >> 2); // Smooths out the motor's brush noise
+    }
+    if (now - _startMs < _travelMs) {
+        return DL_SERVO_NONE; // A lot of current is normal while it moves
+    }
+    if (_level < DOORLOCK_SERVO_STALL_LEVEL) {
+        _state = IDLE;
+        return DL_SERVO_ARRIVED;
+    }
+
+    // Still pushing after a free move would have finished
+    _tries++;
+    if (_tries > DOORLOCK_SERVO_RETRIES) {
+        _state = IDLE;
+        _jammed = true;
+        return DL_SERVO_JAMMED;
+    }
+    _state = WAITING;
+    _startMs = now;
+    return DL_SERVO_STALLED;
+}
+
+#endif // DOORLOCK_USE_SERVO_SENSE
@@ -0,0 +1,64 @@
+#ifndef ARDUINO_DOORLOCK_SERVOSENSE_H
+#define ARDUINO_DOORLOCK_SERVOSENSE_H
+
+#include <Arduino.h>
+#include "DoorLockConfig.h"
+
+// --- Servo Current Sensing ---
+// A small shunt resistor in the servo's ground lead turns its current into a voltage that an
+// analog pin can read. A servo draws a lot while it moves and little once it holds its position,
+// so every move is given the time a free move of that size takes (DOORLOCK_SERVO_TRAVEL_MS for
+// 180 degrees) plus DL_SERVO_SENSE_GRACE_MS. If the current is still above
+// DOORLOCK_SERVO_STALL_LEVEL after that, the servo is pushing against something: the bolt is
+// stuck. Then the drive is cut (the servo gets no more pulses, so it stops pushing), and after
+// DL_SERVO_RETRY_MS the move is tried again, up to DOORLOCK_SERVO_RETRIES times. If it still
+// doesn't get there the lock reports a jam and leaves the drive off.
+//
+// The current is sampled in the background: on AVR, poll() starts an ADC conversion and picks up
+// the result on the next call instead of waiting the ~110 us analogRead() takes. Samples are only
+// taken while a move is being watched.
+
+const unsigned long DL_SERVO_SENSE_GRACE_MS = 150; // Slack on top of the expected travel time
+const unsigned long DL_SERVO_RETRY_MS = 500;       // Pause with the drive cut before trying again
+const int DL_SERVO_UNKNOWN_ANGLE = -1;             // Before the first move nobody knows where the servo is
+
+enum DoorLockServoEvent : uint8_t {
+    DL_SERVO_NONE = 0,
+    DL_SERVO_ARRIVED, // The move finished: the current dropped in time
+    DL_SERVO_STALLED, // Stalled: cut the drive (a retry follows)
+    DL_SERVO_RETRY,   // Drive to target() again
+    DL_SERVO_JAMMED   // Stalled on the last try: leave the drive cut
+};
+
+class _ServoSense
+{
+private:
+    enum : uint8_t { IDLE, MOVING, WAITING };
+    uint8_t _state = IDLE;
+    uint8_t _tries = 0;            // Stalls so far on this move
+    int _angle = DL_SERVO_UNKNOWN_ANGLE; // Where the last move was going
+    unsigned long _startMs = 0;    // When the move (or the pause before a retry) started
+    unsigned long _travelMs = 0;   // How long the move may draw a lot of current
+    uint16_t _level = 0;           // Filtered current (ADC counts)
+    bool _converting = false;      // An ADC conversion is running (AVR)
+    bool _stale = false;           // That conversion was started for an earlier move
+    bool _jammed = false;
+
+    bool _sample(uint16_t* value);
+    void _startMove(unsigned long travelMs, unsigned long now);
+
+public:
+    // A move to `angle` (0-180) starts now. Forgets an earlier jam.
+    void moveStarted(int angle, unsigned long now);
+
+    // Once per scanButtons(): takes a sample and says what the lock should do.
+    uint8_t poll(unsigned long now);
+
+    // A move (or the pause before a retry) is being watched: poll() has work to do
+    bool watching() const { return _state != IDLE; }
+    int target() const { return _angle; }
+    bool jammed() const { return _jammed; }
+    uint16_t level() const { return _level; }
+};
+
+#endif // ARDUINO_DOORLOCK_SERVOSENSE_H
@@ -0,0 +1,183 @@
+#include "StatusDisplay.h"
+
+#if DOORLOCK_USE_DISPLAY
+
+#include <Wire.h>
+
+// SSD1306 control bytes: what the rest of an I2C write is
+const uint8_t SSD1306_COMMANDS = 0x00;
+const uint8_t SSD1306_DATA = 0x40;
+const uint8_t SSD1306_COLUMN_ADDRESS = 0x21;
+const uint8_t SSD1306_PAGE_ADDRESS = 0x22;
+
+// Display off, clock, multiplex, offset, start line, charge pump on, horizontal addressing,
+// column and row order for a module the right way up, COM pins, contrast, precharge, VCOMH,
+// show RAM, not inverted, display on
+static const uint8_t SSD1306_INIT[] PROGMEM = {
+    0xAE, 0xD5, 0x80, 0xA8, DOORLOCK_DISPLAY_HEIGHT - 1, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00,
+    0xA1, 0xC8, 0xDA, DOORLOCK_DISPLAY_HEIGHT == 64 ? 0x12 : 0x02, 0x81, 0x8F, 0xD9, 0xF1, 0xDB, 0x40,
+    0xA4, 0xA6, 0xAF,
+};
+
+// 5 x 7 font, ' ' to '_'. One byte per pixel column, bit 0 at the top (like the display's pages).
+const uint8_t FONT_FIRST = ' ';
+const uint8_t FONT_LAST = '_';
+const uint8_t FONT_WIDTH = 5;
+static const uint8_t FONT[(FONT_LAST - FONT_FIRST + 1) * FONT_WIDTH] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x07, 0x00, 0x07, 0x00, // ' ' ! "
+    0x14, 0x7F, 0x14, 0x7F, 0x14, 0x24, 0x2A, 0x7F, 0x2A, 0x12, 0x23, 0x13, 0x08, 0x64, 0x62, // # $ %
+    0x36, 0x49, 0x56, 0x20, 0x50, 0x00, 0x08, 0x07, 0x03, 0x00, 0x00, 0x1C, 0x22, 0x41, 0x00, // & ' (
+    0x00, 0x41, 0x22, 0x1C, 0x00, 0x2A, 0x1C, 0x7F, 0x1C, 0x2A, 0x08, 0x08, 0x3E, 0x08, 0x08, // ) * +
+    0x00, 0x50, 0x30, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x60, 0x60, 0x00, 0x00, // , - .
+    0x20, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x51, 0x49, 0x45, 0x3E, 0x00, 0x42, 0x7F, 0x40, 0x00, // / 0 1
+    0x72, 0x49, 0x49, 0x49, 0x46, 0x21, 0x41, 0x49, 0x4D, 0x33, 0x18, 0x14, 0x12, 0x7F, 0x10, // 2 3 4
+    0x27, 0x45, 0x45, 0x45, 0x39, 0x3C, 0x4A, 0x49, 0x49, 0x31, 0x41, 0x21, 0x11, 0x09, 0x07, // 5 6 7
+    0x36, 0x49, 0x49, 0x49, 0x36, 0x46, 0x49, 0x49, 0x29, 0x1E, 0x00, 0x00, 0x14, 0x00, 0x00, // 8 9 :
+    0x00, 0x40, 0x34, 0x00, 0x00, 0x00, 0x08, 0x14, 0x22, 0x41, 0x14, 0x14, 0x14, 0x14, 0x14, // ; < =
+    0x00, 0x41, 0x22, 0x14, 0x08, 0x02, 0x01, 0x59, 0x09, 0x06, 0x3E, 0x41, 0x5D, 0x59, 0x4E, // > ? @
+    0x7C, 0x12, 0x11, 0x12, 0x7C, 0x7F, 0x49, 0x49, 0x49, 0x36, 0x3E, 0x41, 0x41, 0x41, 0x22, // A B C
+    0x7F, 0x41, 0x41, 0x41, 0x3E, 0x7F, 0x49, 0x49, 0x49, 0x41, 0x7F, 0x09, 0x09, 0x09, 0x01, // D E F
+    0x3E, 0x41, 0x41, 0x51, 0x73, 0x7F, 0x08, 0x08, 0x08, 0x7F, 0x00, 0x41, 0x7F, 0x41, 0x00, // G H I
+    0x20, 0x40, 0x41, 0x3F, 0x01, 0x7F, 0x08, 0x14, 0x22, 0x41, 0x7F, 0x40, 0x40, 0x40, 0x40, // J K L
+    0x7F, 0x02, 0x1C, 0x02, 0x7F, 0x7F, 0x04, 0x08, 0x10, 0x7F, 0x3E, 0x41, 0x41, 0x41, 0x3E, // M N O
+    0x7F, 0x09, 0x09, 0x09, 0x06, 0x3E, 0x41, 0x51, 0x21, 0x5E, 0x7F, 0x09, 0x19, 0x29, 0x46, // P Q R
+    0x26, 0x49, 0x49, 0x49, 0x32, 0x03, 0x01, 0x7F, 0x01, 0x03, 0x3F, 0x40, 0x40, 0x40, 0x3F, // S T U
+    0x1F, 0x20, 0x40, 0x20, 0x1F, 0x3F, 0x40, 0x38, 0x40, 0x3F, 0x63, 0x14, 0x08, 0x14, 0x63, // V W X
+    0x03, 0x04, 0x78, 0x04, 0x03, 0x61, 0x59, 0x49, 0x4D, 0x43, 0x00, 0x7F, 0x41, 0x41, 0x41, // Y Z [
+    0x02, 0x04, 0x08, 0x10, 0x20, 0x00, 0x41, 0x41, 0x41, 0x7F, 0x04, 0x02, 0x01, 0x02, 0x04, // \ ] ^
+    0x40, 0x40, 0x40, 0x40, 0x40,                                                             // _
+};
+
+// The character the font has for c
+static char _fontChar(char c)
+{
+    if (c >= 'a' && c <= 'z') {
+        c -= 'a' - 'A';
+    }
+    return (c < FONT_FIRST || c > FONT_LAST) ? '?' : c;
+}
+
+// --- Framebuffer ---
+bool _StatusDisplay::begin()
+{
+    Wire.begin();
+    Wire.setClock(400000);
+    Wire.beginTransmission(DOORLOCK_DISPLAY_ADDRESS);
+    Wire.write(SSD1306_COMMANDS);
+    for (uint8_t i = 0; i < sizeof(SSD1306_INIT); i++) {
+        Wire.write(pgm_read_byte(&SSD1306_INIT[i]));
+    }
+    _present = Wire.endTransmission() == 0;
+    _addressRow = 0xFF;
+
+    // Whatever the display's RAM holds after power-up gets overwritten with blanks
+    for (uint8_t row = 0; row < DL_DISPLAY_ROWS; row++) {
+        for (uint8_t column = 0; column < DL_DISPLAY_COLUMNS; column++) {
+            _cells[row][column] = ' ';
+        }
+        _dirtyFirst[row] = 0;
+        _dirtyLast[row] = DL_DISPLAY_COLUMNS - 1;
+    }
+    return _present;
+}
+
+void _StatusDisplay::_markDirty(uint8_t row, uint8_t column)
+{
+    if (_dirtyFirst[row] == DL_DISPLAY_CLEAN) {
+        _dirtyFirst[row] = column;
+        _dirtyLast[row] = column;
+    } else if (column < _dirtyFirst[row]) {
+        _dirtyFirst[row] = column;
+    } else if (column > _dirtyLast[row]) {
+        _dirtyLast[row] = column;
+    }
+}
+
+// Both print()s: only cells that change are marked. `flash`: text is in PROGMEM.
+void _StatusDisplay::_print(uint8_t row, uint8_t column, const char* text, bool flash, uint8_t width)
+{
+    if (row >= DL_DISPLAY_ROWS) {
+        return;
+    }
+    bool ended = text == nullptr;
+    for (uint8_t i = 0; i < width && column + i < DL_DISPLAY_COLUMNS; i++) {
+        char c = ended ? 0 : flash ? (char)pgm_read_byte(text + i) : text[i];
+        ended = c == 0;
+        c = ended ? ' ' : _fontChar(c);
+        if (_cells[row][column + i] != c) {
+            _cells[row][column + i] = c;
+            _markDirty(row, column + i);
+        }
+    }
+}
+
+void _StatusDisplay::print(uint8_t row, uint8_t column, const char* text, uint8_t width)
+{
+    _print(row, column, text, false, width);
+}
+
+void _StatusDisplay::print(uint8_t row, uint8_t column, const __FlashStringHelper* text, uint8_t width)
+{
+    _print(row, column, (const char*)text, true, width);
+}
+
+// --- Sending ---
+void _StatusDisplay::_sendCommands(const uint8_t* commands, uint8_t count)
+{
+    Wire.beginTransmission(DOORLOCK_DISPLAY_ADDRESS);
+    Wire.write(SSD1306_COMMANDS);
+    Wire.write(commands, count);
+    Wire.endTransmission();
+}
+
+// The top dirty row goes first, DL_DISPLAY_CHUNK characters at a time from the left.
+void _StatusDisplay::update()
+{
+    if (!_present) {
+        return;
+    }
+    uint8_t row = 0;
+    while (row < DL_DISPLAY_ROWS && _dirtyFirst[row] == DL_DISPLAY_CLEAN) {
+        row++;
+    }
+    if (row == DL_DISPLAY_ROWS) {
+        return;
+    }
+    uint8_t first = _dirtyFirst[row];
+    uint8_t last = _dirtyLast[row];
+    if (last - first >= DL_DISPLAY_CHUNK) {
+        last = first + DL_DISPLAY_CHUNK - 1;
+    }
+
+    if (row != _addressRow || first != _addressColumn) {
+        // Write from the first cell to the right edge of this row (and on into the next rows)
+        uint8_t commands[6] = {SSD1306_COLUMN_ADDRESS, (uint8_t)(first * (FONT_WIDTH + 1)), 127,
+                               SSD1306_PAGE_ADDRESS, row, DL_DISPLAY_ROWS - 1};
+        _sendCommands(commands, sizeof(commands));
+    }
+
+    Wire.beginTransmission(DOORLOCK_DISPLAY_ADDRESS);
+    Wire.write(SSD1306_DATA);
+    for (uint8_t column = first; column <= last; column++) {
+        const uint8_t* glyph = &FONT[(_cells[row][column] - FONT_FIRST) * FONT_WIDTH];
+        for (uint8_t x = 0; x < FONT_WIDTH; x++) {
+            Wire.write(pgm_read_byte(glyph + x));
+        }
+        Wire.write((uint8_t)0);
+        if (column == DL_DISPLAY_COLUMNS - 1) {
+            Wire.write((uint8_t)0); // Pixels 126 and 127, right of the last cell
+            Wire.write((uint8_t)0);
+        }
+    }
+    Wire.endTransmission();
+
+    if (last == DL_DISPLAY_COLUMNS - 1) {
+        _addressRow = 0xFF; // The display wraps to the start of the column window, not to cell 0
+    } else {
+        _addressRow = row;
+        _addressColumn = last + 1;
+    }
+    _dirtyFirst[row] = last == _dirtyLast[row] ? DL_DISPLAY_CLEAN : last + 1;
+}
+
+#endif // DOORLOCK_USE_DISPLAY
@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+"""Host-side client for the DoorLock binary Serial command channel.
+
+The sketch has to call DoorLock::enableSerialCommands(true) first. Frames are
+COBS-encoded (payload + CRC-16/CCITT-FALSE, little-endian) and end with 0x00;
+see src/SerialFrame.h for the layout of every command and reply.
+
+Works with a real board (/dev/ttyACM0, /dev/ttyUSB0, ...) or with any pty,
+e.g. one end of `socat -d -d pty,raw,echo=0 pty,raw,echo=0`. Only the Python
+standard library is used.
+
+    doorlock_client.py /dev/ttyACM0 status
+    doorlock_client.py /dev/ttyACM0 enroll 1 3 2 2
+    doorlock_client.py /dev/ttyACM0 unlock
+    doorlock_client.py /dev/ttyACM0 lock
+    doorlock_client.py /dev/ttyACM0 stats
+    doorlock_client.py /dev/ttyACM0 audit
+    doorlock_client.py /dev/ttyACM0 memory
+    doorlock_client.py /dev/ttyACM0 telemetry [--reset]
+    doorlock_client.py /dev/ttyACM0 time [DAY HOUR MINUTE SECOND]
+    doorlock_client.py /dev/ttyACM0 time YEAR MONTH DAY HOUR MINUTE SECOND
+    doorlock_client.py /dev/ttyACM0 schedule USER DAYS FIRST_SLOT COUNT [--deny | --clear]
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import termios
+import time
+
+CMD_STATUS = 0x01
+CMD_ENROLL = 0x02
+CMD_LOCK = 0x03
+CMD_UNLOCK = 0x04
+CMD_STATS = 0x05
+CMD_AUDIT = 0x06
+CMD_MEMORY = 0x07
+CMD_TELEMETRY = 0x08
+CMD_SCHEDULE = 0x09
+CMD_TIME = 0x0A
+REPLY_FLAG = 0x80
+
+STATUS_NAMES = {0: "ok", 1: "unknown command", 2: "bad arguments"}
+AUDIT_EVENTS = {
+    1: "boot",
+    2: "unlock",
+    3: "lock",
+    4: "incorrect",
+    5: "code changed",
+    6: "remote unlock",
+    7: "remote lock",
+    8: "badge",
+    9: "one-time code",
+    10: "jam",
+}
+
+DAY_NAMES = ("Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday")
+NO_TIME = 0xFFFF
+
+# Telemetry snapshot, version 2 (see src/Telemetry.h). Version 1 is the same without the last field.
+TELEMETRY_FORMAT = "<BI4H4H4HHIH"
+TELEMETRY_SIZE = struct.calcsize(TELEMETRY_FORMAT)
+TELEMETRY_V1_FORMAT = TELEMETRY_FORMAT[:-1]
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, same as _crc16() in SerialFrame.cpp."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block = bytearray()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(0xFF)
+                out += block
+                block = bytearray()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frame(payload):
+    crc = crc16(payload)
+    return b"\x00" + cobs_encode(payload + struct.pack("<H", crc)) + b"\x00"
+
+
+def decode_frame(raw):
+    """Returns the payload of a raw frame (without delimiters), or None if it isn't a valid frame."""
+    try:
+        data = cobs_decode(raw)
+    except ValueError:
+        return None
+    if len(data) < 3:
+        return None
+    payload, crc = data[:-2], struct.unpack("<H", data[-2:])[0]
+    return payload if crc16(payload) == crc else None
+
+
+def decode_telemetry(snapshot):
+    """Turns a telemetry snapshot (from the Serial command or any other transport) into a dict."""
+    layout = {1: TELEMETRY_V1_FORMAT, 2: TELEMETRY_FORMAT}.get(snapshot[0] if snapshot else None)
+    if layout is None or len(snapshot) < struct.calcsize(layout):
+        raise ValueError("not a version 1 or 2 telemetry snapshot")
+    values = struct.unpack(layout, bytes(snapshot[:struct.calcsize(layout)]))
+    buttons = ("button1", "button2", "button3", "lock_button")
+    entries, entry_time = values[14], values[15]
+    result = {
+        "uptime_ms": values[1],
+        "unlocks": values[2],
+        "locks": values[3],
+        "incorrect": values[4],
+        "servo_moves": values[5],
+        "key_presses": dict(zip(buttons, values[6:10])),
+        "bounces": dict(zip(buttons, values[10:14])),
+        "codes_entered": entries,
+        "mean_entry_ms": entry_time / entries if entries else 0.0,
+    }
+    if len(values) > 16:
+        result["button_events_dropped"] = values[16]
+    return result
+
+
+class DoorLockClient:
+    def __init__(self, path, baud=115200, timeout=2.0):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        self.timeout = timeout
+        self.sequence = 0
+        self.pending = bytearray()
+        attrs = termios.tcgetattr(self.fd)
+        speed = getattr(termios, "B%d" % baud, termios.B115200)
+        attrs[0] = 0                                  # iflag: raw
+        attrs[1] = 0                                  # oflag: raw
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[3] = 0                                  # lflag: no echo, no line editing
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+
+    def close(self):
+        os.close(self.fd)
+
+    def request(self, command, args=b""):
+        self.sequence = (self.sequence + 1) & 0xFF
+        os.write(self.fd, encode_frame(bytes([command, self.sequence]) + bytes(args)))
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            for raw in self._read_chunks(deadline):
+                payload = decode_frame(raw)
+                if payload is None:
+                    text = raw.decode("ascii", "replace").strip()
+                    if text:
+                        print("[log] " + text, file=sys.stderr)
+                    continue
+                if payload[0] == command | REPLY_FLAG and payload[1] == self.sequence:
+                    status = payload[2]
+                    if status != 0:
+                        raise RuntimeError(STATUS_NAMES.get(status, "status %d" % status))
+                    return payload[3:]
+        raise TimeoutError("no reply from the door lock")
+
+    def _read_chunks(self, deadline):
+        """Yields the bytes between 0x00 delimiters as they arrive."""
+        wait = max(0.0, deadline - time.monotonic())
+        ready, _, _ = select.select([self.fd], [], [], wait)
+        if not ready:
+            return
+        self.pending += os.read(self.fd, 256)
+        while b"\x00" in self.pending:
+            chunk, _, rest = bytes(self.pending).partition(b"\x00")
+            self.pending = bytearray(rest)
+            if chunk:
+                yield chunk
+
+    # --- Commands ---
+
+    def status(self):
+        locked, entered, length, busy, uptime = struct.unpack("<BBBBI", self.request(CMD_STATUS))
+        return {"locked": bool(locked), "digits_entered": entered, "code_length": length,
+                "actuator_busy": bool(busy), "uptime_ms": uptime}
+
+    def enroll(self, digits):
+        self.request(CMD_ENROLL, bytes([len(digits)] + list(digits)))
+
+    def lock(self):
+        self.request(CMD_LOCK)
+
+    def unlock(self):
+        self.request(CMD_UNLOCK)
+
+    def stats(self):
+        p50, p99, audit_entries = struct.unpack("<IIB", self.request(CMD_STATS)[:9])
+        return {"actuation_p50_us": p50, "actuation_p99_us": p99, "audit_entries": audit_entries}
+
+    def audit(self):
+        entries = []
+        first = 0
+        while True:
+            data = self.request(CMD_AUDIT, bytes([first]))
+            total = data[0]
+            for offset in range(2, len(data), 5):
+                event, ms = struct.unpack("<BI", data[offset:offset + 5])
+                entries.append((ms, AUDIT_EVENTS.get(event, "event %d" % event)))
+            first += (len(data) - 2) // 5
+            if first >= total or len(data) <= 2:
+                return entries
+
+    def memory(self):
+        fields = ("data_bytes", "bss_bytes", "heap_used", "heap_peak", "allocations",
+                  "free_bytes", "largest_free_block", "stack_free_min")
+        return dict(zip(fields, struct.unpack("<8I", self.request(CMD_MEMORY)[:32])))
+
+    def telemetry(self, reset=False):
+        return decode_telemetry(self.request(CMD_TELEMETRY, bytes([1 if reset else 0])))
+
+    def time(self, fields=()):
+        """Sets the clock when given: day (0 = Monday), hour, minute, second, or year, month, day, hour,
+        minute, second for the date too. Returns the 15 minute slot of the week or None."""
+        fields = list(fields)
+        if len(fields) == 6:
+            fields[0] -= 2000
+        slot = struct.unpack("<H", self.request(CMD_TIME, bytes(fields))[:2])[0]
+        return None if slot == NO_TIME else slot
+
+    def schedule(self, user, days, first_slot, count, mode=1):
+        """mode: 1 lets the user in during the slots, 0 keeps them out, 2 removes their schedule."""
+        self.request(CMD_SCHEDULE, bytes([user, days, first_slot, count, mode]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", help="serial device or pty, e.g. /dev/ttyACM0")
+    parser.add_argument("command", choices=["status", "enroll", "lock", "unlock", "stats", "audit", "memory",
+                                            "telemetry", "time", "schedule"])
+    parser.add_argument("digits", nargs="*", type=int,
+                        help="enroll: new code (each 1-3); time: day (0 = Monday) hour minute second, "
+                             "or year month day hour minute second; "
+                             "schedule: user, day mask (bit 0 = Monday), first 15 minute slot, slot count")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--reset", action="store_true", help="telemetry: clear the counters after reading")
+    parser.add_argument("--deny", action="store_true", help="schedule: keep the user out during the slots")
+    parser.add_argument("--clear", action="store_true", help="schedule: remove the user's schedule")
+    args = parser.parse_args()
+
+    client = DoorLockClient(args.port, args.baud)
+    try:
+        if args.command == "status":
+            for key, value in client.status().items():
+                print("%s: %s" % (key, value))
+        elif args.command == "enroll":
+            client.enroll(args.digits)
+            print("code updated")
+        elif args.command == "lock":
+            client.lock()
+            print("locking")
+        elif args.command == "unlock":
+            client.unlock()
+            print("unlocking")
+        elif args.command in ("stats", "memory"):
+            for key, value in getattr(client, args.command)().items():
+                print("%s: %s" % (key, value))
+        elif args.command == "telemetry":
+            for key, value in client.telemetry(args.reset).items():
+                print("%s: %s" % (key, value))
+        elif args.command == "time":
+            slot = client.time(args.digits)
+            if slot is None:
+                print("time not set")
+            else:
+                print("%s %02d:%02d" % (DAY_NAMES[slot // 96], slot % 96 // 4, slot % 4 * 15))
+        elif args.command == "schedule":
+            user, days, first_slot, count = (args.digits + [0, 0, 0, 0])[:4]
+            client.schedule(user, days, first_slot, count, 2 if args.clear else 0 if args.deny else 1)
+            print("schedule updated")
+        elif args.command == "audit":
+            for ms, event in client.audit():
+                print("%10d ms  %s" % (ms, event))
+    finally:
+        client.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Host benchmarks of the DoorLock library, with a baseline to compare against.
+
+Builds the library from a sketch's src/ folder (exampleMain by default) plus
+the sketch itself for the PC, against the small Arduino stand-in in
+tools/host_bench/arduino, and runs tools/host_bench/bench.cpp. The results
+(ns/op and allocations/op per benchmark) are printed as JSON, or written to a
+file with --output. With --baseline the new results are compared to an older
+JSON file and the script exits with status 1 if any benchmark got slower by
+more than --threshold percent or started allocating.
+
+The "latency" part of the results is the actuator queue run on two threads,
+an input thread posting feedback and an actuator thread carrying it out, with
+the p50 and p99 of the time between the two. It depends on the scheduler more
+than on the code, so --baseline shows it but doesn't fail on it.
+
+ns/op depends on the PC, so only compare results from the same machine. Needs
+a C++11 compiler (g++ or clang++, or $CXX). Only the Python standard library
+is used.
+
+    host_bench.py --output before.json
+    host_bench.py --baseline before.json
+    host_bench.py --filter scanButtons --baseline before.json
+    host_bench.py -D DOORLOCK_USE_RFID=1 --filter rfid
+    host_bench.py -D DOORLOCK_USE_TOTP=1 --filter totp
+    host_bench.py -D DOORLOCK_USE_DISPLAY=1 --filter display
+    host_bench.py -D DOORLOCK_USE_SERVO_SENSE=1 --filter servo
+    host_bench.py -D DOORLOCK_USE_EXPANDER=1 --filter expander
+"""
+
+import argparse
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HOST = os.path.join(REPO, "tools", "host_bench")
+
+
+def build(sketch, compiler, build_dir, defines, main="bench.cpp", with_sketch=True):
+    """Compiles the benchmark (or another program in tools/host_bench, see host_test.py) and
+    returns the path of the program."""
+    library = os.path.join(sketch, "src")
+    program = os.path.join(build_dir, os.path.splitext(main)[0])
+    sources = sorted(glob.glob(os.path.join(library, "*.cpp")))
+    sources += sorted(glob.glob(os.path.join(HOST, "arduino", "*.cpp"))) + [os.path.join(HOST, main)]
+    if with_sketch:
+        sources += ["-x", "c++", os.path.join(sketch, os.path.basename(sketch) + ".ino"), "-x", "none"]
+    command = [compiler, "-std=gnu++11", "-O2", "-pthread", "-DNDEBUG", "-DDOORLOCK_MEMORY_HOOKS=1"]
+    command += ["-D" + define for define in defines]
+    command += ["-I" + os.path.join(HOST, "arduino"), "-I" + library, "-o", program] + sources
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout)
+        sys.exit("build failed")
+    return program
+
+
+def compare(baseline, results, threshold):
+    """Prints a table of old vs new; returns False if anything got worse."""
+    old = dict((entry["name"], entry) for entry in baseline["benchmarks"])
+    ok = True
+    print("| benchmark | ns/op before | ns/op now | change | allocs/op before | allocs/op now |")
+    print("|---|---:|---:|---:|---:|---:|")
+    for entry in results["benchmarks"]:
+        before = old.get(entry["name"])
+        if before is None:
+            print("| %s | - | %.1f | new | - | %.4f |" % (entry["name"], entry["ns_per_op"], entry["allocs_per_op"]))
+            continue
+        change = (entry["ns_per_op"] - before["ns_per_op"]) * 100.0 / before["ns_per_op"]
+        flag = ""
+        if change > threshold or entry["allocs_per_op"] > before["allocs_per_op"]:
+            flag = " **worse**"
+            ok = False
+        print("| %s | %.1f | %.1f | %+.1f%%%s | %.4f | %.4f |" % (
+            entry["name"], before["ns_per_op"], entry["ns_per_op"], change, flag,
+            before["allocs_per_op"], entry["allocs_per_op"]))
+
+    old = dict((entry["name"], entry) for entry in baseline.get("latency", []))
+    if results.get("latency"):
+        print("")
+        print("| latency | p50 us before | p50 us now | p99 us before | p99 us now |")
+        print("|---|---:|---:|---:|---:|")
+    for entry in results.get("latency", []):
+        before = old.get(entry["name"], {})
+        print("| %s | %s | %d | %s | %d |" % (entry["name"], before.get("p50_us", "-"), entry["p50_us"],
+                                            before.get("p99_us", "-"), entry["p99_us"]))
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("sketch", nargs="?", default="exampleMain",
+                        help="sketch folder in this repository (default: exampleMain)")
+    parser.add_argument("-D", dest="defines", action="append", default=[], metavar="NAME=VALUE",
+                        help="library build option, e.g. -D DOORLOCK_USE_RFID=1 (can be repeated)")
+    parser.add_argument("--filter", default="", help="only run benchmarks whose name contains this")
+    parser.add_argument("--output", metavar="FILE", help="write the JSON results to FILE")
+    parser.add_argument("--baseline", metavar="FILE", help="compare against an earlier JSON result")
+    parser.add_argument("--threshold", type=float, default=10.0, metavar="PERCENT",
+                        help="slowdown that counts as worse with --baseline (default: 10)")
+    args = parser.parse_args()
+
+    compiler = os.environ.get("CXX") or shutil.which("g++") or shutil.which("clang++")
+    if not compiler:
+        sys.exit("no C++ compiler found; set CXX")
+
+    work = tempfile.mkdtemp(prefix="doorlock-bench-")
+    try:
+        program = build(os.path.join(REPO, args.sketch), compiler, work, args.defines)
+        output = subprocess.check_output([program, args.filter], universal_newlines=True)
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+    results = json.loads(output)
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2)
+            f.write("\n")
+    elif not args.baseline:
+        sys.stdout.write(output)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if not compare(baseline, results, args.threshold):
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,97 @@
+#ifndef DOORLOCK_HOST_ARDUINO_H
+#define DOORLOCK_HOST_ARDUINO_H
+
+// --- Host Arduino Core ---
+// Just enough of the Arduino core to build the DoorLock library on a PC for the benchmarks in
+// tools/host_bench. Pins are plain variables, time only moves when the benchmark moves it
+// (hostAdvanceMicros) or the library calls delay(), and Serial output is only kept as far as
+// hostSerialTake() needs it.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+// Analog inputs, numbered like the Uno's
+static const uint8_t A0 = 14, A1 = 15, A2 = 16, A3 = 17, A4 = 18, A5 = 19, A6 = 20, A7 = 21;
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+
+class __FlashStringHelper;
+#define F(text) ((const __FlashStringHelper*)(text))
+
+typedef uint8_t byte;
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+void analogWrite(uint8_t pin, int value);
+int analogRead(uint8_t pin);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+inline void interrupts() {}
+inline void noInterrupts() {}
+
+class Print
+{
+public:
+    size_t write(uint8_t value);
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t print(const char* text);
+    size_t print(const __FlashStringHelper* text);
+    size_t print(char value);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+    size_t println();
+    template <typename T> size_t println(T value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+    template <typename T> size_t println(T value, int format)
+    {
+        size_t n = print(value, format);
+        return n + println();
+    }
+};
+
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud);
+    int available();
+    int availableForWrite();
+    int read();
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// --- Benchmark Controls ---
+void hostSetPin(uint8_t pin, uint8_t level);
+void hostAdvanceMicros(unsigned long us);
+unsigned long hostSerialBytes(); // Bytes the library wrote to Serial so far
+void hostSerialInput(const uint8_t* data, size_t size); // Bytes for Serial.read() to return
+size_t hostSerialTake(uint8_t* buffer, size_t size);    // Output since the last call (the first 256 bytes)
+
+#endif // DOORLOCK_HOST_ARDUINO_H
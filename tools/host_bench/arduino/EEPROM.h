@@ -0,0 +1,22 @@
+#ifndef DOORLOCK_HOST_EEPROM_H
+#define DOORLOCK_HOST_EEPROM_H
+
+#include <stdint.h>
+
+// 1 KB of EEPROM (like the ATmega328P) kept in RAM, erased (0xFF) at startup.
+class EEPROMClass
+{
+private:
+    uint8_t _bytes[1024];
+
+public:
+    EEPROMClass();
+    uint8_t read(int address) { return _bytes[address]; }
+    void write(int address, uint8_t value) { _bytes[address] = value; }
+    void update(int address, uint8_t value) { _bytes[address] = value; }
+    uint16_t length() { return sizeof(_bytes); }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // DOORLOCK_HOST_EEPROM_H
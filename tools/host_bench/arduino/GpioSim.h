@@ -0,0 +1,17 @@
+#ifndef DOORLOCK_HOST_GPIOSIM_H
+#define DOORLOCK_HOST_GPIOSIM_H
+
+#include <stdint.h>
+
+// --- Host Linux GPIO and PWM ---
+// A simulated /dev/gpiochip0 and /sys/class/pwm/pwmchip0 (gpio_sim_host.cpp), for the library
+// built with DOORLOCK_USE_LINUX_GPIO=1. The chip has 64 lines, all HIGH until set otherwise.
+
+// --- Benchmark Controls ---
+void hostGpioLine(uint8_t line, uint8_t level); // Drives an input line; queues an edge event if requested
+uint8_t hostGpioOutput(uint8_t line);           // Level the library drives on an output line
+bool hostGpioRequested(uint8_t line);           // The line is part of a line request
+unsigned long hostGpioReads();                  // Line value reads (GET_VALUES ioctls) so far
+unsigned long hostPwm(uint8_t channel, const char* file); // e.g. hostPwm(0, "duty_cycle"), in ns
+
+#endif // DOORLOCK_HOST_GPIOSIM_H
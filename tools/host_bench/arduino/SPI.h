@@ -0,0 +1,35 @@
+#ifndef DOORLOCK_HOST_SPI_H
+#define DOORLOCK_HOST_SPI_H
+
+#include <stdint.h>
+
+// --- Host SPI Bus ---
+// The bus has one device on it: a simulated MFRC522 RFID reader (mfrc522_host.cpp) with an
+// ISO 14443A card that the benchmark can hold against it or take away.
+
+#define MSBFIRST 1
+#define SPI_MODE0 0x00
+
+class SPISettings
+{
+public:
+    SPISettings() {}
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass
+{
+public:
+    void begin() {}
+    void beginTransaction(SPISettings); // Every register access starts with an address byte
+    void endTransaction() {}
+    uint8_t transfer(uint8_t value);
+};
+
+extern SPIClass SPI;
+
+// --- Benchmark Controls ---
+void hostRfidCard(const uint8_t* uid, uint8_t length); // Holds a card on the reader (length 0: none)
+unsigned long hostSpiBytes();                          // Bytes sent over SPI so far
+
+#endif // DOORLOCK_HOST_SPI_H
@@ -0,0 +1,42 @@
+#ifndef DOORLOCK_HOST_SERVO_H
+#define DOORLOCK_HOST_SERVO_H
+
+#include <stdint.h>
+
+// Passes everything on to the simulated servo in servo_host.cpp (there is only one).
+void _hostServoAttach(int pin);
+void _hostServoDetach();
+void _hostServoWrite(int angle);
+
+class Servo
+{
+private:
+    int _pin = -1;
+    int _angle = 0;
+
+public:
+    uint8_t attach(int pin)
+    {
+        _pin = pin;
+        _hostServoAttach(pin);
+        return 0;
+    }
+    void detach()
+    {
+        _pin = -1;
+        _hostServoDetach();
+    }
+    bool attached() { return _pin >= 0; }
+    void write(int angle)
+    {
+        _angle = angle;
+        _hostServoWrite(angle);
+    }
+    int read() { return _angle; }
+};
+
+// --- Benchmark Controls ---
+void hostServoJam(int angle); // Something stops the horn at this angle; -1 takes it away
+int hostServoAngle();         // Where the horn really is
+
+#endif // DOORLOCK_HOST_SERVO_H
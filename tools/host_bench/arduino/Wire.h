@@ -0,0 +1,41 @@
+#ifndef DOORLOCK_HOST_WIRE_H
+#define DOORLOCK_HOST_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// --- Host I2C Bus ---
+// Three simulated devices are on the bus (wire_host.cpp):
+//   0x20  an MCP23017 port expander (mcp23017_host.cpp) whose pins the benchmark can set, with
+//         its INT line wired to an Arduino pin
+//   0x3C  an SSD1306 OLED (ssd1306_host.cpp) whose picture can be read back or dumped
+//   0x68  a DS3231 real-time clock (ds3231_host.cpp) that runs with the simulated clock
+
+class TwoWire
+{
+public:
+    void begin() {}
+    void setClock(uint32_t) {}
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t value);
+    size_t write(const uint8_t* values, size_t count);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t count, uint8_t stop = 1);
+    int available();
+    int read();
+};
+
+extern TwoWire Wire;
+
+// --- Benchmark Controls ---
+void hostExpanderPin(uint8_t pin, uint8_t level); // Sets an expander input pin (0-15)
+uint8_t hostExpanderOutput(uint8_t pin);           // Level the expander drives on a pin (0-15)
+void hostExpanderIntPin(uint8_t pin);              // Arduino pin INTA is wired to (default 2)
+void hostRtcLoseTime();                            // The clock's battery runs flat (OSF set)
+uint8_t hostDisplayPixel(uint8_t x, uint8_t y);    // 1 if the OLED pixel is lit (0,0 is top left)
+void hostDisplayDump(FILE* out, uint8_t rows);     // The OLED picture as a PBM image, 32 or 64 rows
+unsigned long hostDisplayDataBytes();              // Picture bytes sent to the OLED so far
+unsigned long hostI2cBytes();                      // Bytes sent over I2C so far, addresses included
+
+#endif // DOORLOCK_HOST_WIRE_H
@@ -0,0 +1,204 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+// --- Pins and Time ---
+static uint8_t _pinLevel[128];
+static unsigned long _nowMicros = 0;
+static unsigned long _serialBytes = 0;
+static uint8_t _serialOut[256];   // Output since the last hostSerialTake()
+static size_t _serialOutLength = 0;
+static uint8_t _serialIn[256];    // Input not read yet
+static size_t _serialInHead = 0;
+static size_t _serialInLength = 0;
+
+int _hostServoCurrent(uint8_t pin); // servo_host.cpp
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (mode == INPUT_PULLUP) {
+        _pinLevel[pin] = HIGH; // Nothing pressed
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    return _pinLevel[pin];
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    _pinLevel[pin] = value;
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+    _pinLevel[pin] = value ? HIGH : LOW;
+}
+
+// Only the servo's current sense pin reads anything (see servo_host.cpp)
+int analogRead(uint8_t pin)
+{
+    int current = _hostServoCurrent(pin);
+    return current >= 0 ? current : 0;
+}
+
+unsigned long millis()
+{
+    return _nowMicros / 1000;
+}
+
+unsigned long micros()
+{
+    return _nowMicros;
+}
+
+// Waiting is instant: only the clock moves.
+void delay(unsigned long ms)
+{
+    _nowMicros += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    _nowMicros += us;
+}
+
+void tone(uint8_t, unsigned int, unsigned long) {}
+void noTone(uint8_t) {}
+
+void hostSetPin(uint8_t pin, uint8_t level)
+{
+    _pinLevel[pin] = level;
+}
+
+void hostAdvanceMicros(unsigned long us)
+{
+    _nowMicros += us;
+}
+
+unsigned long hostSerialBytes()
+{
+    return _serialBytes;
+}
+
+void hostSerialInput(const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size && _serialInLength < sizeof(_serialIn); i++) {
+        _serialIn[(_serialInHead + _serialInLength++) % sizeof(_serialIn)] = data[i];
+    }
+}
+
+size_t hostSerialTake(uint8_t* buffer, size_t size)
+{
+    size_t length = _serialOutLength < size ? _serialOutLength : size;
+    memcpy(buffer, _serialOut, length);
+    _serialOutLength = 0;
+    return length;
+}
+
+// --- Serial ---
+// Output is counted and the start of it kept for hostSerialTake(); formatting still happens so
+// the cost of logging is measured.
+size_t Print::write(uint8_t value)
+{
+    return write(&value, 1);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    for (size_t i = 0; i < size && _serialOutLength < sizeof(_serialOut); i++) {
+        _serialOut[_serialOutLength++] = buffer[i];
+    }
+    _serialBytes += size;
+    return size;
+}
+
+size_t Print::print(const char* text)
+{
+    return write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::print(const __FlashStringHelper* text)
+{
+    return print((const char*)text);
+}
+
+size_t Print::print(char value)
+{
+    return write((uint8_t)value);
+}
+
+static size_t _printFormatted(Print& out, const char* format, ...)
+{
+    char text[40];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return out.print(text);
+}
+
+size_t Print::print(int value, int base)
+{
+    return base == HEX ? _printFormatted(*this, "%X", (unsigned)value) : _printFormatted(*this, "%d", value);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return _printFormatted(*this, base == HEX ? "%X" : "%u", value);
+}
+
+size_t Print::print(long value, int base)
+{
+    return base == HEX ? _printFormatted(*this, "%lX", (unsigned long)value) : _printFormatted(*this, "%ld", value);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    return _printFormatted(*this, base == HEX ? "%lX" : "%lu", value);
+}
+
+size_t Print::print(double value, int digits)
+{
+    return _printFormatted(*this, "%.*f", digits, value);
+}
+
+size_t Print::println()
+{
+    return print("\r\n");
+}
+
+void HardwareSerial::begin(unsigned long) {}
+
+int HardwareSerial::available()
+{
+    return (int)_serialInLength;
+}
+
+int HardwareSerial::availableForWrite()
+{
+    return 63;
+}
+
+int HardwareSerial::read()
+{
+    if (_serialInLength == 0) {
+        return -1;
+    }
+    uint8_t value = _serialIn[_serialInHead];
+    _serialInHead = (_serialInHead + 1) % sizeof(_serialIn);
+    _serialInLength--;
+    return value;
+}
+
+HardwareSerial Serial;
+
+// --- EEPROM ---
+EEPROMClass::EEPROMClass()
+{
+    memset(_bytes, 0xFF, sizeof(_bytes));
+}
+
+EEPROMClass EEPROM;
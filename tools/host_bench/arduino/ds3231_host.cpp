@@ -0,0 +1,116 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <string.h>
+
+// --- Simulated DS3231 ---
+// Time and date registers (seconds, minutes, hours in 24 hour mode, day of the week 1-7, date,
+// month, year 2000-2099, all BCD) that run with micros(), so they move with the simulated
+// Arduino clock. Like on the real chip, the day of the week counts on by itself and doesn't have
+// to match the date. The status register starts with OSF set, like a new chip whose time was
+// never set. Alarms and the century bit are not simulated.
+
+const uint8_t REG_DAY = 0x03;
+const uint8_t REG_YEAR = 0x06;
+const uint8_t REG_STATUS = 0x0F;
+const uint8_t STATUS_OSF = 0x80;
+const uint32_t SECONDS_PER_DAY = 24UL * 60 * 60;
+
+static uint8_t _registers[0x13] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, STATUS_OSF};
+static uint8_t _setFields[7] = {0, 0, 0, 0, 1, 1, 0}; // Fields as last written (see _now())
+static uint32_t _setSeconds = 0;     // The same as seconds since 2000-01-01 00:00
+static unsigned long _setMicros = 0; // micros() then
+
+static uint8_t _fromBcd(uint8_t value)
+{
+    return (value >> 4) * 10 + (value & 0x0F);
+}
+
+static uint8_t _toBcd(uint8_t value)
+{
+    return ((value / 10) << 4) | (value % 10);
+}
+
+static uint8_t _daysInMonth(uint8_t year, uint8_t month)
+{
+    static const uint8_t DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return DAYS[month - 1] + (month == 2 && year % 4 == 0 ? 1 : 0);
+}
+
+// The time and date now, as register values (not BCD): second, minute, hour, weekday 0-6,
+// date 1-31, month 1-12, year 0-99
+static void _now(uint8_t* fields)
+{
+    uint32_t elapsed = (micros() - _setMicros) / 1000000UL;
+    if (elapsed == 0) {
+        // As written, so a burst that sets the date one field at a time never passes through
+        // a date that doesn't exist (like February 31st)
+        memcpy(fields, _setFields, sizeof(_setFields));
+        return;
+    }
+    uint32_t seconds = _setSeconds + elapsed;
+    fields[0] = seconds % 60;
+    fields[1] = seconds / 60 % 60;
+    fields[2] = seconds / 3600 % 24;
+    fields[3] = (_setFields[3] + (_setSeconds % SECONDS_PER_DAY + elapsed) / SECONDS_PER_DAY) % 7;
+    uint32_t days = seconds / SECONDS_PER_DAY;
+    uint8_t year = 0;
+    while (days >= (year % 4 == 0 ? 366U : 365U)) {
+        days -= year % 4 == 0 ? 366 : 365;
+        year++;
+    }
+    uint8_t month = 1;
+    while (days >= _daysInMonth(year, month)) {
+        days -= _daysInMonth(year, month);
+        month++;
+    }
+    fields[4] = days + 1;
+    fields[5] = month;
+    fields[6] = year;
+}
+
+static void _set(const uint8_t* fields)
+{
+    uint32_t days = fields[4] - 1;
+    for (uint8_t year = 0; year < fields[6]; year++) {
+        days += year % 4 == 0 ? 366 : 365;
+    }
+    for (uint8_t month = 1; month < fields[5]; month++) {
+        days += _daysInMonth(fields[6], month);
+    }
+    _setSeconds = days * SECONDS_PER_DAY + ((uint32_t)fields[2] * 60 + fields[1]) * 60 + fields[0];
+    memcpy(_setFields, fields, sizeof(_setFields));
+    _setMicros = micros();
+}
+
+// --- I2C (called by wire_host.cpp) ---
+uint8_t _hostDs3231Read(uint8_t reg)
+{
+    reg %= sizeof(_registers);
+    if (reg > REG_YEAR) {
+        return _registers[reg];
+    }
+    uint8_t fields[7];
+    _now(fields);
+    return reg == REG_DAY ? fields[3] + 1 : _toBcd(fields[reg]);
+}
+
+// Writing one field keeps the others as they are now.
+void _hostDs3231Write(uint8_t reg, uint8_t value)
+{
+    reg %= sizeof(_registers);
+    if (reg > REG_YEAR) {
+        _registers[reg] = value;
+        return;
+    }
+    uint8_t fields[7];
+    _now(fields);
+    fields[reg] = reg == REG_DAY ? ((value & 0x07) + 6) % 7 : _fromBcd(reg == 5 ? value & 0x1F : value);
+    _set(fields);
+}
+
+// --- Benchmark Controls ---
+// A flat backup battery: the time is lost and OSF is set again.
+void hostRtcLoseTime()
+{
+    _registers[REG_STATUS] |= STATUS_OSF;
+}
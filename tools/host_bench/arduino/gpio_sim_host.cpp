@@ -0,0 +1,309 @@
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "GpioSim.h"
+
+// --- Simulated GPIO Character Device and sysfs PWM ---
+// Plays the kernel's part (like its gpio-sim module) for LinuxGpio.cpp. This program's open()
+// and ioctl() are replaced:
+//   - opening /dev/gpiochip* gives /dev/null to stand for the chip.
+//   - a line request gets a pipe. hostGpioLine() writes an edge event into it for each change of
+//     a requested input, so epoll and read() on it work as on the real thing. The kernel's
+//     debounce is left out: the host lines don't bounce.
+//   - paths under /sys/class/pwm/pwmchip0/ go to a temporary folder with the same files, where
+//     hostPwm() reads them back.
+// Every other open() and ioctl() goes to the real system call.
+
+const uint8_t LINE_COUNT = 64;
+const uint8_t MAX_REQUESTS = 8;
+static const char PWM_CHIP[] = "/sys/class/pwm/pwmchip0/";
+
+struct _Request {
+    int fd = -1;      // The library's end (read end of the pipe)
+    int events = -1;  // Where edge events are written
+    uint32_t offsets[GPIO_V2_LINES_MAX];
+    uint32_t count = 0;
+    bool output = false;
+    bool edges = false;
+};
+
+static uint8_t _levels[LINE_COUNT];
+static bool _levelsSet = false;
+static _Request _requests[MAX_REQUESTS];
+static int _chip = -1;
+static char _pwmFolder[64] = "";
+static unsigned long _reads = 0;
+
+static uint8_t* _lineLevels()
+{
+    if (!_levelsSet) {
+        memset(_levels, 1, sizeof(_levels));
+        _levelsSet = true;
+    }
+    return _levels;
+}
+
+static int _realOpen(const char* path, int flags, int mode)
+{
+    return (int)syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+static const char* const PWM_FILES[] = {"period", "duty_cycle", "enable"};
+const int PWM_CHANNELS = 4;
+
+static void _removePwmChip()
+{
+    char path[128];
+    for (int channel = 0; channel < PWM_CHANNELS; channel++) {
+        for (const char* file : PWM_FILES) {
+            snprintf(path, sizeof(path), "%s/pwm%d/%s", _pwmFolder, channel, file);
+            unlink(path);
+        }
+        snprintf(path, sizeof(path), "%s/pwm%d", _pwmFolder, channel);
+        rmdir(path);
+    }
+    snprintf(path, sizeof(path), "%s/export", _pwmFolder);
+    unlink(path);
+    rmdir(_pwmFolder);
+}
+
+// Private helper: the temporary pwmchip0 folder, made the first time it is used and removed
+// when the program ends.
+static const char* _pwmChip()
+{
+    if (_pwmFolder[0] != 0) {
+        return _pwmFolder;
+    }
+    strcpy(_pwmFolder, "/tmp/doorlock-pwmchip-XXXXXX");
+    if (mkdtemp(_pwmFolder) == nullptr) {
+        abort();
+    }
+    char path[128];
+    snprintf(path, sizeof(path), "%s/export", _pwmFolder);
+    close(_realOpen(path, O_CREAT | O_WRONLY, 0644));
+    for (int channel = 0; channel < PWM_CHANNELS; channel++) {
+        snprintf(path, sizeof(path), "%s/pwm%d", _pwmFolder, channel);
+        mkdir(path, 0755);
+        for (const char* file : PWM_FILES) {
+            snprintf(path, sizeof(path), "%s/pwm%d/%s", _pwmFolder, channel, file);
+            close(_realOpen(path, O_CREAT | O_WRONLY, 0644));
+        }
+    }
+    atexit(_removePwmChip);
+    return _pwmFolder;
+}
+
+extern "C" int open(const char* path, int flags, ...)
+{
+    int mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, int);
+        va_end(args);
+    }
+    if (strncmp(path, "/dev/gpiochip", 13) == 0) {
+        _chip = _realOpen("/dev/null", flags, 0);
+        return _chip;
+    }
+    if (strncmp(path, PWM_CHIP, sizeof(PWM_CHIP) - 1) == 0) {
+        char file[128];
+        snprintf(file, sizeof(file), "%s/%s", _pwmChip(), path + sizeof(PWM_CHIP) - 1);
+        return _realOpen(file, flags | O_TRUNC, 0); // Like sysfs: every write is the whole value
+    }
+    return _realOpen(path, flags, mode);
+}
+
+// Private helper: forgets the requests the library has closed (a pipe whose read end is closed
+// reports POLLERR on its write end).
+static void _dropClosedRequests()
+{
+    for (uint8_t i = 0; i < MAX_REQUESTS; i++) {
+        if (_requests[i].count == 0) {
+            continue;
+        }
+        struct pollfd end = {_requests[i].events, 0, 0};
+        if (poll(&end, 1, 0) > 0 && (end.revents & POLLERR)) {
+            close(_requests[i].events);
+            _requests[i].count = 0;
+        }
+    }
+}
+
+static _Request* _findRequest(int fd)
+{
+    _dropClosedRequests();
+    for (uint8_t i = 0; i < MAX_REQUESTS; i++) {
+        if (_requests[i].count > 0 && _requests[i].fd == fd) {
+            return &_requests[i];
+        }
+    }
+    return nullptr;
+}
+
+// Private helper: the library has let go of a request when it asks for one of its lines again.
+static void _dropRequestsOf(const struct gpio_v2_line_request* request)
+{
+    for (uint8_t i = 0; i < MAX_REQUESTS; i++) {
+        _Request& old = _requests[i];
+        for (uint32_t j = 0; old.count > 0 && j < old.count; j++) {
+            for (uint32_t k = 0; k < request->num_lines; k++) {
+                if (old.offsets[j] == request->offsets[k]) {
+                    close(old.events);
+                    old.count = 0;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static int _getLine(struct gpio_v2_line_request* request)
+{
+    _dropClosedRequests();
+    _dropRequestsOf(request);
+    _Request* slot = nullptr;
+    for (uint8_t i = 0; i < MAX_REQUESTS && slot == nullptr; i++) {
+        if (_requests[i].count == 0) {
+            slot = &_requests[i];
+        }
+    }
+    signal(SIGPIPE, SIG_IGN); // A request the library has closed just stops taking events
+    int ends[2];
+    if (slot == nullptr || request->num_lines == 0 || pipe(ends) != 0) {
+        return -1;
+    }
+    uint8_t* levels = _lineLevels();
+    slot->fd = ends[0];
+    slot->events = ends[1];
+    slot->count = request->num_lines;
+    memcpy(slot->offsets, request->offsets, request->num_lines * sizeof(request->offsets[0]));
+    slot->output = (request->config.flags & GPIO_V2_LINE_FLAG_OUTPUT) != 0;
+    slot->edges = (request->config.flags & (GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING)) != 0;
+    for (uint32_t a = 0; a < request->config.num_attrs; a++) {
+        const struct gpio_v2_line_config_attribute& attribute = request->config.attrs[a];
+        if (attribute.attr.id != GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES) {
+            continue;
+        }
+        for (uint32_t i = 0; i < slot->count; i++) {
+            if (attribute.mask & (1ULL << i)) {
+                levels[slot->offsets[i] % LINE_COUNT] = (attribute.attr.values >> i) & 1;
+            }
+        }
+    }
+    request->fd = slot->fd;
+    return 0;
+}
+
+extern "C" int ioctl(int fd, unsigned long command, ...)
+{
+    va_list args;
+    va_start(args, command);
+    void* argument = va_arg(args, void*);
+    va_end(args);
+
+    if (fd == _chip && command == GPIO_V2_GET_LINE_IOCTL) {
+        return _getLine((struct gpio_v2_line_request*)argument);
+    }
+    _Request* request = _findRequest(fd);
+    if (request != nullptr && command == GPIO_V2_LINE_GET_VALUES_IOCTL) {
+        struct gpio_v2_line_values* values = (struct gpio_v2_line_values*)argument;
+        uint64_t bits = 0;
+        for (uint32_t i = 0; i < request->count; i++) {
+            if ((values->mask & (1ULL << i)) && _lineLevels()[request->offsets[i] % LINE_COUNT]) {
+                bits |= 1ULL << i;
+            }
+        }
+        values->bits = bits;
+        _reads++;
+        return 0;
+    }
+    if (request != nullptr && command == GPIO_V2_LINE_SET_VALUES_IOCTL) {
+        const struct gpio_v2_line_values* values = (const struct gpio_v2_line_values*)argument;
+        for (uint32_t i = 0; i < request->count; i++) {
+            if (values->mask & (1ULL << i)) {
+                _lineLevels()[request->offsets[i] % LINE_COUNT] = (values->bits >> i) & 1;
+            }
+        }
+        return 0;
+    }
+    return (int)syscall(SYS_ioctl, fd, command, argument);
+}
+
+// --- Benchmark Controls ---
+void hostGpioLine(uint8_t line, uint8_t level)
+{
+    uint8_t* levels = _lineLevels();
+    level = level ? 1 : 0;
+    if (levels[line % LINE_COUNT] == level) {
+        return;
+    }
+    levels[line % LINE_COUNT] = level;
+    for (uint8_t i = 0; i < MAX_REQUESTS; i++) {
+        _Request& request = _requests[i];
+        for (uint32_t j = 0; j < request.count; j++) {
+            if (request.offsets[j] != line || request.output || !request.edges) {
+                continue;
+            }
+            struct gpio_v2_line_event event;
+            memset(&event, 0, sizeof(event));
+            event.id = level ? GPIO_V2_LINE_EVENT_RISING_EDGE : GPIO_V2_LINE_EVENT_FALLING_EDGE;
+            event.offset = line;
+            if (write(request.events, &event, sizeof(event)) != sizeof(event)) {
+                close(request.events); // The library has closed the request
+                request.count = 0;
+                break;
+            }
+        }
+    }
+}
+
+uint8_t hostGpioOutput(uint8_t line)
+{
+    return _lineLevels()[line % LINE_COUNT];
+}
+
+bool hostGpioRequested(uint8_t line)
+{
+    _dropClosedRequests();
+    for (uint8_t i = 0; i < MAX_REQUESTS; i++) {
+        for (uint32_t j = 0; j < _requests[i].count; j++) {
+            if (_requests[i].offsets[j] == line) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+unsigned long hostGpioReads()
+{
+    return _reads;
+}
+
+unsigned long hostPwm(uint8_t channel, const char* file)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "%s/pwm%d/%s", _pwmChip(), channel, file);
+    FILE* in = fopen(path, "r");
+    unsigned long value = 0;
+    if (in != nullptr) {
+        if (fscanf(in, "%lu", &value) != 1) {
+            value = 0;
+        }
+        fclose(in);
+    }
+    return value;
+}
+
+#endif // defined(__linux__)
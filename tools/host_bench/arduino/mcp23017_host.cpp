@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include <Wire.h>
+
+// --- Simulated MCP23017 ---
+// Just what the DoorLock driver uses, with IOCON.BANK = 0: the register file with the address
+// counting up after every byte, the pins, and interrupt-on-change against the previous level.
+// INTA follows IOCON.MIRROR loosely: it goes LOW when any enabled input changes and goes back
+// HIGH when GPIO is read. It answers at address 0x20 (see wire_host.cpp).
+
+const uint8_t REG_IODIR = 0x00;
+const uint8_t REG_GPINTEN = 0x04;
+const uint8_t REG_GPIO = 0x12;
+const uint8_t REG_OLAT = 0x14;
+
+static uint8_t _registers[22] = {0xFF, 0xFF}; // IODIR starts as all inputs
+static uint8_t _pins[2] = {0xFF, 0xFF};        // What the outside world drives on the inputs
+static uint8_t _intPin = 2;
+
+static void _setInterrupt(bool active)
+{
+    hostSetPin(_intPin, active ? LOW : HIGH);
+}
+
+// --- I2C (called by wire_host.cpp) ---
+uint8_t _hostMcp23017Read(uint8_t reg)
+{
+    reg %= sizeof(_registers);
+    if (reg == REG_GPIO || reg == REG_GPIO + 1) {
+        uint8_t port = reg - REG_GPIO;
+        uint8_t inputs = _registers[REG_IODIR + port];
+        _setInterrupt(false);
+        return (_pins[port] & inputs) | (_registers[REG_OLAT + port] & ~inputs);
+    }
+    return _registers[reg];
+}
+
+void _hostMcp23017Write(uint8_t reg, uint8_t value)
+{
+    _registers[reg % sizeof(_registers)] = value;
+}
+
+// --- Benchmark Controls ---
+void hostExpanderPin(uint8_t pin, uint8_t level)
+{
+    uint8_t port = (pin >> 3) & 1;
+    uint8_t bit = 1 << (pin & 7);
+    uint8_t old = _pins[port];
+    _pins[port] = level ? (old | bit) : (old & ~bit);
+    if (_pins[port] != old && (_registers[REG_IODIR + port] & _registers[REG_GPINTEN + port] & bit)) {
+        _setInterrupt(true);
+    }
+}
+
+uint8_t hostExpanderOutput(uint8_t pin)
+{
+    uint8_t port = (pin >> 3) & 1;
+    return (_registers[REG_OLAT + port] >> (pin & 7)) & 1;
+}
+
+void hostExpanderIntPin(uint8_t pin)
+{
+    _intPin = pin;
+}
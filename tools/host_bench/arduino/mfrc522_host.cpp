@@ -0,0 +1,207 @@
+#include <SPI.h>
+#include <string.h>
+
+// --- Simulated MFRC522 ---
+// Just what the DoorLock driver uses: the register file, the FIFO, soft reset and the Transceive
+// command. A transceive finishes at once: the card's answer is in the FIFO with RxIRq set, or
+// TimerIRq is set when no card answers. The card speaks enough ISO 14443A for REQA/WUPA, the
+// anticollision and select of every cascade level, and HLTA.
+
+SPIClass SPI;
+
+const uint8_t REG_COMMAND = 0x01;
+const uint8_t REG_COM_IRQ = 0x04;
+const uint8_t REG_FIFO_DATA = 0x09;
+const uint8_t REG_FIFO_LEVEL = 0x0A;
+const uint8_t REG_BIT_FRAMING = 0x0D;
+const uint8_t REG_TX_CONTROL = 0x14;
+const uint8_t REG_VERSION = 0x37;
+
+const uint8_t IRQ_RX = 0x20;
+const uint8_t IRQ_TIMER = 0x01;
+
+static uint8_t _registers[64];
+static uint8_t _fifo[64];
+static uint8_t _fifoLength = 0;
+static uint8_t _fifoRead = 0;
+static bool _haveAddress = false;
+static uint8_t _address = 0;
+static unsigned long _spiBytes = 0;
+
+// The card on the reader
+enum { CARD_IDLE, CARD_READY, CARD_ACTIVE, CARD_HALT };
+static uint8_t _cardUid[10];
+static uint8_t _cardLength = 0; // 0: no card
+static uint8_t _cardState = CARD_IDLE;
+
+static void _appendCrc(uint8_t* data, uint8_t length)
+{
+    uint16_t crc = 0x6363;
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t ch = data[i] ^ (uint8_t)crc;
+        ch ^= ch << 4;
+        crc = (crc >> 8) ^ ((uint16_t)ch << 8) ^ ((uint16_t)ch << 3) ^ (ch >> 4);
+    }
+    data[length] = crc & 0xFF;
+    data[length + 1] = crc >> 8;
+}
+
+static uint8_t _cascadeLevels()
+{
+    return _cardLength == 4 ? 1 : _cardLength == 7 ? 2 : 3;
+}
+
+// The 4 bytes of the UID sent at cascade level `level`, with the cascade tag when more follow,
+// and their check byte.
+static bool _uidPart(uint8_t level, uint8_t* part)
+{
+    if (level >= _cascadeLevels()) {
+        return false;
+    }
+    if (level == _cascadeLevels() - 1) {
+        memcpy(part, _cardUid + 3 * level, 4);
+    } else {
+        part[0] = 0x88;
+        memcpy(part + 1, _cardUid + 3 * level, 3);
+    }
+    part[4] = part[0] ^ part[1] ^ part[2] ^ part[3];
+    return true;
+}
+
+static void _reply(const uint8_t* data, uint8_t length)
+{
+    memcpy(_fifo, data, length);
+    _fifoLength = length;
+    _registers[REG_COM_IRQ] |= IRQ_RX;
+}
+
+// Sends the FIFO to the card and puts its answer in the FIFO.
+static void _transceive()
+{
+    uint8_t frame[sizeof(_fifo)];
+    uint8_t length = _fifoLength;
+    uint8_t lastBits = _registers[REG_BIT_FRAMING] & 0x07;
+    memcpy(frame, _fifo, length);
+    _fifoLength = _fifoRead = 0;
+
+    uint8_t level = (frame[0] - 0x93) / 2;
+    uint8_t part[5];
+    if (_cardLength == 0) {
+        // Nobody there
+    } else if (length == 1 && lastBits == 7 && (frame[0] == 0x52 || (frame[0] == 0x26 && _cardState != CARD_HALT))) {
+        _cardState = CARD_READY;
+        uint8_t atqa[2] = {(uint8_t)((_cascadeLevels() - 1) << 6 | 0x04), 0x00};
+        _reply(atqa, 2);
+        return;
+    } else if (_cardState == CARD_READY && length == 2 && frame[1] == 0x20 && _uidPart(level, part)) {
+        _reply(part, 5);
+        return;
+    } else if (_cardState == CARD_READY && length == 9 && frame[1] == 0x70 && _uidPart(level, part) &&
+               memcmp(frame + 2, part, 5) == 0) {
+        uint8_t check[9];
+        memcpy(check, frame, 7);
+        _appendCrc(check, 7);
+        if (memcmp(check + 7, frame + 7, 2) == 0) {
+            bool complete = level == _cascadeLevels() - 1;
+            uint8_t sak[3] = {(uint8_t)(complete ? 0x08 : 0x04)};
+            _appendCrc(sak, 1);
+            if (complete) {
+                _cardState = CARD_ACTIVE;
+            }
+            _reply(sak, 3);
+            return;
+        }
+    } else if (length == 4 && frame[0] == 0x50 && frame[1] == 0x00) {
+        _cardState = CARD_HALT; // Doesn't answer
+    }
+    _registers[REG_COM_IRQ] |= IRQ_TIMER;
+}
+
+static void _write(uint8_t reg, uint8_t value)
+{
+    switch (reg) {
+    case REG_COMMAND:
+        if ((value & 0x0F) == 0x0F) { // Soft reset
+            memset(_registers, 0, sizeof(_registers));
+            _registers[REG_TX_CONTROL] = 0x80;
+            _registers[REG_VERSION] = 0x92;
+            _fifoLength = _fifoRead = 0;
+        } else {
+            _registers[REG_COMMAND] = value;
+        }
+        break;
+    case REG_COM_IRQ:
+        if (value & 0x80) {
+            _registers[REG_COM_IRQ] |= value & 0x7F;
+        } else {
+            _registers[REG_COM_IRQ] &= ~value;
+        }
+        break;
+    case REG_FIFO_LEVEL:
+        if (value & 0x80) {
+            _fifoLength = _fifoRead = 0;
+        }
+        break;
+    case REG_FIFO_DATA:
+        if (_fifoLength < sizeof(_fifo)) {
+            _fifo[_fifoLength++] = value;
+        }
+        break;
+    case REG_BIT_FRAMING:
+        _registers[REG_BIT_FRAMING] = value & 0x7F;
+        if ((value & 0x80) && (_registers[REG_COMMAND] & 0x0F) == 0x0C) { // StartSend during Transceive
+            _transceive();
+        }
+        break;
+    default:
+        _registers[reg] = value;
+    }
+}
+
+static uint8_t _read(uint8_t reg)
+{
+    switch (reg) {
+    case REG_FIFO_DATA:
+        return _fifoRead < _fifoLength ? _fifo[_fifoRead++] : 0;
+    case REG_FIFO_LEVEL:
+        return _fifoLength - _fifoRead;
+    default:
+        return _registers[reg];
+    }
+}
+
+// --- SPI ---
+void SPIClass::beginTransaction(SPISettings)
+{
+    _haveAddress = false;
+}
+
+// The first byte of a transaction is the address: (register << 1), plus 0x80 to read.
+uint8_t SPIClass::transfer(uint8_t value)
+{
+    _spiBytes++;
+    if (!_haveAddress) {
+        _haveAddress = true;
+        _address = value;
+        return 0;
+    }
+    uint8_t reg = (_address >> 1) & 0x3F;
+    if (_address & 0x80) {
+        return _read(reg);
+    }
+    _write(reg, value);
+    return 0;
+}
+
+// --- Benchmark Controls ---
+void hostRfidCard(const uint8_t* uid, uint8_t length)
+{
+    memcpy(_cardUid, uid, length);
+    _cardLength = length;
+    _cardState = CARD_IDLE; // A card that has just come into the field starts up idle
+}
+
+unsigned long hostSpiBytes()
+{
+    return _spiBytes;
+}
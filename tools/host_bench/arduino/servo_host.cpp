@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include <Servo.h>
+
+// --- Simulated Servo ---
+// A servo that turns 180 degrees in 600 ms towards the angle it was told while it gets pulses
+// (attached), and stops wherever it is when they stop. hostServoJam() puts something in its way.
+// A shunt in its ground lead is read on A0, in ADC counts: about 200 while it moves, 600 while it
+// pushes against the obstruction, 20 while it holds still and nothing without pulses.
+
+const uint8_t SENSE_PIN = A0;
+const float DEGREES_PER_MICRO = 180.0f / 600000;
+const int CURRENT_MOVING = 200;
+const int CURRENT_STALLED = 600;
+const int CURRENT_HOLDING = 20;
+const int NO_JAM = -1;
+
+static bool _attached = false;
+static float _position = 0; // Degrees
+static int _target = 0;
+static int _jamAngle = NO_JAM;
+static bool _stalled = false;
+static float _pushDirection = 0; // Which way it last ran into the obstruction
+static unsigned long _lastMicros = 0;
+
+// Moves the horn on to the present time
+static void _update()
+{
+    unsigned long now = micros();
+    float step = (now - _lastMicros) * DEGREES_PER_MICRO;
+    _lastMicros = now;
+    _stalled = false;
+    if (!_attached || _position == _target) {
+        return;
+    }
+    float direction = _target > _position ? 1 : -1;
+    float next = _position + direction * step;
+    if ((next - _target) * direction > 0) {
+        next = _target;
+    }
+    // The obstruction stops the horn when it gets there, and keeps stopping it while it pushes
+    // the same way. Turning back is free.
+    if (_jamAngle != NO_JAM && _jamAngle != _target) {
+        bool reaches = (_jamAngle - _position) * direction > 0 && (next - _jamAngle) * direction >= 0;
+        bool pushing = _position == _jamAngle && direction == _pushDirection;
+        if (reaches || pushing) {
+            next = _jamAngle;
+            _stalled = true;
+            _pushDirection = direction;
+        }
+    }
+    _position = next;
+}
+
+// --- Servo Library (called by Servo.h) ---
+void _hostServoAttach(int)
+{
+    _update();
+    _attached = true;
+}
+
+void _hostServoDetach()
+{
+    _update();
+    _attached = false;
+}
+
+void _hostServoWrite(int angle)
+{
+    _update();
+    _target = angle;
+}
+
+// --- Current Sense (called by analogRead()) ---
+// -1 for every pin but the sense pin
+int _hostServoCurrent(uint8_t pin)
+{
+    if (pin != SENSE_PIN) {
+        return -1;
+    }
+    _update();
+    if (!_attached) {
+        return 0;
+    }
+    if (_stalled) {
+        return CURRENT_STALLED;
+    }
+    return _position == _target ? CURRENT_HOLDING : CURRENT_MOVING;
+}
+
+// --- Benchmark Controls ---
+void hostServoJam(int angle)
+{
+    _update();
+    _jamAngle = angle;
+}
+
+int hostServoAngle()
+{
+    _update();
+    return (int)(_position + 0.5f);
+}
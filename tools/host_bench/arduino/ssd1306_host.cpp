@@ -0,0 +1,111 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <stdio.h>
+
+// --- Simulated SSD1306 ---
+// A 128 x 64 OLED: its display RAM (8 pages of 128 columns, bit 0 of each byte at the top) and
+// the commands the DoorLock driver sends. Commands that take arguments eat them; of those only
+// the addressing mode, the column and page address and display on/off do anything. Data goes to
+// the RAM in horizontal addressing mode: left to right inside the column window, then on to the
+// next page of the page window. A 128 x 32 module uses the top 4 pages. It answers at address
+// 0x3C (see wire_host.cpp).
+
+const uint8_t CONTROL_DATA = 0x40; // Control byte bit 6: the bytes after it are data
+
+static uint8_t _ram[8][128];
+static bool _on = false;
+static uint8_t _columnStart = 0, _columnEnd = 127;
+static uint8_t _pageStart = 0, _pageEnd = 7;
+static uint8_t _column = 0, _page = 0;
+static uint8_t _command = 0;    // Command still waiting for arguments
+static uint8_t _argumentsLeft = 0;
+static uint8_t _arguments[2];
+static unsigned long _dataBytes = 0;
+
+// Number of argument bytes after a command byte
+static uint8_t _argumentCount(uint8_t command)
+{
+    switch (command) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+static void _runCommand(uint8_t command, const uint8_t* arguments)
+{
+    switch (command) {
+    case 0xAE: _on = false; break;
+    case 0xAF: _on = true; break;
+    case 0x21:
+        _columnStart = _column = arguments[0] & 0x7F;
+        _columnEnd = arguments[1] & 0x7F;
+        break;
+    case 0x22:
+        _pageStart = _page = arguments[0] & 0x07;
+        _pageEnd = arguments[1] & 0x07;
+        break;
+    default: break; // Only horizontal addressing (0x20 0x00) is simulated
+    }
+}
+
+// --- I2C (called by wire_host.cpp) ---
+// `control` is the control byte the transmission started with; it stays the same for every byte.
+void _hostSsd1306Write(uint8_t control, uint8_t value)
+{
+    if (control & CONTROL_DATA) {
+        _dataBytes++;
+        _ram[_page][_column] = value;
+        if (_column < _columnEnd) {
+            _column++;
+            return;
+        }
+        _column = _columnStart;
+        _page = _page < _pageEnd ? _page + 1 : _pageStart;
+        return;
+    }
+    if (_argumentsLeft > 0) {
+        _arguments[_argumentCount(_command) - _argumentsLeft] = value;
+        if (--_argumentsLeft == 0) {
+            _runCommand(_command, _arguments);
+        }
+        return;
+    }
+    _command = value;
+    _argumentsLeft = _argumentCount(value);
+    if (_argumentsLeft == 0) {
+        _runCommand(value, nullptr);
+    }
+}
+
+uint8_t _hostSsd1306Read(uint8_t)
+{
+    return 0; // The SSD1306 can't be read over I2C
+}
+
+// --- Benchmark Controls ---
+uint8_t hostDisplayPixel(uint8_t x, uint8_t y)
+{
+    return _on && x < 128 && y < 64 ? (_ram[y / 8][x] >> (y % 8)) & 1 : 0;
+}
+
+unsigned long hostDisplayDataBytes()
+{
+    return _dataBytes;
+}
+
+// Writes what the screen shows as a plain PBM image ("P1"): readable as text, and any image
+// viewer opens it. rows is 32 or 64.
+void hostDisplayDump(FILE* out, uint8_t rows)
+{
+    fprintf(out, "P1\n128 %u\n", rows);
+    for (uint8_t y = 0; y < rows; y++) {
+        for (uint8_t x = 0; x < 128; x++) {
+            fputc(hostDisplayPixel(x, y) ? '1' : '0', out);
+        }
+        fputc('\n', out);
+    }
+}
@@ -0,0 +1,118 @@
+#include <Arduino.h>
+#include <Wire.h>
+
+// --- Host I2C Bus ---
+// Most devices are a register file: the first byte written after the address sets the register
+// pointer, and every byte written or read after that goes to the next register. The SSD1306
+// instead starts each write with a control byte that holds for the whole write.
+
+TwoWire Wire;
+
+// The simulated devices (mcp23017_host.cpp, ds3231_host.cpp)
+uint8_t _hostMcp23017Read(uint8_t reg);
+void _hostMcp23017Write(uint8_t reg, uint8_t value);
+uint8_t _hostDs3231Read(uint8_t reg);
+void _hostDs3231Write(uint8_t reg, uint8_t value);
+uint8_t _hostSsd1306Read(uint8_t reg);
+void _hostSsd1306Write(uint8_t control, uint8_t value);
+
+struct _HostI2cDevice {
+    uint8_t address;
+    uint8_t (*read)(uint8_t reg);
+    void (*write)(uint8_t reg, uint8_t value);
+    bool countsUp; // The register pointer moves on after every byte
+};
+
+static const _HostI2cDevice DEVICES[] = {
+    {0x20, _hostMcp23017Read, _hostMcp23017Write, true},
+    {0x3C, _hostSsd1306Read, _hostSsd1306Write, false},
+    {0x68, _hostDs3231Read, _hostDs3231Write, true},
+};
+
+static const _HostI2cDevice* _device = nullptr; // Device of the current transmission, or none
+static uint8_t _pointer = 0;
+static bool _havePointer = false;
+static uint8_t _reply[32]; // Like the Arduino Wire buffer
+static uint8_t _replyLength = 0;
+static uint8_t _replyRead = 0;
+static unsigned long _i2cBytes = 0;
+
+static const _HostI2cDevice* _find(uint8_t address)
+{
+    for (const _HostI2cDevice& device : DEVICES) {
+        if (device.address == address) {
+            return &device;
+        }
+    }
+    return nullptr;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    _i2cBytes++;
+    _device = _find(address);
+    _havePointer = false;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    _i2cBytes++;
+    if (!_device) {
+        return 1;
+    }
+    if (!_havePointer) {
+        _havePointer = true;
+        _pointer = value;
+    } else {
+        _device->write(_pointer, value);
+        _pointer += _device->countsUp;
+    }
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* values, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        write(values[i]);
+    }
+    return count;
+}
+
+// 2 (NACK on the address) if nobody answers, like the Arduino Wire library
+uint8_t TwoWire::endTransmission(bool)
+{
+    return _device ? 0 : 2;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t count, uint8_t)
+{
+    _i2cBytes++;
+    _replyRead = 0;
+    _replyLength = 0;
+    const _HostI2cDevice* device = _find(address);
+    if (!device) {
+        return 0;
+    }
+    _i2cBytes += count;
+    _replyLength = count < sizeof(_reply) ? count : sizeof(_reply);
+    for (uint8_t i = 0; i < _replyLength; i++) {
+        _reply[i] = device->read(_pointer++);
+    }
+    return _replyLength;
+}
+
+int TwoWire::available()
+{
+    return _replyLength - _replyRead;
+}
+
+int TwoWire::read()
+{
+    return _replyRead < _replyLength ? _reply[_replyRead++] : -1;
+}
+
+// --- Benchmark Controls ---
+unsigned long hostI2cBytes()
+{
+    return _i2cBytes;
+}
@@ -0,0 +1,522 @@
+// --- DoorLock Host Benchmarks ---
+// Times the hot paths of the DoorLock library built for a PC (see tools/host_bench.py, which
+// builds and runs this). Prints one JSON document:
+//   {"benchmarks": [{"name": ..., "iterations": ..., "ns_per_op": ..., "allocs_per_op": ...}],
+//    "latency": [{"name": ..., "sequences": ..., "dropped": ..., "p50_us": ..., "p99_us": ...}]}
+// ns/op is wall-clock time on the PC, so only compare results from the same machine. The
+// Arduino clock is simulated and only moves when a benchmark (or delay()) moves it.
+// allocs/op counts operator new calls (DOORLOCK_MEMORY_HOOKS); the library should stay at 0.
+//
+//     host_bench             run everything
+//     host_bench entry       only benchmarks whose name contains "entry"
+//
+// The rfid/ benchmarks need DOORLOCK_USE_RFID=1. For a big card table, make one with
+// tools/rfid_table.py --random 3000 --output /tmp/cards.h and build with
+// -D 'DOORLOCK_RFID_CARDS="/tmp/cards.h"'.
+// The schedule/ benchmarks need DOORLOCK_USE_SCHEDULES=1, the totp/ ones DOORLOCK_USE_TOTP=1.
+// The display/ benchmarks need DOORLOCK_USE_DISPLAY=1, the servo/ ones DOORLOCK_USE_SERVO_SENSE=1.
+// The expander/ benchmarks need DOORLOCK_USE_EXPANDER=1. They move the buttons and LEDs onto the
+// expander, so they run last.
+//
+// After them, "latency" lists runs of the actuator queue with its two ends on two threads (see
+// runLatency()): p50/p99 from the library's _LatencyHistogram, in microseconds of real time.
+
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+#include "DoorLock.h"
+#if DOORLOCK_USE_RFID
+#include <SPI.h>
+#include DOORLOCK_RFID_CARDS
+#endif
+#if DOORLOCK_USE_EXPANDER
+#include <Wire.h>
+#endif
+
+// From the sketch (exampleMain.ino unless another sketch is built), compiled together with this file
+void setup();
+void loop();
+
+const unsigned long MIN_RUN_NS = 200000000UL; // Each repeat runs for at least 0.2 s
+const int REPEATS = 5;                        // The median of these is reported
+
+struct Benchmark {
+    const char* name;
+    void (*prepare)(); // Runs once before the timed repeats (not timed)
+    void (*op)();      // One operation
+};
+
+// --- Helpers ---
+static void releaseAllButtons()
+{
+    hostSetPin(DOORLOCK_BUTTON1_PIN, HIGH);
+    hostSetPin(DOORLOCK_BUTTON2_PIN, HIGH);
+    hostSetPin(DOORLOCK_BUTTON3_PIN, HIGH);
+    hostSetPin(DOORLOCK_LOCK_BUTTON_PIN, HIGH);
+}
+
+// Lets every button settle in the released state and empties the event queue.
+static void settle()
+{
+    releaseAllButtons();
+    for (int i = 0; i < 200; i++) {
+        hostAdvanceMicros(1000);
+        DoorLock::scanButtons();
+    }
+    while (DoorLock::isButton1Pressed() || DoorLock::isButton2Pressed() || DoorLock::isButton3Pressed() ||
+           DoorLock::isLockButtonPressed()) {
+    }
+    DoorLock::resetAttempt();
+}
+
+static void useCodeOfLength(int length)
+{
+    int code[DOORLOCK_MAX_CODE_LENGTH];
+    for (int i = 0; i < length; i++) {
+        code[i] = 1;
+    }
+    DoorLock::setCorrectCode(code, length);
+    settle();
+}
+
+// --- scanButtons() ---
+static void scanIdle()
+{
+    hostAdvanceMicros(100);
+    DoorLock::scanButtons();
+}
+
+// Button 1 changes on every scan, so the debouncer never accepts it
+static void prepareBouncing()
+{
+    settle();
+}
+
+static void scanBouncing()
+{
+    static uint8_t level = LOW;
+    hostSetPin(DOORLOCK_BUTTON1_PIN, level);
+    level = !level;
+    hostAdvanceMicros(100);
+    DoorLock::scanButtons();
+}
+
+// Button 1 held down (long press and repeat handling runs on every scan)
+static void preparePressed()
+{
+    settle();
+    hostSetPin(DOORLOCK_BUTTON1_PIN, LOW);
+}
+
+static void scanPressed()
+{
+    hostAdvanceMicros(100);
+    DoorLock::scanButtons();
+}
+
+// --- Code Entry: button1Pressed() ... isAttemptCorrect() ---
+static int _entryLength = 1;
+
+static void enterCode()
+{
+    for (int i = 0; i < _entryLength; i++) {
+        DoorLock::button1Pressed();
+    }
+    DoorLock::isAttemptCorrect();
+    DoorLock::resetAttempt();
+}
+
+static void prepareEntry1()
+{
+    _entryLength = 1;
+    useCodeOfLength(1);
+}
+
+static void prepareEntry4()
+{
+    _entryLength = 4;
+    useCodeOfLength(4);
+}
+
+static void prepareEntry8()
+{
+    _entryLength = DOORLOCK_MAX_CODE_LENGTH;
+    useCodeOfLength(DOORLOCK_MAX_CODE_LENGTH);
+}
+
+// --- setCorrectCode() ---
+static void setCodeSameLength()
+{
+    static int codes[2][4] = {{1, 2, 3, 1}, {3, 2, 1, 3}};
+    static uint8_t next = 0;
+    DoorLock::setCorrectCode(codes[next], 4);
+    next = 1 - next;
+}
+
+static void setCodeNewLength()
+{
+    static int code[4] = {1, 2, 3, 1};
+    static uint8_t next = 0;
+    DoorLock::setCorrectCode(code, next ? 4 : 3);
+    next = 1 - next;
+}
+
+// --- The sketch's loop() (exampleMain unless another sketch is built) ---
+static void prepareLoop()
+{
+    useCodeOfLength(DOORLOCK_DEFAULT_CODE_LENGTH);
+}
+
+static void sketchLoop()
+{
+    hostAdvanceMicros(100);
+    loop();
+}
+
+#if DOORLOCK_USE_RFID
+// --- RFID Badges ---
+static uint8_t _card[DL_RFID_MAX_UID];
+static uint8_t _cardLength = 0;
+
+// The first card in the table (or an unknown one if the table is empty)
+static void prepareEnrolledCard()
+{
+    _cardLength = 4;
+    memset(_card, 0xEE, sizeof(_card));
+    if (DL_RFID_CARD_COUNT > 0) {
+        _cardLength = DL_RFID_CARDS[0][0];
+        memcpy(_card, &DL_RFID_CARDS[0][1], _cardLength);
+    }
+}
+
+static void prepareUnknownCard()
+{
+    _cardLength = 4;
+    memset(_card, 0xEE, sizeof(_card));
+}
+
+static void findCard()
+{
+    DoorLock::findCard(_card, _cardLength);
+}
+
+// scanButtons() while the reader asks for a card every DL_RFID_POLL_MS and nobody holds one up
+static void prepareNoCard()
+{
+    hostRfidCard(nullptr, 0);
+    settle();
+}
+#endif
+
+#if DOORLOCK_USE_SCHEDULES
+// --- Access Schedules ---
+// The keypad code may be used Monday to Friday, 9:00 to 17:30, and it is Wednesday 10:00
+static void prepareSchedule()
+{
+    _entryLength = 4;
+    useCodeOfLength(4);
+    DoorLock::setAccessWindow(0, 0x1F, 9, 0, 17, 30);
+    DoorLock::setTime(2, 10, 0, 0);
+}
+#endif
+
+#if DOORLOCK_USE_TOTP
+// --- One-Time Codes ---
+// Every secret is set and its cache is full. The typed code (all 1s) is compared with every cached
+// code, like any code that is typed.
+static void prepareOneTimeCodes()
+{
+    static const uint8_t KEY[] = "12345678901234567890";
+    _entryLength = DOORLOCK_TOTP_DIGITS;
+    useCodeOfLength(DOORLOCK_DEFAULT_CODE_LENGTH);
+    DoorLock::setDateTime(2024, 3, 15, 14, 30, 10);
+    for (uint8_t slot = 0; slot < DOORLOCK_TOTP_SECRETS; slot++) {
+        DoorLock::setOneTimeSecret(slot, KEY, 20);
+    }
+    settle(); // 10 scans per code fill the caches
+}
+
+// 1.5 s per scan: a new step every 20 scans, so the cache is always working out the next codes
+static void scanRefilling()
+{
+    hostAdvanceMicros(1500000);
+    DoorLock::scanButtons();
+}
+#endif
+
+#if DOORLOCK_USE_DISPLAY
+// --- Status Display ---
+// settle() runs long enough to draw the whole screen
+static void prepareDisplay()
+{
+    useCodeOfLength(4);
+}
+
+// A digit is typed (or the attempt reset) before every scan, so every scan has stars to send
+static void scanTyping()
+{
+    static uint8_t typed = 0;
+    if (typed < 4) {
+        DoorLock::button1Pressed();
+        typed++;
+    } else {
+        DoorLock::resetAttempt();
+        typed = 0;
+    }
+    hostAdvanceMicros(100);
+    DoorLock::scanButtons();
+}
+#endif
+
+#if DOORLOCK_USE_SERVO_SENSE
+// --- Servo Current Sensing ---
+// The servo is sent the other way every 1000 scans (0.1 s), so a move is always being watched
+static void scanServoMoving()
+{
+    static unsigned int scans = 0;
+    if (scans++ % 1000 == 0) {
+        if (scans % 2000 == 1) {
+            DoorLock::open();
+        } else {
+            DoorLock::close();
+        }
+    }
+    hostAdvanceMicros(100);
+    DoorLock::scanButtons();
+}
+#endif
+
+#if DOORLOCK_USE_EXPANDER
+// --- I2C Port Expander ---
+// Buttons on expander pins 0-3 and the LEDs on 4 and 5
+static void prepareExpander()
+{
+    for (uint8_t pin = 0; pin < 4; pin++) {
+        hostExpanderPin(pin, HIGH);
+    }
+    hostExpanderIntPin(DOORLOCK_EXPANDER_INT_PIN);
+    DoorLock::setPins(DL_EXPANDER_PIN, DL_EXPANDER_PIN + 1, DL_EXPANDER_PIN + 2, DL_EXPANDER_PIN + 3,
+                      DL_EXPANDER_PIN + 4, DL_EXPANDER_PIN + 5, DOORLOCK_SERVO_PIN, DOORLOCK_BUZZER_PIN);
+    for (int i = 0; i < 200; i++) {
+        hostAdvanceMicros(1000);
+        DoorLock::scanButtons();
+    }
+    DoorLock::resetAttempt();
+}
+
+// Button 1 changes on every scan: INT goes LOW and both ports are read every time
+static void scanExpanderBouncing()
+{
+    static uint8_t level = LOW;
+    hostExpanderPin(0, level);
+    level = !level;
+    hostAdvanceMicros(100);
+    DoorLock::scanButtons();
+}
+#endif
+
+static const Benchmark BENCHMARKS[] = {
+    {"scanButtons/idle", settle, scanIdle},
+    {"scanButtons/bouncing", prepareBouncing, scanBouncing},
+    {"scanButtons/pressed", preparePressed, scanPressed},
+    {"entry/length_1", prepareEntry1, enterCode},
+    {"entry/length_4", prepareEntry4, enterCode},
+    {"entry/length_8", prepareEntry8, enterCode},
+    {"setCorrectCode/same_length", settle, setCodeSameLength},
+    {"setCorrectCode/new_length", settle, setCodeNewLength},
+    {"sketch/loop", prepareLoop, sketchLoop},
+#if DOORLOCK_USE_RFID
+    {"rfid/find_enrolled", prepareEnrolledCard, findCard},
+    {"rfid/find_unknown", prepareUnknownCard, findCard},
+    {"rfid/scan_no_card", prepareNoCard, scanIdle},
+#endif
+#if DOORLOCK_USE_SCHEDULES
+    {"schedule/entry_length_4", prepareSchedule, enterCode},
+    {"schedule/scan_idle", prepareSchedule, scanIdle},
+#endif
+#if DOORLOCK_USE_TOTP
+    {"totp/entry_one_time_code", prepareOneTimeCodes, enterCode},
+    {"totp/scan_idle", prepareOneTimeCodes, scanIdle},
+    {"totp/scan_refilling", prepareOneTimeCodes, scanRefilling},
+#endif
+#if DOORLOCK_USE_DISPLAY
+    {"display/scan_idle", prepareDisplay, scanIdle},
+    {"display/scan_typing", prepareDisplay, scanTyping},
+#endif
+#if DOORLOCK_USE_SERVO_SENSE
+    {"servo/scan_idle", settle, scanIdle},
+    {"servo/scan_moving", settle, scanServoMoving},
+#endif
+#if DOORLOCK_USE_EXPANDER
+    {"expander/scan_idle", prepareExpander, scanIdle},
+    {"expander/scan_bouncing", prepareExpander, scanExpanderBouncing},
+#endif
+};
+
+// --- Runner ---
+static unsigned long long _nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void run(const Benchmark& benchmark, bool first)
+{
+    benchmark.prepare();
+
+    // Find an iteration count that takes at least MIN_RUN_NS
+    unsigned long iterations = 1;
+    for (;;) {
+        unsigned long long start = _nowNs();
+        for (unsigned long i = 0; i < iterations; i++) {
+            benchmark.op();
+        }
+        if (_nowNs() - start >= MIN_RUN_NS / 10 || iterations >= (1UL << 30)) {
+            break;
+        }
+        iterations *= 2;
+    }
+    iterations *= 10;
+
+    double nsPerOp[REPEATS];
+    uint32_t allocationsBefore = DoorLock::memoryStats().allocations;
+    for (int r = 0; r < REPEATS; r++) {
+        unsigned long long start = _nowNs();
+        for (unsigned long i = 0; i < iterations; i++) {
+            benchmark.op();
+        }
+        nsPerOp[r] = (double)(_nowNs() - start) / iterations;
+    }
+    uint32_t allocations = DoorLock::memoryStats().allocations - allocationsBefore;
+
+    // Median (insertion sort, REPEATS is tiny)
+    for (int i = 1; i < REPEATS; i++) {
+        for (int j = i; j > 0 && nsPerOp[j] < nsPerOp[j - 1]; j--) {
+            double swap = nsPerOp[j];
+            nsPerOp[j] = nsPerOp[j - 1];
+            nsPerOp[j - 1] = swap;
+        }
+    }
+
+    printf("%s    {\"name\": \"%s\", \"iterations\": %lu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.4f}",
+           first ? "" : ",\n", benchmark.name, iterations, nsPerOp[REPEATS / 2],
+           (double)allocations / ((double)iterations * REPEATS));
+    fflush(stdout);
+}
+
+// --- Actuator Queue on Two Threads ---
+// The queue DoorUnlock() posts through, with an input thread as the producer and an actuator
+// thread as the consumer. The producer posts a 4-command sequence like DoorUnlock()'s, does 0 to
+// workUs of other work (the synthetic load) and sleeps 0-400 us until the next key press; a
+// sequence that doesn't fit is dropped, as _startActuatorSequence() would. The consumer takes
+// commands off and spends 0 to commandUs on each, and yields when the queue is empty. The time
+// from posting a sequence to the consumer taking its first command goes into a _LatencyHistogram,
+// whose buckets are powers of two from 16 us, so p50/p99 are bucket upper bounds. On a
+// single-core machine they mostly measure the scheduler.
+const uint16_t LATENCY_SEQUENCES = 5000;
+const unsigned long LATENCY_GAP_US = 400; // Most time between two key presses
+
+struct LatencyRun {
+    const char* name;
+    unsigned long workUs;    // Most producer work per sequence
+    unsigned long commandUs; // Most consumer work per command
+};
+
+static const LatencyRun LATENCY_RUNS[] = {
+    {"actuators/two_threads", 50, 20},
+    {"actuators/two_threads_busy_consumer", 50, 200},
+};
+
+static uint32_t _random(uint32_t& state)
+{
+    state ^= state << 13; // xorshift32
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void _work(unsigned long us)
+{
+    unsigned long long end = _nowNs() + us * 1000ULL;
+    while (_nowNs() < end) {
+    }
+}
+
+static void runLatency(const LatencyRun& latencyRun, bool first)
+{
+    static _ActuatorQueue queue;
+    static unsigned long long postedNs[LATENCY_SEQUENCES]; // Written before the push that publishes it
+    _LatencyHistogram histogram;
+    std::atomic<bool> producerDone(false);
+    uint16_t dropped = 0;
+
+    std::thread consumer([&]() {
+        uint32_t state = 2463534242UL;
+        _ActuatorCommand cmd;
+        for (;;) {
+            if (!queue.pop(cmd)) {
+                if (producerDone.load() && queue.isEmpty()) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            if (cmd.op & DL_ACT_FIRST) {
+                histogram.record((_nowNs() - postedNs[cmd.value]) / 1000);
+            }
+            _work(_random(state) % (latencyRun.commandUs + 1));
+        }
+    });
+
+    std::thread producer([&]() {
+        uint32_t state = 88675123UL;
+        for (uint16_t sequence = 0; sequence < LATENCY_SEQUENCES; sequence++) {
+            if (queue.space() < 4) {
+                dropped++;
+            } else {
+                postedNs[sequence] = _nowNs();
+                queue.push(DL_ACT_SERVO | DL_ACT_FIRST, sequence);
+                queue.push(DL_ACT_GREEN_LED, 1);
+                queue.push(DL_ACT_WAIT, 0);
+                queue.push(DL_ACT_GREEN_LED, 0);
+            }
+            _work(_random(state) % (latencyRun.workUs + 1));
+            std::this_thread::sleep_for(std::chrono::microseconds(_random(state) % (LATENCY_GAP_US + 1)));
+        }
+        producerDone.store(true);
+    });
+
+    producer.join();
+    consumer.join();
+    printf("%s    {\"name\": \"%s\", \"sequences\": %u, \"dropped\": %u, \"p50_us\": %lu, \"p99_us\": %lu}",
+           first ? "" : ",\n", latencyRun.name, LATENCY_SEQUENCES, dropped, histogram.percentile(50),
+           histogram.percentile(99));
+    fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : "";
+    setup();
+
+    printf("{\n  \"benchmarks\": [\n");
+    bool first = true;
+    for (size_t i = 0; i < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); i++) {
+        if (strstr(BENCHMARKS[i].name, filter)) {
+            run(BENCHMARKS[i], first);
+            first = false;
+        }
+    }
+    printf("\n  ],\n  \"latency\": [\n");
+    first = true;
+    for (size_t i = 0; i < sizeof(LATENCY_RUNS) / sizeof(LATENCY_RUNS[0]); i++) {
+        if (strstr(LATENCY_RUNS[i].name, filter)) {
+            runLatency(LATENCY_RUNS[i], first);
+            first = false;
+        }
+    }
+    printf("\n  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,1291 @@
+// --- DoorLock Host Tests ---
+// Behaviour checks of the DoorLock library built for a PC (see tools/host_test.py, which builds
+// this and runs each test in a process of its own). The Arduino clock is simulated and only moves
+// when a test moves it, so waits of seconds take no time.
+//
+//     host_test              list the tests, one per line
+//     host_test NAME         run one test; exit status 0 if it passed
+//
+// Most tests run in every build. These need a library option turned on (host_test.py -D NAME=1):
+//   fastboot/   DOORLOCK_FAST_BOOT
+//   expander/   DOORLOCK_USE_EXPANDER
+//   schedules/  DOORLOCK_USE_SCHEDULES (with DOORLOCK_USE_DS3231 too, against the simulated chip)
+//   servosense/ DOORLOCK_USE_SERVO_SENSE (not on Linux, where the servo is a PWM channel)
+//   display/    DOORLOCK_USE_DISPLAY (the frames in tools/host_bench/frames are of a 128 x 32 screen)
+//   rfid/       DOORLOCK_USE_RFID (host_test.py makes the card table with tools/rfid_table.py)
+//   totp/       DOORLOCK_USE_TOTP
+//   linux/      DOORLOCK_USE_LINUX_GPIO (the other tests also run with it)
+// The linux/ tests run against the userspace stand-in for the GPIO chip and the PWM files
+// (GpioSim.h), not against a real chip or the kernel's gpio-sim module. The telemetry/ test needs
+// HOST_TELEMETRY_FORMAT, the snapshot layout from tools/doorlock_client.py, which host_test.py
+// passes in.
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SPI.h>
+#include <Servo.h>
+#include <Wire.h>
+#include <stdio.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "GpioSim.h"
+#include "DoorLock.h"
+#include "SerialFrame.h"
+#if DOORLOCK_USE_RFID && defined(HOST_RFID_TEST_CARDS)
+#include DOORLOCK_RFID_CARDS
+#include HOST_RFID_TEST_CARDS
+#endif
+
+#define DISPLAY_TESTS (DOORLOCK_USE_DISPLAY && DOORLOCK_DISPLAY_HEIGHT == 32 && defined(HOST_FRAMES_DIR))
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);            \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+// --- Helpers ---
+// Calls scanButtons() once per simulated millisecond
+static void scanFor(unsigned long ms)
+{
+    for (unsigned long i = 0; i < ms; i++) {
+        hostAdvanceMicros(1000);
+        DoorLock::scanButtons();
+    }
+}
+
+// Where the servo was sent: the simulated servo's horn, or on Linux the pulse width of its PWM
+// channel (544 us at 0 degrees to 2400 us at 180)
+static int servoAngle()
+{
+#if DOORLOCK_USE_LINUX_GPIO
+    return ((long)hostPwm(DOORLOCK_LINUX_SERVO_PWM, "duty_cycle") - 544000) / 10311;
+#else
+    return hostServoAngle();
+#endif
+}
+
+// Level the library drives on an LED pin
+static int ledLevel(int pin)
+{
+#if DOORLOCK_USE_LINUX_GPIO
+    return hostGpioOutput(pin) ? HIGH : LOW;
+#else
+    return digitalRead(pin);
+#endif
+}
+
+// Presses (LOW) or releases (HIGH) a button: the pin, or on Linux the GPIO line
+static void setButton(int pin, int level)
+{
+#if DOORLOCK_USE_LINUX_GPIO
+    hostGpioLine(pin, level);
+#else
+    hostSetPin(pin, level);
+#endif
+}
+
+// Holds a button down for `downMs`, then leaves it up for `upMs`
+static void tapButton(int pin, unsigned long downMs, unsigned long upMs)
+{
+    setButton(pin, LOW);
+    scanFor(downMs);
+    setButton(pin, HIGH);
+    scanFor(upMs);
+}
+
+// Types `code` on the keypad handlers
+static void typeCode(const int* code, int length)
+{
+    for (int i = 0; i < length; i++) {
+        if (code[i] == 1) {
+            DoorLock::button1Pressed();
+        } else if (code[i] == 2) {
+            DoorLock::button2Pressed();
+        } else {
+            DoorLock::button3Pressed();
+        }
+    }
+}
+
+// --- Auto-Relock ---
+// A sketch that opens the door with open() (no feedback) still gets it locked again on time
+static void relockAfterOpen()
+{
+    DoorLock::start();
+    DoorLock::setAutoRelock(2, nullptr);
+    DoorLock::open();
+    scanFor(1000);
+    CHECK(!DoorLock::locked);
+    CHECK(servoAngle() == 180);
+    scanFor(2000);
+    CHECK(DoorLock::locked);
+    CHECK(servoAngle() == 0);
+}
+
+// --- Actuator Queue ---
+// Lock button pressed many times between two scans on a locked door (no code typed): more red
+// blinks than the queue holds. The red LED must still end up off.
+static void manyWrongCodes()
+{
+    DoorLock::start();
+    scanFor(10);
+    for (int i = 0; i < 8; i++) {
+        DoorLock::lockButtonPressed();
+    }
+    scanFor(5000);
+    CHECK(ledLevel(DOORLOCK_RED_LED_PIN) == LOW);
+    CHECK(!DoorLock::isActuatorBusy());
+}
+
+// An unlock right after a few wrong codes: the servo doesn't wait for their blinks
+static void unlockAfterWrongCodes()
+{
+    DoorLock::start();
+    scanFor(10);
+    for (int i = 0; i < 3; i++) {
+        DoorLock::lockButtonPressed();
+        scanFor(1);
+    }
+    DoorLock::DoorUnlock();
+    scanFor(1000);
+    CHECK(servoAngle() == 180);
+    CHECK(ledLevel(DOORLOCK_RED_LED_PIN) == LOW);
+}
+
+// --- Lock State Machine ---
+#if DOORLOCK_ENABLE_TASKS
+// Lock actions shaped like exampleMain's: move the servo, then keep the task busy for a while
+DL_TASK(unlockAction)
+{
+    DL_TASK_BEGIN();
+    DoorLock::open();
+    DL_WAIT_MS(500);
+    DL_TASK_END();
+}
+
+DL_TASK(lockAction)
+{
+    DL_TASK_BEGIN();
+    DoorLock::close();
+    DL_WAIT_MS(2000);
+    DL_TASK_END();
+}
+
+DL_TASK(incorrectAction)
+{
+    DL_TASK_BEGIN();
+    DL_WAIT_MS(1000);
+    DL_TASK_END();
+}
+
+// Unlock, lock (its task runs for 2 s), unlock with the right code within those 2 s, then lock
+// again while the lock task is still running: the door must really lock
+static void lockWhileLockTaskRuns()
+{
+    DoorLock::start();
+    DoorLock::setLockActions(unlockAction, lockAction, incorrectAction);
+    DoorLock::lockEvent(DL_LOCK_EVENT_UNLOCK);
+    scanFor(1000);
+    DoorLock::lockButtonPressed();
+    scanFor(100);
+    CHECK(DoorLock::isTaskRunning(lockAction));
+    DoorLock::lockEvent(DL_LOCK_EVENT_RIGHT_CODE);
+    scanFor(100);
+    CHECK(!DoorLock::locked);
+    CHECK(servoAngle() == 180);
+    DoorLock::lockButtonPressed();
+    scanFor(3000);
+    CHECK(DoorLock::locked);
+    CHECK(servoAngle() == 0);
+}
+#endif
+
+// Brings the door to `state` through lockEvent() (how == 0) or open()/close() (how == 1)
+static void reachState(uint8_t state, uint8_t how)
+{
+    if (how == 0) {
+        DoorLock::lockEvent(state == DL_LOCK_STATE_LOCKED ? DL_LOCK_EVENT_LOCK : DL_LOCK_EVENT_UNLOCK);
+    } else if (state == DL_LOCK_STATE_LOCKED) {
+        DoorLock::close();
+    } else {
+        DoorLock::open();
+    }
+}
+
+// Every state/event pair, with the built-in feedback and with the sketch's tasks, the state
+// reached through lockEvent() or open()/close(), and the feedback of the moves before it done
+// or still running: `locked` must end up where the table says, and the servo where `locked` says.
+static void lockTableAllPairs()
+{
+    DoorLock::start();
+    const unsigned long waits[] = {3000, 10};
+    for (uint8_t tasks = 0; tasks < (DOORLOCK_ENABLE_TASKS ? 2 : 1); tasks++) {
+#if DOORLOCK_ENABLE_TASKS
+        if (tasks) {
+            DoorLock::setLockActions(unlockAction, lockAction, incorrectAction);
+        } else {
+            DoorLock::setLockActions(nullptr, nullptr, nullptr);
+        }
+#endif
+        for (uint8_t state = 0; state < DL_LOCK_STATE_COUNT; state++) {
+            for (uint8_t event = 0; event < DL_LOCK_EVENT_COUNT; event++) {
+                for (uint8_t how = 0; how < 2; how++) {
+                    for (unsigned long wait : waits) {
+                        reachState(state, 0);
+                        scanFor(3000);
+                        reachState(1 - state, 0); // Away and back, so each of these is a real move
+                        scanFor(wait);
+                        reachState(state, how);
+                        scanFor(wait);
+                        CHECK(DoorLock::locked == (state == DL_LOCK_STATE_LOCKED));
+
+                        DoorLock::lockEvent(event);
+                        scanFor(3000);
+                        bool expected = DL_LOCK_TABLE[state][event].next == DL_LOCK_STATE_LOCKED;
+                        if (DoorLock::locked != expected || servoAngle() != (expected ? 0 : 180)) {
+                            printf("tasks %d state %d event %d how %d wait %lu: locked %d servo %d\n", tasks,
+                                   state, event, how, wait, DoorLock::locked, servoAngle());
+                        }
+                        CHECK(DoorLock::locked == expected);
+                        CHECK(servoAngle() == (expected ? 0 : 180));
+                    }
+                }
+            }
+        }
+    }
+}
+
+#if DOORLOCK_ENABLE_GESTURES
+// --- Button Events ---
+// Reads every waiting button event into `events`. Returns how many there were.
+static uint8_t takeButtonEvents(DoorLockButtonEvent* events, uint8_t room)
+{
+    uint8_t count = 0;
+    while (count < room && DoorLock::nextButtonEvent(events[count])) {
+        count++;
+    }
+    return count;
+}
+
+// Two quick taps: the second press comes with a double tap
+static void gestureDoubleTap()
+{
+    DoorLock::start();
+    scanFor(100);
+    tapButton(DOORLOCK_BUTTON1_PIN, 100, 100);
+    tapButton(DOORLOCK_BUTTON1_PIN, 100, 100);
+    DoorLockButtonEvent events[8];
+    const uint8_t expected[] = {DL_EVENT_PRESS, DL_EVENT_RELEASE, DL_EVENT_PRESS, DL_EVENT_DOUBLE_TAP,
+                                DL_EVENT_RELEASE};
+    CHECK(takeButtonEvents(events, 8) == sizeof(expected));
+    for (uint8_t i = 0; i < sizeof(expected); i++) {
+        CHECK(events[i].type == expected[i]);
+        CHECK(events[i].buttons == DL_BUTTON_1);
+    }
+    CHECK(events[3].ms == events[2].ms);
+
+    // A third tap starts a new pair, which the fourth ends; a tap after a longer gap is on its own
+    tapButton(DOORLOCK_BUTTON1_PIN, 100, 100);
+    tapButton(DOORLOCK_BUTTON1_PIN, 100, 500);
+    tapButton(DOORLOCK_BUTTON1_PIN, 100, 100);
+    CHECK(takeButtonEvents(events, 8) == 7);
+    for (uint8_t i = 0; i < 7; i++) {
+        CHECK((events[i].type == DL_EVENT_DOUBLE_TAP) == (i == 3));
+    }
+}
+
+// Holding a button: a long press after 800 ms, then a repeat every 200 ms until it is let go
+static void gestureLongPress()
+{
+    DoorLock::start();
+    scanFor(100);
+    tapButton(DOORLOCK_LOCK_BUTTON_PIN, 1500, 100);
+    DoorLockButtonEvent events[8];
+    uint8_t count = takeButtonEvents(events, 8);
+    CHECK(count == 6);
+    CHECK(events[0].type == DL_EVENT_PRESS);
+    CHECK(events[1].type == DL_EVENT_LONG_PRESS);
+    CHECK(events[1].ms - events[0].ms == 800);
+    for (uint8_t i = 2; i < 5; i++) {
+        CHECK(events[i].type == DL_EVENT_REPEAT);
+        CHECK(events[i].ms - events[i - 1].ms == 200);
+    }
+    CHECK(events[5].type == DL_EVENT_RELEASE);
+    for (uint8_t i = 0; i < count; i++) {
+        CHECK(events[i].buttons == DL_BUTTON_LOCK);
+    }
+}
+
+// Two buttons down together make a chord with both of them
+static void gestureChord()
+{
+    DoorLock::start();
+    scanFor(100);
+    setButton(DOORLOCK_BUTTON1_PIN, LOW);
+    scanFor(20);
+    setButton(DOORLOCK_BUTTON3_PIN, LOW);
+    scanFor(200);
+    DoorLockButtonEvent events[8];
+    CHECK(takeButtonEvents(events, 8) == 3);
+    CHECK(events[0].type == DL_EVENT_PRESS && events[0].buttons == DL_BUTTON_1);
+    CHECK(events[1].type == DL_EVENT_PRESS && events[1].buttons == DL_BUTTON_3);
+    CHECK(events[2].type == DL_EVENT_CHORD && events[2].buttons == (DL_BUTTON_1 | DL_BUTTON_3));
+}
+
+#if DOORLOCK_ENABLE_TELEMETRY
+// Events the sketch doesn't read in time are dropped, and counted in the telemetry
+static void gestureEventsDropped()
+{
+    DoorLock::start();
+    scanFor(100);
+    for (int i = 0; i < 10; i++) {
+        tapButton(DOORLOCK_BUTTON2_PIN, 100, 400); // A press and a release each, no double taps
+    }
+    DoorLockButtonEvent events[8];
+    CHECK(takeButtonEvents(events, 8) == 7);
+    CHECK(DoorLock::telemetry().eventsDropped == 13);
+    uint8_t snapshot[DL_TELEMETRY_SNAPSHOT_SIZE];
+    CHECK(DoorLock::telemetrySnapshot(snapshot) == DL_TELEMETRY_SNAPSHOT_SIZE);
+    CHECK(snapshot[35] == 13 && snapshot[36] == 0);
+}
+#endif
+#endif
+
+#if DOORLOCK_ENABLE_TELEMETRY && defined(HOST_TELEMETRY_FORMAT)
+// --- Telemetry ---
+// Reads the fields of `snapshot` the way Python's struct.unpack() reads `format` (only the "<",
+// "B", "H" and "I" that the client uses, with repeat counts). Returns how many fields there are.
+static uint8_t unpackLittleEndian(const char* format, const uint8_t* snapshot, uint32_t* fields,
+                                  size_t* bytes)
+{
+    uint8_t count = 0;
+    size_t offset = 0;
+    CHECK(*format++ == '<');
+    while (*format) {
+        unsigned repeat = 0;
+        while (*format >= '0' && *format <= '9') {
+            repeat = repeat * 10 + (*format++ - '0');
+        }
+        size_t size = *format == 'B' ? 1 : *format == 'H' ? 2 : *format == 'I' ? 4 : 0;
+        CHECK(size != 0);
+        format++;
+        for (unsigned i = 0; i < (repeat ? repeat : 1); i++) {
+            uint32_t value = 0;
+            for (size_t b = 0; b < size; b++) {
+                value |= (uint32_t)snapshot[offset + b] << (8 * b);
+            }
+            fields[count++] = value;
+            offset += size;
+        }
+    }
+    *bytes = offset;
+    return count;
+}
+
+// Every counter, made different from the others, lands where tools/doorlock_client.py's
+// TELEMETRY_FORMAT (passed in by host_test.py) reads it
+static void telemetrySnapshotLayout()
+{
+    DoorLock::start(); // Moves the servo once
+    scanFor(100);
+    for (int i = 0; i < 3; i++) {
+        DoorLock::open();
+        DoorLock::close();
+    }
+    DoorLock::open();
+    for (int i = 0; i < 5; i++) {
+        DoorLock::button2Pressed(); // Wrong: one digit of a three digit code, timed from here
+        scanFor(100 * (i + 1));
+        DoorLock::isAttemptCorrect();
+        DoorLock::resetAttempt();
+    }
+    typeCode(DOORLOCK_DEFAULT_CODE, DOORLOCK_DEFAULT_CODE_LENGTH);
+    DoorLock::isAttemptCorrect();
+    DoorLock::resetAttempt();
+    const int pins[] = {DOORLOCK_BUTTON1_PIN, DOORLOCK_BUTTON2_PIN, DOORLOCK_BUTTON3_PIN, DOORLOCK_LOCK_BUTTON_PIN};
+    for (int button = 0; button < 4; button++) {
+        for (int press = 0; press < 10 + button; press++) {
+            for (int bounce = 0; bounce < 2; bounce++) {
+                setButton(pins[button], LOW);
+                scanFor(1);
+                setButton(pins[button], HIGH);
+                scanFor(1);
+            }
+            tapButton(pins[button], 100, 400);
+        }
+    }
+
+    DoorLockTelemetry counters = DoorLock::telemetry();
+    const uint32_t expected[] = {
+        DL_TELEMETRY_VERSION, (uint32_t)millis(), counters.unlocks, counters.locks, counters.incorrect,
+        counters.servoMoves, counters.keyPresses[0], counters.keyPresses[1], counters.keyPresses[2],
+        counters.keyPresses[3], counters.bounces[0], counters.bounces[1], counters.bounces[2],
+        counters.bounces[3], counters.entries, counters.entryTimeMs, counters.eventsDropped};
+    const size_t fieldCount = sizeof(expected) / sizeof(expected[0]);
+    // Every field is used and no two of them can be swapped unnoticed
+    for (size_t i = 2; i < fieldCount; i++) {
+        for (size_t j = i + 1; j < fieldCount; j++) {
+            CHECK(expected[i] != expected[j]);
+        }
+    }
+
+    uint8_t snapshot[DL_TELEMETRY_SNAPSHOT_SIZE];
+    CHECK(DoorLock::telemetrySnapshot(snapshot) == DL_TELEMETRY_SNAPSHOT_SIZE);
+    uint32_t fields[32];
+    size_t bytes;
+    CHECK(unpackLittleEndian(HOST_TELEMETRY_FORMAT, snapshot, fields, &bytes) == fieldCount);
+    CHECK(bytes == DL_TELEMETRY_SNAPSHOT_SIZE);
+    for (size_t i = 0; i < fieldCount; i++) {
+        if (fields[i] != expected[i]) {
+            printf("field %zu: snapshot %lu, counters %lu\n", i, (unsigned long)fields[i], (unsigned long)expected[i]);
+        }
+        CHECK(fields[i] == expected[i]);
+    }
+}
+#endif
+
+#if DOORLOCK_ENABLE_ADAPTIVE_DEBOUNCE
+// --- Adaptive Debounce ---
+static int debouncedPresses = 0; // Presses of button 1 that scanDebounced() saw
+
+// Like scanFor(), counting the presses of button 1 the library reports
+static void scanDebounced(unsigned long ms)
+{
+    for (unsigned long i = 0; i < ms; i++) {
+        hostAdvanceMicros(1000);
+        DoorLock::scanButtons();
+        if (DoorLock::isButton1Pressed()) {
+            debouncedPresses++;
+        }
+    }
+}
+
+// Presses and releases button 1, its contacts bouncing every millisecond for `bounceMs` on the
+// way down and on the way up
+static void bouncyPress(int bounceMs)
+{
+    for (int edge = LOW; edge <= HIGH; edge++) {
+        int level = edge;
+        for (int i = 0; i < bounceMs; i++) {
+            setButton(DOORLOCK_BUTTON1_PIN, level);
+            scanDebounced(1);
+            level = !level;
+        }
+        setButton(DOORLOCK_BUTTON1_PIN, edge);
+        scanDebounced(60);
+    }
+}
+
+// Milliseconds from a clean press of button 1 until the library reports it
+static int pressLatency()
+{
+    int before = debouncedPresses;
+    int ms = 0;
+    setButton(DOORLOCK_BUTTON1_PIN, LOW);
+    while (debouncedPresses == before && ms < 100) {
+        scanDebounced(1);
+        ms++;
+    }
+    scanDebounced(60);
+    setButton(DOORLOCK_BUTTON1_PIN, HIGH);
+    scanDebounced(60);
+    return ms;
+}
+
+// A switch that bounces for 2 ms: the full window while learning, then one just above 2 ms, and
+// every press counted once all along
+static void debounceLearns()
+{
+    DoorLock::start();
+    scanDebounced(100);
+    DoorLockDebounceReport report = DoorLock::debounceReport(DL_BUTTON_1);
+    CHECK(report.windowMs == DL_DEBOUNCE_MAX_MS);
+    CHECK(report.learnedMs == 0);
+    CHECK(pressLatency() > DL_DEBOUNCE_MAX_MS);
+
+    for (int i = 0; i < 2 * DL_BOUNCE_ROUND; i++) {
+        bouncyPress(2);
+    }
+    report = DoorLock::debounceReport(DL_BUTTON_1);
+    CHECK(report.learnedMs == 2);
+    CHECK(report.windowMs < 10);
+    CHECK(!report.degrading);
+    CHECK(debouncedPresses == 1 + 2 * DL_BOUNCE_ROUND);
+    CHECK(pressLatency() < 10);
+}
+
+// Once learned, a bounce that comes after the short window is counted as late and widens the
+// window, without a second press
+static void debounceLateBounce()
+{
+    DoorLock::start();
+    scanDebounced(100);
+    for (int i = 0; i < 2 * DL_BOUNCE_ROUND; i++) {
+        bouncyPress(2);
+    }
+    int before = debouncedPresses;
+    setButton(DOORLOCK_BUTTON1_PIN, LOW);
+    scanDebounced(7);
+    setButton(DOORLOCK_BUTTON1_PIN, HIGH); // Past the window, but within DL_DEBOUNCE_HOLD_MS
+    scanDebounced(1);
+    setButton(DOORLOCK_BUTTON1_PIN, LOW);
+    scanDebounced(60);
+    setButton(DOORLOCK_BUTTON1_PIN, HIGH);
+    scanDebounced(60);
+    DoorLockDebounceReport report = DoorLock::debounceReport(DL_BUTTON_1);
+    CHECK(report.lateBounces == 1);
+    CHECK(report.windowMs > 7);
+    CHECK(debouncedPresses == before + 1);
+}
+
+// A switch learned at 2 ms that starts bouncing for 12 ms: the window grows past 12 ms, no press
+// is lost or doubled, and the switch is reported as wearing out
+static void debounceWearingSwitch()
+{
+    DoorLock::start();
+    scanDebounced(100);
+    for (int i = 0; i < 2 * DL_BOUNCE_ROUND; i++) {
+        bouncyPress(2);
+    }
+    int before = debouncedPresses;
+    for (int i = 0; i < 10; i++) {
+        bouncyPress(12);
+    }
+    DoorLockDebounceReport report = DoorLock::debounceReport(DL_BUTTON_1);
+    CHECK(report.degrading);
+    CHECK(report.windowMs > 12);
+    CHECK(report.learnedMs == 2);
+    CHECK(debouncedPresses == before + 10);
+}
+#endif
+
+// --- Secret Code ---
+// A code that doesn't fit DOORLOCK_MAX_CODE_LENGTH, or an empty one, is refused and the old
+// code keeps working; the longest one that fits is taken whole
+static void codeLengthLimit()
+{
+    DoorLock::start();
+    int tooLong[DOORLOCK_MAX_CODE_LENGTH + 1];
+    for (int i = 0; i <= DOORLOCK_MAX_CODE_LENGTH; i++) {
+        tooLong[i] = 1 + i % 3;
+    }
+    CHECK(!DoorLock::setCorrectCode(tooLong, DOORLOCK_MAX_CODE_LENGTH + 1));
+    CHECK(!DoorLock::stageCorrectCode(tooLong, 0));
+    CHECK(!DoorLock::commitCorrectCode());
+    typeCode(DOORLOCK_DEFAULT_CODE, DOORLOCK_DEFAULT_CODE_LENGTH);
+    CHECK(DoorLock::isAttemptCorrect());
+
+    DoorLock::resetAttempt();
+    CHECK(DoorLock::setCorrectCode(tooLong, DOORLOCK_MAX_CODE_LENGTH));
+    typeCode(tooLong, DOORLOCK_MAX_CODE_LENGTH);
+    CHECK(DoorLock::isAttemptCorrect());
+}
+
+// Codes staged and committed from a timer signal, which interrupts isAttemptCorrect() anywhere
+// like an interrupt handler would: two commits per signal, so the slot being compared gets
+// rewritten. isAttemptCorrect() must never match an attempt made of half of one code and half
+// of the next.
+static int signalCodes[3][4] = {{1, 1, 1, 1}, {2, 2, 2, 2}, {3, 3, 3, 3}};
+static volatile int signalNext = 1;
+static volatile unsigned long signalCount = 0;
+
+static void commitTwice(int)
+{
+    for (int i = 0; i < 2; i++) {
+        DoorLock::stageCorrectCode(signalCodes[signalNext], 4);
+        DoorLock::commitCorrectCode();
+        signalNext = (signalNext + 1) % 3;
+    }
+    signalCount = signalCount + 1;
+}
+
+static void commitDuringCompare()
+{
+    DoorLock::start();
+    DoorLock::setCorrectCode(signalCodes[0], 4);
+    const int torn[] = {1, 1, 2, 2}; // {2, 2, 2, 2} being overwritten with {1, 1, 1, 1}
+    typeCode(torn, 4);
+
+    signal(SIGALRM, commitTwice);
+    struct itimerval every = {{0, 20}, {0, 20}};
+    setitimer(ITIMER_REAL, &every, nullptr);
+    bool matched = false;
+    while (signalCount < 20000 && !matched) {
+        matched = DoorLock::isAttemptCorrect();
+    }
+    struct itimerval stop = {};
+    setitimer(ITIMER_REAL, &stop, nullptr);
+    CHECK(!matched);
+}
+
+#if DOORLOCK_ENABLE_SERIAL_COMMANDS
+// --- Serial Frames ---
+// Feeds `length` bytes to `parser`. Returns the payload length of the last frame that came out
+// whole, or -1 if none did.
+static int feedFrame(_FrameParser& parser, const uint8_t* bytes, size_t length)
+{
+    int result = -1;
+    for (size_t i = 0; i < length; i++) {
+        int payloadLength = parser.feed(bytes[i]);
+        if (payloadLength >= 0) {
+            result = payloadLength;
+        }
+    }
+    return result;
+}
+
+// Frames from tools/doorlock_client.py's encode_frame(): STATUS with sequence number 7, and
+// ENROLL 3-1-2 (payload 02 00 03 01 00 02, zeros included)
+static const uint8_t CLIENT_STATUS_FRAME[] = {0x00, 0x05, 0x01, 0x07, 0xD9, 0x5E, 0x00};
+static const uint8_t CLIENT_ENROLL_FRAME[] = {0x00, 0x02, 0x02, 0x03, 0x03, 0x01, 0x04, 0x02, 0xFE, 0x09, 0x00};
+
+// Every payload length up to DL_FRAME_MAX_PAYLOAD, with and without zeros, comes back out of
+// _writeFrame() and _FrameParser whole; the library encodes like the client does
+static void frameRoundTrip()
+{
+    uint8_t payload[DL_FRAME_MAX_PAYLOAD];
+    uint8_t frame[256];
+    _FrameParser parser;
+    for (uint8_t pattern = 0; pattern < 3; pattern++) {
+        for (uint8_t length = 1; length <= DL_FRAME_MAX_PAYLOAD; length++) {
+            for (uint8_t i = 0; i < length; i++) {
+                payload[i] = pattern == 0 ? 0x00 : pattern == 1 ? 0x80 + i : (i % 3 == 0 ? 0x00 : i);
+            }
+            hostSerialTake(frame, sizeof(frame));
+            _writeFrame(Serial, payload, length);
+            size_t frameLength = hostSerialTake(frame, sizeof(frame));
+            CHECK(frameLength == length + 5u); // 0x00, COBS code byte, payload, CRC, 0x00
+            for (size_t i = 1; i + 1 < frameLength; i++) {
+                CHECK(frame[i] != 0x00);
+            }
+            CHECK(feedFrame(parser, frame, frameLength) == length);
+            CHECK(memcmp(parser.payload(), payload, length) == 0);
+        }
+    }
+
+    const uint8_t status[] = {DL_CMD_STATUS, 7};
+    hostSerialTake(frame, sizeof(frame));
+    _writeFrame(Serial, status, sizeof(status));
+    CHECK(hostSerialTake(frame, sizeof(frame)) == sizeof(CLIENT_STATUS_FRAME));
+    CHECK(memcmp(frame, CLIENT_STATUS_FRAME, sizeof(CLIENT_STATUS_FRAME)) == 0);
+    CHECK(feedFrame(parser, CLIENT_ENROLL_FRAME, sizeof(CLIENT_ENROLL_FRAME)) == 6);
+    const uint8_t enroll[] = {DL_CMD_ENROLL, 0, 3, 1, 0, 2};
+    CHECK(memcmp(parser.payload(), enroll, sizeof(enroll)) == 0);
+}
+
+// A frame with any one byte changed is dropped, and the next good frame still comes through
+static void frameBadCrc()
+{
+    _FrameParser parser;
+    uint8_t frame[sizeof(CLIENT_ENROLL_FRAME)];
+    for (size_t i = 1; i + 1 < sizeof(frame); i++) {
+        memcpy(frame, CLIENT_ENROLL_FRAME, sizeof(frame));
+        frame[i] ^= 0x40; // Never makes a 0x00 here, so the frame keeps its length
+        CHECK(feedFrame(parser, frame, sizeof(frame)) == -1);
+        CHECK(feedFrame(parser, CLIENT_STATUS_FRAME, sizeof(CLIENT_STATUS_FRAME)) == 2);
+    }
+}
+
+// A frame longer than the buffer is thrown away up to its closing 0x00, however it is split
+// into COBS blocks; the parser then takes the next frame as usual
+static void frameOverflow()
+{
+    _FrameParser parser;
+    uint8_t frame[256];
+    for (uint8_t block = 1; block <= 60; block++) {
+        size_t n = 0;
+        frame[n++] = 0x00;
+        for (uint8_t data = 0; data < 60; data += block) {
+            uint8_t count = data + block <= 60 ? block : 60 - data;
+            frame[n++] = count + 1; // COBS code byte: `count` data bytes, then a 0x00
+            for (uint8_t i = 0; i < count; i++) {
+                frame[n++] = 0x55;
+            }
+        }
+        frame[n++] = 0x00;
+        CHECK(feedFrame(parser, frame, n) == -1);
+        CHECK(feedFrame(parser, CLIENT_STATUS_FRAME, sizeof(CLIENT_STATUS_FRAME)) == 2);
+    }
+}
+
+// --- Audit Log ---
+// Reads the audit log over the Serial command channel into `events`. Returns how many entries
+// there are.
+static uint8_t readAuditLog(uint8_t* events)
+{
+    uint8_t junk[256];
+    hostSerialTake(junk, sizeof(junk)); // Whatever was logged before
+    const uint8_t command[] = {DL_CMD_AUDIT, 1, 0};
+    uint8_t frame[16];
+    _writeFrame(Serial, command, sizeof(command)); // Encoded by the library, sent back to it
+    hostSerialInput(frame, hostSerialTake(frame, sizeof(frame)));
+    scanFor(5);
+
+    uint8_t reply[256];
+    size_t length = hostSerialTake(reply, sizeof(reply));
+    _FrameParser parser;
+    for (size_t i = 0; i < length; i++) {
+        int payloadLength = parser.feed(reply[i]);
+        if (payloadLength >= 5 && parser.payload()[0] == (DL_CMD_AUDIT | DL_REPLY_FLAG)) {
+            const uint8_t* payload = parser.payload();
+            for (uint8_t entry = 0; entry < payload[3] && entry < 8; entry++) {
+                events[entry] = payload[5 + entry * 5];
+            }
+            return payload[3];
+        }
+    }
+    CHECK(!"no reply to DL_CMD_AUDIT");
+    return 0;
+}
+
+// Setting the code at start() is not a code change; setCorrectCode() afterwards is
+static void codeChangedOnlyAfterStart()
+{
+    int code[] = {3, 2, 1};
+    DoorLock::start(code, 3);
+    DoorLock::enableSerialCommands(true);
+    uint8_t events[8];
+    CHECK(readAuditLog(events) == 1);
+    CHECK(events[0] == DL_AUDIT_BOOT);
+
+    int newCode[] = {1, 1, 2, 2};
+    DoorLock::setCorrectCode(newCode, 4);
+    CHECK(readAuditLog(events) == 2);
+    CHECK(events[1] == DL_AUDIT_CODE_CHANGED);
+}
+#endif
+
+#if DOORLOCK_USE_EXPANDER
+// --- I2C Port Expander ---
+// Which of the isButton...Pressed() checks report a press (bit 0 is button 1, bit 3 the lock button)
+static uint8_t pressedButtons()
+{
+    return (DoorLock::isButton1Pressed() ? 1 : 0) | (DoorLock::isButton2Pressed() ? 2 : 0) |
+           (DoorLock::isButton3Pressed() ? 4 : 0) | (DoorLock::isLockButtonPressed() ? 8 : 0);
+}
+
+// Buttons on expander pins 0-3 are read when INT says a pin changed, each as its own button; with
+// nothing pressed there is no I2C traffic. The LEDs on pins 4 and 5 light on the expander.
+static void expanderButtonReads()
+{
+    hostExpanderIntPin(DOORLOCK_EXPANDER_INT_PIN);
+    DoorLock::start(DL_EXPANDER_PIN, DL_EXPANDER_PIN + 1, DL_EXPANDER_PIN + 2, DL_EXPANDER_PIN + 3,
+                    DL_EXPANDER_PIN + 4, DL_EXPANDER_PIN + 5, DOORLOCK_SERVO_PIN, DOORLOCK_BUZZER_PIN);
+    scanFor(200);
+    CHECK(pressedButtons() == 0);
+    unsigned long i2cBytes = hostI2cBytes();
+    scanFor(1000);
+    CHECK(hostI2cBytes() == i2cBytes);
+
+    for (uint8_t pin = 0; pin < 4; pin++) {
+        hostExpanderPin(pin, LOW);
+        scanFor(100);
+        CHECK(pressedButtons() == (1 << pin));
+        CHECK(pressedButtons() == 0); // Each press is reported once
+        hostExpanderPin(pin, HIGH);
+        scanFor(100);
+        CHECK(pressedButtons() == 0);
+    }
+
+    DoorLock::DoorUnlock();
+    scanFor(10);
+    CHECK(hostExpanderOutput(4) == HIGH);
+    CHECK(hostExpanderOutput(5) == LOW);
+    scanFor(3000);
+    CHECK(hostExpanderOutput(4) == LOW);
+    DoorLock::DoorIncorrect();
+    scanFor(10);
+    CHECK(hostExpanderOutput(5) == HIGH);
+}
+#endif
+
+#if DOORLOCK_USE_SERVO_SENSE && !DOORLOCK_USE_LINUX_GPIO
+// --- Servo Current Sensing ---
+// Something holds the bolt at 60 degrees while unlocking: after the retry the lock reports a jam,
+// cuts the drive (no current any more) and stays locked, since the bolt never got out. Freed, the
+// next unlock works and the jam is over.
+static void servoJamOnUnlock()
+{
+    DoorLock::start();
+    scanFor(2000);
+    CHECK(!DoorLock::isJammed());
+    hostServoJam(60);
+    DoorLock::DoorUnlock();
+    scanFor(4000);
+    CHECK(DoorLock::isJammed());
+    CHECK(DoorLock::locked);
+    CHECK(hostServoAngle() == 60);
+    CHECK(analogRead(DOORLOCK_SERVO_SENSE_PIN) == 0);
+    scanFor(10000);
+    CHECK(analogRead(DOORLOCK_SERVO_SENSE_PIN) == 0); // Stays cut, no more tries
+
+    hostServoJam(-1);
+    DoorLock::DoorUnlock();
+    scanFor(2000);
+    CHECK(!DoorLock::isJammed());
+    CHECK(!DoorLock::locked);
+    CHECK(hostServoAngle() == 180);
+}
+
+// A jam while locking leaves `locked` false: the door isn't really locked
+static void servoJamOnLock()
+{
+    DoorLock::start();
+    DoorLock::DoorUnlock();
+    scanFor(2000);
+    hostServoJam(100);
+    DoorLock::DoorLock();
+    scanFor(4000);
+    CHECK(DoorLock::isJammed());
+    CHECK(!DoorLock::locked);
+}
+
+// A stall whose obstruction is gone by the retry: the bolt gets there, and it isn't a jam
+static void servoStallThenRetry()
+{
+    DoorLock::start();
+    DoorLock::DoorUnlock();
+    scanFor(2000);
+    hostServoJam(90);
+    DoorLock::DoorLock();
+    scanFor(DOORLOCK_SERVO_TRAVEL_MS + DL_SERVO_SENSE_GRACE_MS + 50); // Stalled, drive cut
+    CHECK(analogRead(DOORLOCK_SERVO_SENSE_PIN) == 0);
+    CHECK(!DoorLock::isJammed());
+    hostServoJam(-1);
+    scanFor(3000);
+    CHECK(hostServoAngle() == 0);
+    CHECK(!DoorLock::isJammed());
+    CHECK(DoorLock::locked);
+}
+#endif
+
+#if DOORLOCK_USE_SCHEDULES
+// --- Access Schedules ---
+// Whether the default code, typed now, is let in
+static bool codeAllowedNow()
+{
+    DoorLock::resetAttempt();
+    typeCode(DOORLOCK_DEFAULT_CODE, DOORLOCK_DEFAULT_CODE_LENGTH);
+    bool allowed = DoorLock::isAttemptCorrect();
+    DoorLock::resetAttempt();
+    return allowed;
+}
+
+// A window of 9:00-17:00 with 12:00-12:15 kept out: the code is refused in the last second before
+// each boundary where it opens and let in from the first second after it, and the other way round
+// where it closes. With DOORLOCK_USE_DS3231 the time is read from the simulated chip at every
+// boundary, and a chip that lost the time keeps the scheduled code out.
+static void scheduleSlotBoundary()
+{
+    DoorLock::start();
+    CHECK(DoorLock::setAccessWindow(0, DL_SCHEDULE_EVERY_DAY, 9, 0, 17, 0, true));
+    CHECK(DoorLock::setAccessWindow(0, DL_SCHEDULE_EVERY_DAY, 12, 0, 12, 15, false));
+    const uint8_t boundaries[][2] = {{9, 0}, {12, 0}, {12, 15}, {17, 0}};
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t hour = boundaries[i][0] - (boundaries[i][1] == 0 ? 1 : 0);
+        uint8_t minute = boundaries[i][1] == 0 ? 59 : boundaries[i][1] - 1;
+        CHECK(DoorLock::setDateTime(2024, 3, 15, hour, minute, 58));
+        bool opens = i % 2 == 0;
+        scanFor(1500); // xx:59:59.5
+        CHECK(codeAllowedNow() == !opens);
+        scanFor(1000); // xx:00:00.5
+        CHECK(codeAllowedNow() == opens);
+    }
+
+    // The next day, a Saturday, opens at 9:00 too
+    CHECK(DoorLock::setDateTime(2024, 3, 16, 8, 59, 59));
+    scanFor(500);
+    CHECK(!codeAllowedNow());
+    scanFor(1000);
+    CHECK(codeAllowedNow());
+
+#if DOORLOCK_USE_DS3231
+    hostRtcLoseTime();
+    scanFor(15UL * 60 * 1000); // The next boundary, where the chip is read again
+    CHECK(!codeAllowedNow());
+    DoorLock::clearAccessSchedule(0);
+    CHECK(codeAllowedNow()); // Without a schedule the time doesn't matter
+#endif
+}
+#endif
+
+#if DISPLAY_TESTS
+// --- Status Display ---
+// Checks the simulated SSD1306 shows the frame in HOST_FRAMES_DIR/NAME.pbm. With
+// HOST_UPDATE_FRAMES set in the environment (host_test.py --update-frames) it writes the file
+// instead.
+static void checkFrame(const char* name)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.pbm", HOST_FRAMES_DIR, name);
+    char* shown = nullptr;
+    size_t shownLength = 0;
+    FILE* frame = open_memstream(&shown, &shownLength);
+    hostDisplayDump(frame, 32);
+    fclose(frame);
+
+    if (getenv("HOST_UPDATE_FRAMES")) {
+        frame = fopen(path, "w");
+        CHECK(frame != nullptr);
+        fwrite(shown, 1, shownLength, frame);
+        fclose(frame);
+    } else {
+        char expected[8192];
+        size_t expectedLength = 0;
+        frame = fopen(path, "r");
+        if (frame) {
+            expectedLength = fread(expected, 1, sizeof(expected), frame);
+            fclose(frame);
+        }
+        if (expectedLength != shownLength || memcmp(expected, shown, shownLength) != 0) {
+            printf("The display doesn't show %s. It shows:\n%s", path, shown);
+            exit(1);
+        }
+    }
+    free(shown);
+}
+
+// Each lock state on the screen: locked after start-up, digits being typed (as stars), unlocked,
+// a wrong code, and locked again once the message has gone. Typing a digit only sends the one
+// cell that changed.
+static void displayLockStates()
+{
+    DoorLock::start();
+    scanFor(500); // The whole screen goes out a few characters per scan
+    checkFrame("locked");
+
+    unsigned long dataBytes = hostDisplayDataBytes();
+    typeCode(DOORLOCK_DEFAULT_CODE, 1);
+    scanFor(100);
+    CHECK(hostDisplayDataBytes() - dataBytes == 6); // One 6 pixel wide cell: '_' became '*'
+    typeCode(DOORLOCK_DEFAULT_CODE + 1, 1);
+    scanFor(100);
+    checkFrame("typing");
+
+    typeCode(DOORLOCK_DEFAULT_CODE + 2, DOORLOCK_DEFAULT_CODE_LENGTH - 2);
+    DoorLock::lockButtonPressed();
+    scanFor(3000);
+    CHECK(!DoorLock::locked);
+    checkFrame("unlocked");
+
+    DoorLock::lockButtonPressed();
+    scanFor(3000);
+    const int wrongCode[] = {3, 3, 3};
+    typeCode(wrongCode, 3);
+    DoorLock::lockButtonPressed();
+    scanFor(500);
+    CHECK(DoorLock::locked);
+    checkFrame("access_denied");
+
+    scanFor(3000);
+    checkFrame("message_gone");
+}
+#endif
+
+#if DOORLOCK_USE_RFID && defined(HOST_RFID_TEST_CARDS)
+// --- RFID Badges ---
+// Every card on the list host_test.py gave tools/rfid_table.py is found with its position as its
+// number, and none of the others (some of them the first 4 bytes of an enrolled card) are found
+static void rfidCardNumbers()
+{
+    const uint16_t enrolled = sizeof(HOST_ENROLLED_CARDS) / sizeof(HOST_ENROLLED_CARDS[0]);
+    CHECK(DL_RFID_CARD_COUNT == enrolled);
+    for (uint16_t i = 0; i < enrolled; i++) {
+        CHECK(_rfidCardNumber(&HOST_ENROLLED_CARDS[i][1], HOST_ENROLLED_CARDS[i][0]) == (int16_t)i);
+        CHECK(DoorLock::findCard(&HOST_ENROLLED_CARDS[i][1], HOST_ENROLLED_CARDS[i][0]) == (int16_t)i);
+    }
+    for (const uint8_t* card : HOST_UNKNOWN_CARDS) {
+        CHECK(_rfidCardNumber(card + 1, card[0]) == -1);
+    }
+}
+
+// Holds `card` (length, UID) against the reader for a second, takes it away again, and checks
+// the reader read the whole UID
+static void presentCard(const uint8_t* card)
+{
+    hostRfidCard(card + 1, card[0]);
+    scanFor(1000);
+    hostRfidCard(nullptr, 0);
+    uint8_t uid[DL_RFID_MAX_UID];
+    CHECK(DoorLock::lastCard(uid) == card[0]);
+    CHECK(memcmp(uid, card + 1, card[0]) == 0);
+}
+
+// An enrolled badge of each size (one, two and three cascade levels) opens the door; locking it
+// again in between
+static void rfidBadgeUnlocks()
+{
+    DoorLock::start();
+    scanFor(10);
+    const uint8_t lengths[] = {4, 7, 10};
+    for (uint8_t length : lengths) {
+        const uint8_t* card = nullptr;
+        for (const uint8_t* enrolled : HOST_ENROLLED_CARDS) {
+            if (enrolled[0] == length) {
+                card = enrolled;
+                break;
+            }
+        }
+        CHECK(card != nullptr);
+        CHECK(DoorLock::locked);
+        presentCard(card);
+        scanFor(2000);
+        CHECK(!DoorLock::locked);
+        CHECK(servoAngle() == 180);
+        DoorLock::lockButtonPressed();
+        scanFor(3000);
+        CHECK(DoorLock::locked);
+        CHECK(servoAngle() == 0);
+    }
+}
+
+// A badge that isn't enrolled, of each size, leaves the door locked
+static void rfidUnknownBadge()
+{
+    DoorLock::start();
+    scanFor(10);
+    for (uint8_t i = 0; i < 3; i++) {
+        presentCard(HOST_UNKNOWN_CARDS[i]);
+        scanFor(3000);
+        CHECK(DoorLock::locked);
+        CHECK(servoAngle() == 0);
+    }
+}
+#endif
+
+#if DOORLOCK_USE_TOTP
+// --- One-Time Codes ---
+// The RFC 6238 test secret "12345678901234567890". Its codes, from
+// tools/totp_code.py --hex 3132333435363738393031323334353637383930 --time 2024-03-15T14:30:00
+// (and 14:30:30 for the next one):
+static const uint8_t TOTP_SECRET[20] = {0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30,
+                                        0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30};
+static const int TOTP_CODE_1430[] = {2, 1, 1, 2, 1, 1, 1, 3};
+static const int TOTP_CODE_1430_NEXT[] = {2, 2, 2, 2, 2, 3, 1, 2};
+static_assert(DOORLOCK_TOTP_DIGITS == 8, "The codes above have 8 digits");
+
+// The code of the current and of the next 30 seconds each open the door once; typed again, the
+// first one is a wrong code
+static void oneTimeCodeOnce()
+{
+    DoorLock::start();
+    CHECK(DoorLock::setDateTime(2024, 3, 15, 14, 30, 0));
+    CHECK(DoorLock::setOneTimeSecret(0, TOTP_SECRET, sizeof(TOTP_SECRET)));
+    scanFor(500); // Time to work the codes out
+
+    typeCode(TOTP_CODE_1430, 8);
+    DoorLock::lockButtonPressed();
+    scanFor(3000);
+    CHECK(!DoorLock::locked);
+    DoorLock::lockButtonPressed();
+    scanFor(3000);
+    CHECK(DoorLock::locked);
+
+    typeCode(TOTP_CODE_1430, 8);
+    DoorLock::lockButtonPressed();
+    scanFor(3000);
+    CHECK(DoorLock::locked);
+
+    typeCode(TOTP_CODE_1430_NEXT, 8);
+    DoorLock::lockButtonPressed();
+    scanFor(3000);
+    CHECK(!DoorLock::locked);
+}
+#endif
+
+#if DOORLOCK_USE_LINUX_GPIO
+// --- Linux GPIO ---
+// Milliseconds of real time and of CPU time `run` takes
+static void measure(void (*run)(), double* wallMs, double* cpuMs)
+{
+    struct timespec wall0, wall1, cpu0, cpu1;
+    clock_gettime(CLOCK_MONOTONIC, &wall0);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu0);
+    run();
+    clock_gettime(CLOCK_MONOTONIC, &wall1);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu1);
+    *wallMs = (wall1.tv_sec - wall0.tv_sec) * 1e3 + (wall1.tv_nsec - wall0.tv_nsec) / 1e6;
+    *cpuMs = (cpu1.tv_sec - cpu0.tv_sec) * 1e3 + (cpu1.tv_nsec - cpu0.tv_nsec) / 1e6;
+}
+
+// Presses come in as edge events; the lines are read once when requested and never again
+static void linuxButtonEdges()
+{
+    DoorLock::start();
+    CHECK(hostGpioRequested(DOORLOCK_BUTTON1_PIN));
+    CHECK(hostGpioRequested(DOORLOCK_GREEN_LED_PIN));
+    unsigned long reads = hostGpioReads();
+    scanFor(100);
+    hostGpioLine(DOORLOCK_BUTTON1_PIN, LOW);
+    scanFor(100);
+    CHECK(DoorLock::isButton1Pressed());
+    hostGpioLine(DOORLOCK_BUTTON1_PIN, HIGH);
+    scanFor(100);
+    CHECK(!DoorLock::isButton1Pressed());
+    CHECK(hostGpioReads() == reads);
+
+    // New pins give the old lines back
+    DoorLock::setPins(20, 21, 22, 23, 24, 25, DOORLOCK_SERVO_PIN, DOORLOCK_BUZZER_PIN);
+    CHECK(!hostGpioRequested(DOORLOCK_BUTTON1_PIN));
+    CHECK(hostGpioRequested(20));
+    hostGpioLine(22, LOW);
+    scanFor(100);
+    CHECK(DoorLock::isButton3Pressed());
+}
+
+// The servo and the buzzer are PWM channels, the LEDs output lines
+static void linuxOutputs()
+{
+    DoorLock::start();
+    DoorLock::DoorUnlock();
+    scanFor(10);
+    CHECK(servoAngle() == 180);
+    CHECK(hostPwm(DOORLOCK_LINUX_SERVO_PWM, "period") == 20000000);
+    CHECK(hostPwm(DOORLOCK_LINUX_SERVO_PWM, "enable") == 1);
+    CHECK(ledLevel(DOORLOCK_GREEN_LED_PIN) == HIGH);
+    scanFor(1500);
+    CHECK(ledLevel(DOORLOCK_GREEN_LED_PIN) == LOW);
+
+    DoorLock::buzzerOn(2000);
+    CHECK(hostPwm(DOORLOCK_LINUX_BUZZER_PWM, "period") == 500000);
+    CHECK(hostPwm(DOORLOCK_LINUX_BUZZER_PWM, "duty_cycle") == 250000);
+    CHECK(hostPwm(DOORLOCK_LINUX_BUZZER_PWM, "enable") == 1);
+    DoorLock::buzzerOff();
+    CHECK(hostPwm(DOORLOCK_LINUX_BUZZER_PWM, "enable") == 0);
+}
+
+// idleUntilEvent() sleeps without using the CPU, and a button edge ends the sleep at once
+static void linuxIdleUntilEdge()
+{
+    DoorLock::start();
+    scanFor(3000); // Until the actuators, and the servo sense if built in, are done
+    double wallMs, cpuMs;
+    measure(DoorLock::idleUntilEvent, &wallMs, &cpuMs);
+    CHECK(wallMs >= DOORLOCK_LINUX_IDLE_MS * 0.9);
+    CHECK(cpuMs < 10);
+
+    hostGpioLine(DOORLOCK_LOCK_BUTTON_PIN, LOW);
+    measure(DoorLock::idleUntilEvent, &wallMs, &cpuMs);
+    CHECK(wallMs < DOORLOCK_LINUX_IDLE_MS / 2);
+    scanFor(100);
+    CHECK(DoorLock::isLockButtonPressed());
+}
+#endif
+
+#if DOORLOCK_FAST_BOOT
+// --- Fast Boot ---
+const uint8_t SAVED_STATE_MARKER = 0xD1; // Same as EEPROM_STATE_MARKER in DoorLock.cpp
+
+// The door was unlocked when the board reset: the relock still happens, and the saved state
+// follows every change
+static void relockAfterReset()
+{
+    EEPROM.write(DOORLOCK_EEPROM_ADDRESS, SAVED_STATE_MARKER);
+    EEPROM.write(DOORLOCK_EEPROM_ADDRESS + 1, 0);
+    DoorLock::start();
+    CHECK(!DoorLock::locked);
+    DoorLock::setAutoRelock(2, nullptr);
+    scanFor(3000);
+    CHECK(DoorLock::locked);
+    CHECK(servoAngle() == 0);
+    CHECK(EEPROM.read(DOORLOCK_EEPROM_ADDRESS + 1) == 1);
+
+    DoorLock::open();
+    CHECK(EEPROM.read(DOORLOCK_EEPROM_ADDRESS + 1) == 0);
+    DoorLock::lockEvent(DL_LOCK_EVENT_LOCK);
+    CHECK(EEPROM.read(DOORLOCK_EEPROM_ADDRESS + 1) == 1);
+}
+#endif
+
+static const Test TESTS[] = {
+    {"relock/after_open", relockAfterOpen},
+    {"actuators/many_wrong_codes", manyWrongCodes},
+    {"actuators/unlock_after_wrong_codes", unlockAfterWrongCodes},
+#if DOORLOCK_ENABLE_TASKS
+    {"lockstate/lock_while_lock_task_runs", lockWhileLockTaskRuns},
+#endif
+    {"lockstate/all_pairs", lockTableAllPairs},
+#if DOORLOCK_ENABLE_GESTURES
+    {"gestures/double_tap", gestureDoubleTap},
+    {"gestures/long_press", gestureLongPress},
+    {"gestures/chord", gestureChord},
+#if DOORLOCK_ENABLE_TELEMETRY
+    {"gestures/events_dropped", gestureEventsDropped},
+#endif
+#endif
+#if DOORLOCK_ENABLE_TELEMETRY && defined(HOST_TELEMETRY_FORMAT)
+    {"telemetry/snapshot_layout", telemetrySnapshotLayout},
+#endif
+#if DOORLOCK_ENABLE_ADAPTIVE_DEBOUNCE
+    {"debounce/learns", debounceLearns},
+    {"debounce/late_bounce", debounceLateBounce},
+    {"debounce/wearing_switch", debounceWearingSwitch},
+#endif
+    {"code/length_limit", codeLengthLimit},
+    {"code/commit_during_compare", commitDuringCompare},
+#if DOORLOCK_ENABLE_SERIAL_COMMANDS
+    {"frames/round_trip", frameRoundTrip},
+    {"frames/bad_crc", frameBadCrc},
+    {"frames/overflow", frameOverflow},
+    {"audit/code_changed_only_after_start", codeChangedOnlyAfterStart},
+#endif
+#if DOORLOCK_USE_EXPANDER
+    {"expander/button_reads", expanderButtonReads},
+#endif
+#if DOORLOCK_USE_SERVO_SENSE && !DOORLOCK_USE_LINUX_GPIO
+    {"servosense/jam_on_unlock", servoJamOnUnlock},
+    {"servosense/jam_on_lock", servoJamOnLock},
+    {"servosense/stall_then_retry", servoStallThenRetry},
+#endif
+#if DOORLOCK_USE_SCHEDULES
+    {"schedules/slot_boundary", scheduleSlotBoundary},
+#endif
+#if DISPLAY_TESTS
+    {"display/lock_states", displayLockStates},
+#endif
+#if DOORLOCK_USE_RFID && defined(HOST_RFID_TEST_CARDS)
+    {"rfid/card_numbers", rfidCardNumbers},
+    {"rfid/badge_unlocks", rfidBadgeUnlocks},
+    {"rfid/unknown_badge", rfidUnknownBadge},
+#endif
+#if DOORLOCK_USE_TOTP
+    {"totp/code_opens_once", oneTimeCodeOnce},
+#endif
+#if DOORLOCK_USE_LINUX_GPIO
+    {"linux/button_edges", linuxButtonEdges},
+    {"linux/outputs", linuxOutputs},
+    {"linux/idle_until_edge", linuxIdleUntilEdge},
+#endif
+#if DOORLOCK_FAST_BOOT
+    {"fastboot/relock_after_reset", relockAfterReset},
+#endif
+};
+
+// --- Runner ---
+int main(int argc, char** argv)
+{
+    const size_t count = sizeof(TESTS) / sizeof(TESTS[0]);
+    if (argc < 2) {
+        for (size_t i = 0; i < count; i++) {
+            printf("%s\n", TESTS[i].name);
+        }
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(TESTS[i].name, argv[1]) == 0) {
+            TESTS[i].run();
+            return 0;
+        }
+    }
+    printf("no test named %s\n", argv[1]);
+    return 2;
+}
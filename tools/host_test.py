@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Host tests of the DoorLock library.
+
+Builds tools/host_bench/tests.cpp with the library from a sketch's src/
+folder (exampleMain by default) for the PC, against the same Arduino
+stand-in as host_bench.py, and runs every test in a process of its own, so
+each test starts with a freshly constructed lock. Prints one line per test
+and exits with status 1 if any of them failed.
+
+    host_test.py
+    host_test.py --filter relock
+    host_test.py -D DOORLOCK_FAST_BOOT=1
+    host_test.py -D DOORLOCK_USE_LINUX_GPIO=1
+    host_test.py -D DOORLOCK_USE_RFID=1
+    host_test.py -D DOORLOCK_USE_DISPLAY=1 --update-frames
+
+With DOORLOCK_USE_RFID, the library is built against a card table that
+tools/rfid_table.py makes from a made-up list of single, double and triple
+size UIDs, and the rfid/ tests get the same list (see rfid_cards()). The
+display/ tests compare the simulated screen with the PBM images in
+tools/host_bench/frames; --update-frames writes what it shows there instead,
+to check by eye and commit after a deliberate change to the screen.
+"""
+
+import argparse
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+from doorlock_client import TELEMETRY_FORMAT
+from host_bench import HOST, REPO, build
+
+RFID_ENROLLED = 60  # Cards in the test table, a third each of 4, 7 and 10 byte UIDs
+RFID_UNKNOWN = 30   # Cards the rfid/ tests hold up that aren't in it
+
+
+def _c_rows(uids):
+    return "\n".join("    {%d, %s}," % (len(uid), ", ".join("0x%02X" % byte for byte in uid)) for uid in uids)
+
+
+def rfid_cards(work):
+    """Enrolls made-up cards with tools/rfid_table.py and writes them out for tests.cpp, in list
+    order (so the index is the card number), along with cards that aren't enrolled. Returns the
+    defines that point the library and the tests at the two headers."""
+    generator = random.Random(2)  # Same cards every time
+    byte_values = [value for value in range(256) if value != 0x88]  # 0x88 is the cascade tag
+    seen = set()
+
+    def made_up(length):
+        while True:
+            uid = bytes(generator.choice(byte_values) for _ in range(length))
+            if uid not in seen:
+                seen.add(uid)
+                return uid
+
+    enrolled = [made_up((4, 7, 10)[number % 3]) for number in range(RFID_ENROLLED)]
+    unknown = [made_up((4, 7, 10)[number % 3]) for number in range(RFID_UNKNOWN)]
+    # The start of an enrolled card is a different card
+    unknown += [uid[:4] for uid in enrolled[1:3] if uid[:4] not in seen]
+
+    cards = os.path.join(work, "cards.txt")
+    with open(cards, "w") as lines:
+        lines.write("".join(":".join("%02X" % byte for byte in uid) + "\n" for uid in enrolled))
+    table = os.path.join(work, "RfidCards.h")
+    subprocess.check_output([sys.executable, os.path.join(REPO, "tools", "rfid_table.py"), cards,
+                             "--output", table])
+
+    lists = os.path.join(work, "test_cards.h")
+    with open(lists, "w") as header:
+        header.write("// Made by tools/host_test.py: UID length, then the UID\n"
+                     "static const uint8_t HOST_ENROLLED_CARDS[][1 + DL_RFID_MAX_UID] = {\n%s\n};\n"
+                     "static const uint8_t HOST_UNKNOWN_CARDS[][1 + DL_RFID_MAX_UID] = {\n%s\n};\n"
+                     % (_c_rows(enrolled), _c_rows(unknown)))
+    return ['DOORLOCK_RFID_CARDS="%s"' % table, 'HOST_RFID_TEST_CARDS="%s"' % lists]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("sketch", nargs="?", default="exampleMain",
+                        help="sketch folder in this repository (default: exampleMain)")
+    parser.add_argument("-D", dest="defines", action="append", default=[], metavar="NAME=VALUE",
+                        help="library build option, e.g. -D DOORLOCK_FAST_BOOT=1 (can be repeated)")
+    parser.add_argument("--filter", default="", help="only run tests whose name contains this")
+    parser.add_argument("--update-frames", action="store_true",
+                        help="write the display frames the display/ tests check against")
+    args = parser.parse_args()
+
+    compiler = os.environ.get("CXX") or shutil.which("g++") or shutil.which("clang++")
+    if not compiler:
+        sys.exit("no C++ compiler found; set CXX")
+
+    work = tempfile.mkdtemp(prefix="doorlock-test-")
+    failed = 0
+    try:
+        # The telemetry test reads the snapshot with the client's own layout
+        defines = args.defines + ['HOST_TELEMETRY_FORMAT="%s"' % TELEMETRY_FORMAT,
+                                  'HOST_FRAMES_DIR="%s"' % os.path.join(HOST, "frames")]
+        if "DOORLOCK_USE_RFID=1" in args.defines:
+            defines += rfid_cards(work)
+        program = build(os.path.join(REPO, args.sketch), compiler, work, defines,
+                        main="tests.cpp", with_sketch=False)
+        names = subprocess.check_output([program], universal_newlines=True).split()
+        environment = dict(os.environ)
+        if args.update_frames:
+            environment["HOST_UPDATE_FRAMES"] = "1"
+        for name in names:
+            if args.filter not in name:
+                continue
+            result = subprocess.run([program, name], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                    universal_newlines=True, env=environment)
+            if result.returncode == 0:
+                print("ok   %s" % name)
+            else:
+                failed += 1
+                print("FAIL %s\n%s" % (name, result.stdout.rstrip()))
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+    if failed:
+        sys.exit("%d test(s) failed" % failed)
+
+
+if __name__ == "__main__":
+    main()
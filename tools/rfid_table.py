@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""Makes the enrolled-card table for the DoorLock RFID reader.
+
+Reads card UIDs (one per line, in hex: "04:A2:3B:11:22:80:00" or "DEADBEEF";
+"#" starts a comment) and writes src/RfidCards.h: a minimal perfect hash table
+in flash with exactly one slot per card. The library finds a card with two
+hashes and one compare (see _rfidCardNumber() in src/RfidReader.cpp), whether
+3 or 3000 cards are enrolled. Each card keeps its number: its position in the
+list, counting from 0 and skipping comments.
+
+Build the sketch with DOORLOCK_USE_RFID set to 1 after running this. Only the
+Python standard library is used.
+
+    rfid_table.py cards.txt
+    rfid_table.py cards.txt --output templateMain/src/RfidCards.h
+    rfid_table.py --random 3000 --output /tmp/cards.h     (for benchmarks)
+"""
+
+import argparse
+import os
+import random
+import sys
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+UID_LENGTHS = (4, 7, 10)  # Single, double and triple size UIDs
+BUCKET_SIZE = 4           # Cards per bucket on average; smaller is faster to build, bigger uses less flash
+MAX_SEED = 0xFFFF
+
+
+def _hash(seed, uid):
+    """Must match _rfidHash() in src/RfidReader.cpp."""
+    value = 2166136261 ^ seed
+    for byte in uid:
+        value ^= byte
+        value = (value * 16777619) & 0xFFFFFFFF
+    value ^= value >> 16
+    value = (value * 0x85EBCA6B) & 0xFFFFFFFF
+    value ^= value >> 13
+    return value
+
+
+def _reduce(value, count):
+    """Must match _rfidReduce() in src/RfidReader.cpp."""
+    return ((value >> 16) * count) >> 16
+
+
+def read_cards(path):
+    uids = []
+    with open(path) as lines:
+        for number, line in enumerate(lines, 1):
+            text = line.split("#", 1)[0].strip().replace(":", "").replace(" ", "")
+            if not text:
+                continue
+            try:
+                uid = bytes.fromhex(text)
+            except ValueError:
+                sys.exit("%s:%d: not a hex UID: %s" % (path, number, line.strip()))
+            if len(uid) not in UID_LENGTHS:
+                sys.exit("%s:%d: a UID has 4, 7 or 10 bytes, not %d" % (path, number, len(uid)))
+            uids.append(uid)
+    return uids
+
+
+def build_table(uids):
+    """Returns (seeds, slots): a seed per bucket and the card number in each slot."""
+    count = len(uids)
+    bucket_count = max(1, (count + BUCKET_SIZE - 1) // BUCKET_SIZE)
+    while True:
+        buckets = [[] for _ in range(bucket_count)]
+        for number, uid in enumerate(uids):
+            buckets[_reduce(_hash(0, uid), bucket_count)].append(number)
+
+        # Biggest buckets first, while there are still plenty of free slots
+        seeds = [0] * bucket_count
+        slots = [None] * count
+        failed = False
+        for bucket in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+            cards = buckets[bucket]
+            if not cards:
+                break
+            for seed in range(1, MAX_SEED + 1):
+                places = [_reduce(_hash(seed, uids[number]), count) for number in cards]
+                if len(set(places)) == len(places) and all(slots[place] is None for place in places):
+                    break
+            else:
+                failed = True
+                break
+            seeds[bucket] = seed
+            for number, place in zip(cards, places):
+                slots[place] = number
+        if not failed:
+            return seeds, slots
+        bucket_count *= 2  # Smaller buckets are easier to place
+
+
+def write_header(path, source, uids, seeds, slots):
+    uid_bytes = max([4] + [len(uid) for uid in uids])
+    lines = [
+        "#ifndef ARDUINO_DOORLOCK_RFIDCARDS_H",
+        "#define ARDUINO_DOORLOCK_RFIDCARDS_H",
+        "",
+        "// --- Enrolled RFID Cards ---",
+        "// Made by tools/rfid_table.py from %s. Don't edit this file; run the script again." % source,
+        "",
+        "const uint16_t DL_RFID_CARD_COUNT = %d;" % len(uids),
+        "const uint16_t DL_RFID_BUCKET_COUNT = %d;" % len(seeds),
+        "const uint8_t DL_RFID_UID_BYTES = %d;" % uid_bytes,
+        "",
+        "// Seed of the second hash, per bucket",
+        "const uint16_t DL_RFID_SEEDS[%d] PROGMEM = {" % len(seeds),
+    ]
+    for start in range(0, len(seeds), 12):
+        lines.append("    " + " ".join("%d," % seed for seed in seeds[start:start + 12]))
+    lines += [
+        "};",
+        "",
+        "// Per slot: UID length, UID (padded with zeros), card number (low byte first)",
+        "const uint8_t DL_RFID_CARDS[%d][1 + DL_RFID_UID_BYTES + 2] PROGMEM = {" % max(1, len(slots)),
+    ]
+    if not slots:
+        lines.append("    {0}, // No cards enrolled")
+    for number in slots:
+        uid = uids[number]
+        row = [len(uid)] + list(uid) + [0] * (uid_bytes - len(uid)) + [number & 0xFF, number >> 8]
+        lines.append("    {" + ", ".join("0x%02X" % byte for byte in row) + "},")
+    lines += ["};", "", "#endif // ARDUINO_DOORLOCK_RFIDCARDS_H", ""]
+    with open(path, "w") as header:
+        header.write("\n".join(lines))
+    return len(seeds) * 2 + max(1, len(slots)) * (uid_bytes + 3)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("cards", nargs="?", help="text file with one card UID per line")
+    parser.add_argument("--output", default=os.path.join(REPO, "exampleMain", "src", "RfidCards.h"),
+                        help="header to write (default: exampleMain/src/RfidCards.h)")
+    parser.add_argument("--random", type=int, metavar="N", help="make up N random 4 byte UIDs instead")
+    args = parser.parse_args()
+
+    if args.random is not None:
+        generator = random.Random(1)  # Same cards every time
+        uids = list(set(bytes(generator.randrange(256) for _ in range(4)) for _ in range(args.random)))
+        uids.sort()
+        source = "%d random UIDs" % len(uids)
+    elif args.cards:
+        uids = read_cards(args.cards)
+        source = os.path.basename(args.cards)
+    else:
+        parser.error("give a cards file or --random N")
+
+    if len(set(uids)) != len(uids):
+        sys.exit("the same UID is in the list more than once")
+    if len(uids) > 0x7FFF:
+        sys.exit("too many cards (at most 32767)")
+
+    seeds, slots = build_table(uids)
+    flash = write_header(args.output, source, uids, seeds, slots)
+    print("%d cards, %d buckets, %d bytes of flash -> %s" % (len(uids), len(seeds), flash, args.output))
+
+
+if __name__ == "__main__":
+    main()
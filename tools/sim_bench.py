@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Cycle counts of the DoorLock firmware on a simulated ATmega328P.
+
+Builds sketches (exampleMain and templateMain by default) for the Uno with
+arduino-cli, runs each firmware image in simavr for a few seconds while
+tools/sim_bench/unlock_lock.stim (or --stim FILE) presses the buttons, and
+prints a table per sketch:
+
+  - CPU cycles per loop() and per _DoorLockImpl::scanButtons() call
+  - interrupt latency per interrupt vector (flag raised to vector reached)
+  - lock button pressed to the first servo pulse with a new width
+
+and writes a VCD trace per sketch (open it with GTKWave) next to --out.
+Everything runs offline.
+
+The sketches are built with -fno-inline-functions-called-once so loop() and
+scanButtons() stay separate functions that can be timed. Needs arduino-cli
+with the arduino:avr core, avr-nm (see size_report.py), a C compiler and
+simavr with its headers (libsimavr-dev, or built from source with
+SIMAVR=/path/to/simavr). Only the Python standard library is used.
+
+    sim_bench.py
+    sim_bench.py exampleMain --ms 10000 --out /tmp/sim
+    sim_bench.py templateMain --stim my_buttons.stim
+    sim_bench.py --output cycles.json
+
+A sketch can also be a folder outside this repository, e.g. a checkout of an
+older commit, to compare the same stimulus before and after a change:
+
+    git worktree add /tmp/before <commit>
+    sim_bench.py /tmp/before/exampleMain exampleMain --output before_after.json
+
+This harness was written without simavr or an AVR toolchain at hand and has
+not produced numbers yet, so no cycle counts are recorded in this repository.
+Check the first results against benchmarkMain on a real board.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+from size_report import find_tool
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HERE = os.path.join(REPO, "tools", "sim_bench")
+
+# Default pins from src/DoorLock.h, shown in the VCD trace
+TRACES = ["4:button1", "3:button2", "2:button3", "5:lock_button", "7:green_led", "8:red_led",
+          "9:servo", "12:buzzer"]
+LOCK_PIN = 5
+SERVO_PIN = 9
+
+FUNCTIONS = {"loop": "loop", "scan": "_DoorLockImpl::scanButtons()"}
+
+
+def build_firmware(sketch, fqbn, build_dir):
+    """Compiles the sketch and returns the path of the .elf."""
+    flags = "-fno-inline-functions-called-once"
+    command = ["arduino-cli", "compile", "--fqbn", fqbn, "--build-path", build_dir,
+               "--build-property", "compiler.cpp.extra_flags=" + flags,
+               "--build-property", "compiler.c.elf.extra_flags=" + flags, sketch]
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout)
+        sys.exit("build failed: " + sketch)
+    return os.path.join(build_dir, os.path.basename(sketch) + ".ino.elf")
+
+
+def build_simulator(build_dir):
+    """Compiles doorlock_sim.c against simavr and returns the path of the program."""
+    program = os.path.join(build_dir, "doorlock_sim")
+    compiler = os.environ.get("CC") or shutil.which("cc") or shutil.which("gcc")
+    if not compiler:
+        sys.exit("no C compiler found; set CC")
+    simavr = os.environ.get("SIMAVR")
+    if simavr:
+        # A simavr source tree after "make": headers in simavr/sim, the library in simavr/obj-<target>
+        target = subprocess.check_output([compiler, "-dumpmachine"], universal_newlines=True).strip()
+        flags = ["-I" + os.path.join(simavr, "simavr", "sim"),
+                 "-L" + os.path.join(simavr, "simavr", "obj-" + target), "-lsimavr", "-lelf"]
+    else:
+        try:
+            flags = subprocess.check_output(["pkg-config", "--cflags", "--libs", "simavr"],
+                                            universal_newlines=True).split()
+        except (OSError, subprocess.CalledProcessError):
+            flags = ["-I/usr/include/simavr", "-I/usr/local/include/simavr", "-lsimavr", "-lelf"]
+    command = [compiler, "-std=gnu99", "-O2", "-o", program,
+               os.path.join(HERE, "doorlock_sim.c")] + flags
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout)
+        sys.exit("can't build the simulator; is simavr installed?")
+    return program
+
+
+def function_addresses(avr_nm, elf):
+    """Returns the byte address of each function in FUNCTIONS."""
+    output = subprocess.check_output([avr_nm, "-C", elf], universal_newlines=True)
+    symbols = {}
+    for line in output.splitlines():
+        fields = line.split(None, 2)
+        if len(fields) == 3 and fields[1] in "Tt":
+            symbols[fields[2]] = int(fields[0], 16)
+    addresses = {}
+    for key, name in FUNCTIONS.items():
+        if name not in symbols:
+            sys.exit("%s not found in %s (inlined?)" % (name, elf))
+        addresses[key] = symbols[name]
+    return addresses
+
+
+def print_table(sketch, results):
+    print("%s (%d MHz)%s" % (sketch, results["frequency"] // 1000000,
+                             ", CRASHED" if results["crashed"] else ""))
+    print("| measurement | count | min cycles | mean cycles | max cycles | mean us |")
+    print("|---|---:|---:|---:|---:|---:|")
+    for row in results["measurements"]:
+        if row["count"] == 0:
+            print("| %s | 0 | - | - | - | - |" % row["name"])
+            continue
+        print("| %s | %d | %d | %.1f | %d | %.2f |" % (
+            row["name"], row["count"], row["min"], row["mean"], row["max"],
+            row["mean"] * 1000000.0 / results["frequency"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("sketches", nargs="*", default=["exampleMain", "templateMain"],
+                        help="sketch folders, in this repository or anywhere else "
+                             "(default: exampleMain templateMain)")
+    parser.add_argument("--fqbn", default="arduino:avr:uno", help="ATmega328P board to build for")
+    parser.add_argument("--stim", default=os.path.join(HERE, "unlock_lock.stim"),
+                        help="pin stimulus file: <time ms> <pin> <level> per line")
+    parser.add_argument("--ms", type=int, default=6000, help="simulated run time (default: 6000)")
+    parser.add_argument("--out", default=".", help="folder for the VCD traces (default: here)")
+    parser.add_argument("--output", metavar="FILE", help="also write every sketch's results to FILE as JSON")
+    args = parser.parse_args()
+
+    avr_nm = find_tool("avr-nm")
+    work = tempfile.mkdtemp(prefix="doorlock-sim-")
+    try:
+        simulator = build_simulator(work)
+        recorded = []
+        for number, sketch in enumerate(args.sketches):
+            folder = os.path.normpath(os.path.join(REPO, sketch))
+            elf = build_firmware(folder, args.fqbn, os.path.join(work, "sketch%d" % number))
+            addresses = function_addresses(avr_nm, elf)
+            # Two sketches may have the same folder name (before/after checkouts)
+            name = os.path.basename(os.path.normpath(folder))
+            if any(entry["name"] == name for entry in recorded):
+                name += "-%d" % (number + 1)
+            vcd = os.path.join(args.out, name + ".vcd")
+            command = [simulator, elf, "--loop", str(addresses["loop"]),
+                       "--scan", str(addresses["scan"]), "--stim", args.stim, "--vcd", vcd,
+                       "--ms", str(args.ms), "--lock-pin", str(LOCK_PIN),
+                       "--servo-pin", str(SERVO_PIN)]
+            for trace in TRACES:
+                command += ["--trace", trace]
+            result = subprocess.run(command, stdout=subprocess.PIPE, universal_newlines=True)
+            results = json.loads(result.stdout)
+            print_table(sketch, results)
+            print("trace: " + vcd)
+            print()
+            recorded.append({"name": name, "sketch": os.path.abspath(folder), "results": results})
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({"fqbn": args.fqbn, "stim": args.stim, "ms": args.ms, "sketches": recorded}, f, indent=2)
+            f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,355 @@
+/*
+ * DoorLock firmware benchmarks in simavr (see tools/sim_bench.py, which builds and runs this).
+ *
+ * Runs an Arduino Uno firmware image (ATmega328P, 16 MHz) for a fixed time, drives the
+ * button pins from a stimulus file and measures, in CPU cycles:
+ *   - every call of loop() and of _DoorLockImpl::scanButtons() (entry to return, including
+ *     interrupts that ran in between)
+ *   - interrupt latency per vector: interrupt flag raised to the first instruction of the
+ *     vector, as simavr counts it (time spent with interrupts off shows up here)
+ *   - lock button pressed to the first servo pulse with a different width
+ * and writes a VCD trace of the pins, the two functions and the running interrupt.
+ *
+ *     doorlock_sim firmware.elf --loop ADDR --scan ADDR --stim FILE --vcd FILE
+ *                  [--ms 6000] [--lock-pin 5] [--servo-pin 9] [--trace PIN:NAME]...
+ *
+ * ADDR are byte addresses from avr-nm. The results are printed as JSON.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_irq.h"
+#include "sim_interrupts.h"
+#include "sim_vcd_file.h"
+#include "avr_ioport.h"
+
+#define MCU "atmega328p"
+#define FREQUENCY 16000000UL
+#define CYCLES_PER_MS (FREQUENCY / 1000)
+#define PULSE_CHANGE_CYCLES (FREQUENCY / 100000) /* 10 us: more than Servo's own jitter */
+#define MAX_STIMULI 1024
+#define MAX_TRACES 16
+#define VECTOR_COUNT 26
+#define NOT_YET ((avr_cycle_count_t)-1)
+
+static const char* VECTOR_NAMES[VECTOR_COUNT] = {
+    "RESET", "INT0", "INT1", "PCINT0", "PCINT1", "PCINT2", "WDT", "TIMER2_COMPA", "TIMER2_COMPB",
+    "TIMER2_OVF", "TIMER1_CAPT", "TIMER1_COMPA", "TIMER1_COMPB", "TIMER1_OVF", "TIMER0_COMPA",
+    "TIMER0_COMPB", "TIMER0_OVF", "SPI_STC", "USART_RX", "USART_UDRE", "USART_TX", "ADC",
+    "EE_READY", "ANALOG_COMP", "TWI", "SPM_READY",
+};
+
+typedef struct {
+    unsigned long count;
+    avr_cycle_count_t min, max, total;
+} stats_t;
+
+static void stats_add(stats_t* stats, avr_cycle_count_t cycles)
+{
+    if (stats->count == 0 || cycles < stats->min) {
+        stats->min = cycles;
+    }
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+    stats->total += cycles;
+    stats->count++;
+}
+
+typedef struct {
+    const char* name;
+    uint32_t address;
+    int inside;
+    uint16_t entry_sp;
+    avr_cycle_count_t start;
+    avr_irq_t* irq; /* High while the function runs (VCD) */
+    stats_t stats;
+} function_t;
+
+typedef struct {
+    avr_cycle_count_t pending_at;
+    stats_t stats;
+} vector_t;
+
+typedef struct {
+    avr_cycle_count_t at;
+    int pin;
+    int level;
+} stimulus_t;
+
+static avr_t* avr;
+static function_t functions[2] = {{.name = "loop()"}, {.name = "scanButtons()"}};
+static vector_t vectors[VECTOR_COUNT];
+static stimulus_t stimuli[MAX_STIMULI];
+static int stimulus_count;
+
+static int lock_pin = 5;
+static int servo_pin = 9;
+static avr_cycle_count_t lock_pressed_at = NOT_YET;
+static int servo_level;
+static avr_cycle_count_t servo_rise;
+static avr_cycle_count_t servo_width;
+static stats_t lock_to_servo;
+
+/* --- Pins --- */
+/* Arduino Uno numbering: 0-7 = PD0-7, 8-13 = PB0-5, 14-19 (A0-A5) = PC0-5 */
+static avr_irq_t* pin_irq(int pin)
+{
+    char port = pin < 8 ? 'D' : pin < 14 ? 'B' : 'C';
+    int bit = pin < 8 ? pin : pin < 14 ? pin - 8 : pin - 14;
+    return avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), bit);
+}
+
+static void servo_changed(struct avr_irq_t* irq, uint32_t value, void* param)
+{
+    (void)irq;
+    (void)param;
+    if ((int)value == servo_level) {
+        return;
+    }
+    servo_level = value;
+    if (value) {
+        servo_rise = avr->cycle;
+        return;
+    }
+    avr_cycle_count_t width = avr->cycle - servo_rise;
+    avr_cycle_count_t difference = width > servo_width ? width - servo_width : servo_width - width;
+    if (servo_width && difference > PULSE_CHANGE_CYCLES && lock_pressed_at != NOT_YET) {
+        stats_add(&lock_to_servo, servo_rise - lock_pressed_at);
+        lock_pressed_at = NOT_YET;
+    }
+    servo_width = width;
+}
+
+static void apply_stimuli(void)
+{
+    static int next = 0;
+    while (next < stimulus_count && stimuli[next].at <= avr->cycle) {
+        stimulus_t* s = &stimuli[next++];
+        if (s->pin == lock_pin && s->level == 0 && lock_pressed_at == NOT_YET) {
+            lock_pressed_at = avr->cycle; /* First edge; bounces after it don't restart the clock */
+        }
+        avr_raise_irq(pin_irq(s->pin), s->level);
+    }
+}
+
+/* --- Interrupts --- */
+static void vector_pending(struct avr_irq_t* irq, uint32_t value, void* param)
+{
+    (void)irq;
+    vector_t* vector = param;
+    if (value && vector->pending_at == NOT_YET) {
+        vector->pending_at = avr->cycle;
+    }
+}
+
+static void vector_running(struct avr_irq_t* irq, uint32_t value, void* param)
+{
+    (void)irq;
+    vector_t* vector = param;
+    if (value && vector->pending_at != NOT_YET) {
+        stats_add(&vector->stats, avr->cycle - vector->pending_at);
+        vector->pending_at = NOT_YET;
+    }
+}
+
+/* --- Functions --- */
+static uint16_t stack_pointer(void)
+{
+    return avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+}
+
+/* Called before every instruction. A function starts when the PC reaches its first
+ * instruction and ends when the stack pointer is back above where it was then (its ret). */
+static void track_functions(void)
+{
+    for (int i = 0; i < 2; i++) {
+        function_t* f = &functions[i];
+        if (!f->inside && avr->pc == f->address) {
+            f->inside = 1;
+            f->entry_sp = stack_pointer();
+            f->start = avr->cycle;
+            avr_raise_irq(f->irq, 1);
+        } else if (f->inside && stack_pointer() > f->entry_sp) {
+            f->inside = 0;
+            stats_add(&f->stats, avr->cycle - f->start);
+            avr_raise_irq(f->irq, 0);
+        }
+    }
+}
+
+/* --- Stimulus File --- */
+static int compare_stimuli(const void* a, const void* b)
+{
+    const stimulus_t* x = a;
+    const stimulus_t* y = b;
+    return x->at < y->at ? -1 : x->at > y->at ? 1 : 0;
+}
+
+static void read_stimuli(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    char line[256];
+    int number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = 0;
+        }
+        double ms;
+        int pin, level;
+        int fields = sscanf(line, "%lf %d %d", &ms, &pin, &level);
+        if (fields <= 0) {
+            continue;
+        }
+        if (fields != 3 || pin < 0 || pin > 19 || stimulus_count == MAX_STIMULI) {
+            fprintf(stderr, "%s:%d: expected <time ms> <pin> <level>\n", path, number);
+            exit(1);
+        }
+        stimuli[stimulus_count].at = (avr_cycle_count_t)(ms * CYCLES_PER_MS);
+        stimuli[stimulus_count].pin = pin;
+        stimuli[stimulus_count].level = level != 0;
+        stimulus_count++;
+    }
+    fclose(file);
+    qsort(stimuli, stimulus_count, sizeof(stimulus_t), compare_stimuli);
+}
+
+/* --- Output --- */
+static void print_stats(const char* name, const stats_t* stats, int first)
+{
+    printf("%s    {\"name\": \"%s\", \"count\": %lu, \"min\": %llu, \"mean\": %.1f, \"max\": %llu}",
+           first ? "" : ",\n", name, stats->count, (unsigned long long)stats->min,
+           stats->count ? (double)stats->total / stats->count : 0.0, (unsigned long long)stats->max);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: doorlock_sim firmware.elf --loop ADDR --scan ADDR --stim FILE --vcd FILE\n"
+                    "                    [--ms N] [--lock-pin PIN] [--servo-pin PIN] [--trace PIN:NAME]...\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    const char* firmware_path = NULL;
+    const char* stim_path = NULL;
+    const char* vcd_path = NULL;
+    unsigned long run_ms = 6000;
+    const char* traces[MAX_TRACES];
+    int trace_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            firmware_path = argv[i];
+            continue;
+        }
+        if (i + 1 == argc) {
+            usage();
+        }
+        const char* option = argv[i];
+        const char* value = argv[++i];
+        if (!strcmp(option, "--loop")) {
+            functions[0].address = strtoul(value, NULL, 0);
+        } else if (!strcmp(option, "--scan")) {
+            functions[1].address = strtoul(value, NULL, 0);
+        } else if (!strcmp(option, "--stim")) {
+            stim_path = value;
+        } else if (!strcmp(option, "--vcd")) {
+            vcd_path = value;
+        } else if (!strcmp(option, "--ms")) {
+            run_ms = strtoul(value, NULL, 0);
+        } else if (!strcmp(option, "--lock-pin")) {
+            lock_pin = atoi(value);
+        } else if (!strcmp(option, "--servo-pin")) {
+            servo_pin = atoi(value);
+        } else if (!strcmp(option, "--trace") && trace_count < MAX_TRACES) {
+            traces[trace_count++] = value;
+        } else {
+            usage();
+        }
+    }
+    if (!firmware_path || !stim_path || !vcd_path || !functions[0].address || !functions[1].address) {
+        usage();
+    }
+    read_stimuli(stim_path);
+
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(firmware_path, &firmware) != 0) {
+        fprintf(stderr, "can't read %s\n", firmware_path);
+        return 1;
+    }
+    firmware.frequency = FREQUENCY;
+    avr = avr_make_mcu_by_name(MCU);
+    if (!avr) {
+        fprintf(stderr, "simavr has no %s\n", MCU);
+        return 1;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+
+    /* Measurements */
+    static const char* function_names[2] = {"loop", "scanButtons"};
+    avr_irq_t* function_irqs = avr_alloc_irq(&avr->irq_pool, 0, 2, function_names);
+    for (int i = 0; i < 2; i++) {
+        functions[i].irq = function_irqs + i;
+    }
+    for (int v = 1; v < VECTOR_COUNT; v++) {
+        vectors[v].pending_at = NOT_YET;
+        avr_irq_t* irqs = avr_get_interrupt_irq(avr, v);
+        if (irqs) {
+            avr_irq_register_notify(irqs + AVR_INT_IRQ_PENDING, vector_pending, &vectors[v]);
+            avr_irq_register_notify(irqs + AVR_INT_IRQ_RUNNING, vector_running, &vectors[v]);
+        }
+    }
+    avr_irq_register_notify(pin_irq(servo_pin), servo_changed, NULL);
+
+    /* Trace */
+    avr_vcd_t vcd;
+    avr_vcd_init(avr, vcd_path, &vcd, 1000);
+    for (int i = 0; i < trace_count; i++) {
+        int pin = atoi(traces[i]);
+        const char* name = strchr(traces[i], ':');
+        avr_vcd_add_signal(&vcd, pin_irq(pin), 1, name ? name + 1 : traces[i]);
+    }
+    avr_vcd_add_signal(&vcd, function_irqs + 0, 1, "loop");
+    avr_vcd_add_signal(&vcd, function_irqs + 1, 1, "scanButtons");
+    avr_vcd_add_signal(&vcd, avr_get_interrupt_irq(avr, AVR_INT_ANY) + AVR_INT_IRQ_RUNNING, 8, "isr_vector");
+    avr_vcd_start(&vcd);
+
+    /* Run */
+    avr_cycle_count_t end = (avr_cycle_count_t)run_ms * CYCLES_PER_MS;
+    int state = cpu_Running;
+    while (avr->cycle < end && state != cpu_Done && state != cpu_Crashed) {
+        apply_stimuli();
+        track_functions();
+        state = avr_run(avr);
+    }
+    avr_vcd_stop(&vcd);
+    avr_vcd_close(&vcd);
+
+    printf("{\n  \"frequency\": %lu,\n  \"crashed\": %s,\n  \"measurements\": [\n", FREQUENCY,
+           state == cpu_Crashed ? "true" : "false");
+    print_stats(functions[0].name, &functions[0].stats, 1);
+    print_stats(functions[1].name, &functions[1].stats, 0);
+    print_stats("lock press to servo change", &lock_to_servo, 0);
+    for (int v = 1; v < VECTOR_COUNT; v++) {
+        if (vectors[v].stats.count) {
+            char name[48];
+            snprintf(name, sizeof(name), "ISR latency %s", VECTOR_NAMES[v]);
+            print_stats(name, &vectors[v].stats, 0);
+        }
+    }
+    printf("\n  ]\n}\n");
+    return state == cpu_Crashed;
+}
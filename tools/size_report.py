@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Flash and RAM cost of each DoorLock library feature.
+
+Builds a sketch (exampleMain by default) once with every feature on, once with
+each DOORLOCK_ENABLE_... switch from src/DoorLockConfig.h turned off on its
+own, and once with all of them off, then prints a table of flash (.text +
+.data) and RAM (.data + .bss) per build from avr-size. The "saves" columns
+are the difference to the build with everything on.
+
+Needs arduino-cli with the arduino:avr core installed. avr-size and avr-nm are
+taken from PATH, or from the toolchain arduino-cli installed. Only the Python
+standard library is used.
+
+    size_report.py
+    size_report.py templateMain --fqbn arduino:avr:nano
+    size_report.py exampleMain --symbols 15
+"""
+
+import argparse
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# Keep in the same order as the switches in src/DoorLockConfig.h
+FEATURES = [
+    "DOORLOCK_ENABLE_LOGGING",
+    "DOORLOCK_ENABLE_SERIAL_COMMANDS",
+    "DOORLOCK_ENABLE_BUZZER",
+    "DOORLOCK_ENABLE_LEDS",
+    "DOORLOCK_ENABLE_GESTURES",
+    "DOORLOCK_ENABLE_TASKS",
+    "DOORLOCK_ENABLE_TIMEOUTS",
+    "DOORLOCK_ENABLE_LATENCY_STATS",
+    "DOORLOCK_ENABLE_MEMORY_STATS",
+    "DOORLOCK_ENABLE_SUPERVISOR",
+    "DOORLOCK_ENABLE_EEPROM",
+    "DOORLOCK_ENABLE_TELEMETRY",
+    "DOORLOCK_ENABLE_ADAPTIVE_DEBOUNCE",
+]
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def find_tool(name):
+    path = shutil.which(name)
+    if path:
+        return path
+    pattern = os.path.expanduser("~/.arduino15/packages/arduino/tools/avr-gcc/*/bin/" + name)
+    matches = sorted(glob.glob(pattern))
+    if matches:
+        return matches[-1]
+    sys.exit("%s not found; put it on PATH or install the arduino:avr core" % name)
+
+
+def build(sketch, fqbn, defines, build_dir):
+    """Compiles the sketch with extra -D flags and returns the path of the .elf."""
+    flags = " ".join("-D%s=%s" % item for item in sorted(defines.items()))
+    command = ["arduino-cli", "compile", "--fqbn", fqbn, "--build-path", build_dir,
+               "--build-property", "compiler.cpp.extra_flags=" + flags,
+               "--build-property", "compiler.c.extra_flags=" + flags, sketch]
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout)
+        sys.exit("build failed: " + (flags or "(defaults)"))
+    return os.path.join(build_dir, os.path.basename(sketch) + ".ino.elf")
+
+
+def section_sizes(avr_size, elf):
+    """Returns (flash bytes, RAM bytes) of an .elf."""
+    output = subprocess.check_output([avr_size, "-A", elf], universal_newlines=True)
+    sections = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith(".") and fields[1].isdigit():
+            sections[fields[0]] = int(fields[1])
+    text, data, bss = (sections.get(name, 0) for name in (".text", ".data", ".bss"))
+    return text + data, data + bss
+
+
+def largest_symbols(avr_nm, elf, count):
+    """Returns the biggest (size, type, name) symbols of the DoorLock library."""
+    output = subprocess.check_output([avr_nm, "-C", "-S", "--size-sort", "-r", elf],
+                                     universal_newlines=True)
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        name = fields[3] if len(fields) == 4 else ""
+        if "DoorLock" in name or (name.startswith("_") and not name.startswith("__")):
+            symbols.append((int(fields[1], 16), fields[2], fields[3]))
+    return symbols[:count]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("sketch", nargs="?", default="exampleMain",
+                        help="sketch folder in this repository (default: exampleMain)")
+    parser.add_argument("--fqbn", default="arduino:avr:uno", help="board to build for")
+    parser.add_argument("--symbols", type=int, default=0, metavar="N",
+                        help="also list the N biggest library symbols of the full build")
+    args = parser.parse_args()
+
+    sketch = os.path.join(REPO, args.sketch)
+    avr_size = find_tool("avr-size")
+
+    configs = [("everything on", {})]
+    configs += [(name[len("DOORLOCK_ENABLE_"):].lower() + " off", {name: 0}) for name in FEATURES]
+    configs += [("everything off", dict((name, 0) for name in FEATURES))]
+
+    rows = []
+    full_elf = None
+    work = tempfile.mkdtemp(prefix="doorlock-size-")
+    try:
+        for index, (label, defines) in enumerate(configs):
+            elf = build(sketch, args.fqbn, defines, os.path.join(work, str(index)))
+            if index == 0:
+                full_elf = elf
+            rows.append((label,) + section_sizes(avr_size, elf))
+
+        base_flash, base_ram = rows[0][1], rows[0][2]
+        print("%s on %s" % (args.sketch, args.fqbn))
+        print("| build | flash | saves | RAM | saves |")
+        print("|---|---:|---:|---:|---:|")
+        for label, flash, ram in rows:
+            print("| %s | %d | %d | %d | %d |" % (label, flash, base_flash - flash, ram, base_ram - ram))
+
+        if args.symbols > 0:
+            print()
+            print("| size | type | symbol |")
+            print("|---:|:---:|---|")
+            for size, kind, name in largest_symbols(find_tool("avr-nm"), full_elf, args.symbols):
+                print("| %d | %s | `%s` |" % (size, kind, name))
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
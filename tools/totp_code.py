@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Shows DoorLock one-time codes and the bytes to give setOneTimeSecret().
+
+A one-time code is the RFC 6238 code an authenticator app works out from the
+same secret (HMAC-SHA1, 30 second steps), but written with the keypad's three
+buttons: the 31-bit number is taken modulo 3^digits and written in base 3, with
+buttons 1, 2 and 3 for the base-3 digits 0, 1 and 2. Must match _finish() in
+src/TotpCache.cpp. Only the Python standard library is used.
+
+    totp_code.py JBSWY3DPEHPK3PXP                 (base32, like in an authenticator app)
+    totp_code.py --hex 3132333435363738393031323334353637383930
+    totp_code.py JBSWY3DPEHPK3PXP --time 2024-03-15T14:30:00 --digits 6
+"""
+
+import argparse
+import base64
+import calendar
+import hashlib
+import hmac
+import struct
+import sys
+import time
+
+STEP_SECONDS = 30  # DL_TOTP_STEP_SECONDS
+MAX_KEY = 64       # DL_TOTP_MAX_KEY
+
+
+def keypad_code(key, unix_time, digits):
+    """The buttons to press (each 1-3) for the 30 seconds that unix_time falls in."""
+    counter = int(unix_time) // STEP_SECONDS
+    digest = hmac.new(key, struct.pack(">Q", counter), hashlib.sha1).digest()
+    offset = digest[19] & 0x0F
+    number = struct.unpack(">I", digest[offset:offset + 4])[0] & 0x7FFFFFFF
+    number %= 3 ** digits
+    buttons = []
+    for _ in range(digits):
+        buttons.append(number % 3 + 1)
+        number //= 3
+    return buttons[::-1]
+
+
+def parse_secret(text, is_hex):
+    try:
+        if is_hex:
+            return bytes.fromhex(text)
+        text = text.replace(" ", "").upper()
+        return base64.b32decode(text + "=" * (-len(text) % 8))
+    except ValueError:
+        sys.exit("not a %s secret: %s" % ("hex" if is_hex else "base32", text))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("secret", help="the shared secret, in base32 (or hex with --hex)")
+    parser.add_argument("--hex", action="store_true", help="the secret is in hex")
+    parser.add_argument("--digits", type=int, default=8, help="DOORLOCK_TOTP_DIGITS (default: 8)")
+    parser.add_argument("--time", help="UTC time to show the code for, e.g. 2024-03-15T14:30:00 (default: now)")
+    args = parser.parse_args()
+
+    key = parse_secret(args.secret, args.hex)
+    if not 1 <= len(key) <= MAX_KEY:
+        sys.exit("a secret has 1 to %d bytes, not %d" % (MAX_KEY, len(key)))
+    if not 1 <= args.digits <= 10:
+        sys.exit("--digits must be 1 to 10")
+    if args.time:
+        unix_time = calendar.timegm(time.strptime(args.time, "%Y-%m-%dT%H:%M:%S"))
+    else:
+        unix_time = time.time()
+
+    print("const uint8_t secret[%d] = {%s};" % (len(key), ", ".join("0x%02X" % byte for byte in key)))
+    print("DoorLock::setOneTimeSecret(0, secret, sizeof(secret));")
+    left = STEP_SECONDS - int(unix_time) % STEP_SECONDS
+    print("code: %s (for %d more seconds)" % ("".join(map(str, keypad_code(key, unix_time, args.digits))), left))
+
+
+if __name__ == "__main__":
+    main()